@@ -0,0 +1,70 @@
+/*******************************************************************************
+** Copyright (c) 2012 - 2023 v.arteev
+
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+
+** The above copyright notice and this permission notice shall be included in all
+** copies or substantial portions of the Software.
+
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+*******************************************************************************/
+#ifndef _RXS_DURABILITY_H
+#define _RXS_DURABILITY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <sys/types.h>
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// Durability policy: what is flushed to the disk and when. Only the files touched by the operation are flushed,
+// not the whole system as by 'sync()'.
+//////////////////////////////////////////////////////////////////////////////////////////////////
+typedef enum durability_t {
+  DURABILITY_NONE = 0,  // Data are left in the page cache
+  DURABILITY_CLOSE,     // 'fdatasync()' on close of the written file
+  DURABILITY_PERIODIC,  // 'fdatasync()' every N MB written and on close
+  DURABILITY_FULL       // 'fsync()' on close, parent directory is synced on create/rename/unlink
+} durability_t;
+
+#define DURABILITY_PERIODIC_MB 64  // Default N of 'DURABILITY_PERIODIC'
+// Commits coming while a wave of flushes is in progress wait for its end and flush own files together by the next wave
+// (group commit). The lease of the wave: it is not waited if it is not done in this time (checked every
+// GROUP_COMMIT_CHECK_MSEC)
+#define GROUP_COMMIT_WAIT_SEC 5
+#define GROUP_COMMIT_CHECK_MSEC 100
+
+// Policy of the process (default is 'DURABILITY_CLOSE')
+ssize_t set_durability_policy(durability_t mode, uint32_t periodic_mb);
+durability_t get_durability_policy(uint32_t* periodic_mb);
+// Parse policy: 'none', 'close', 'periodic[:N]', 'full'
+ssize_t parse_durability_policy(const char* lexeme, durability_t* mode, uint32_t* periodic_mb);
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// Group commit is shared by processes forked after 'init_group_commit()'. Without it every commit flushes own file.
+//////////////////////////////////////////////////////////////////////////////////////////////////
+ssize_t init_group_commit();
+ssize_t dinit_group_commit();
+// Flush data of the file by the mode (nothing for 'DURABILITY_NONE')
+// Return value: on success returns 0, otherwise -1 and errno is set
+int durable_commit_fd(int fd, durability_t mode);
+// Flush the parent directory of 'path' (only for 'DURABILITY_FULL')
+int durable_commit_dir(const char* path, durability_t mode);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // _RXS_DURABILITY_H
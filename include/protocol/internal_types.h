@@ -47,14 +47,100 @@ extern "C" {
 // file_handlers_t
 //////////////////////////////////////////////////////////////////////////////////////////////////
 typedef struct file_handlers_t {
-  uint32_t fhandle_key;
+  uint32_t fhandle_key;  // Handle is issued for the slot (0 - slot is free)
   FILE* fhandle_val;
+  uint16_t generation;  // Bumped on every release of the slot
+  int direct_fd;        // Descriptor of the same file opened with O_DIRECT (-1 - buffered stream)
+  int data_fd;          // Data channel of the stream (-1 - not connected)
+  // Access pattern of reads (see 'SEQ_ACCESS_THRESHOLD')
+  off_t seq_next;        // Offset expected by the next sequential read
+  uint32_t seq_cnt;      // Number of consecutive sequential reads
+  size_t ra_window;      // Readahead window, it grows while the stream is read sequentially
+  off_t ra_end;          // End of the range already requested from the kernel
+  off_t dontneed_end;    // End of the range already dropped from the page cache
+  // Durability policy of the stream (see 'durability_t') and data written since the last commit
+  uint8_t durability;
+  uint64_t dirty_sz;
+  // Write-behind buffer: small writes are collected and written by one 'pwrite()' from 'wb_offset'
+  uint8_t* wb_buf;
+  size_t wb_sz;     // Capacity (multiple of the file system block)
+  size_t wb_len;    // Dirty range is [wb_offset, wb_offset + wb_len)
+  off_t wb_offset;  // File offset of the buffer
+  size_t wb_blk;    // Block size of the file system
+  int wb_err;       // Error of the deferred write, it is reported by the next call on the stream
+  // Read-only stream is read through the window of mapping (see '--read_mode=mmap')
+  uint8_t mmap_mode;
+  uint8_t* map_ptr;
+  off_t map_offset;  // Offset of the window in the file (multiple of page size)
+  size_t map_sz;
+  uint32_t next_free;   // Next free slot (index + 1), 0 - end of the free list
 } file_handlers_t;
 
 void* new_file_handlers_t(size_t count);
 ssize_t init_file_handlers_t(file_handlers_t* file_handlers, uint32_t fhandle_key, FILE* fhandle);
 ssize_t dinit_file_handlers_t(file_handlers_t* file_handlers);
 void free_file_handlers_t(void* file_handlers);
+// Put data to the write-behind buffer of 'wb_mb' MiB (allocated on first use), full buffer is written to the file
+// Return value: on success returns 0, otherwise -1 and errno is set
+ssize_t write_behind_file_handlers_t(file_handlers_t* file_handlers, const uint8_t* data, size_t data_sz,
+                                     uint32_t wb_mb);
+// Write dirty range of the buffer and move the stream behind it. Must be called before any other use of the stream
+ssize_t flush_write_behind_file_handlers_t(file_handlers_t* file_handlers);
+// Stream is sequential after this number of reads continuing the previous one. Then the kernel gets readahead of the
+// window ahead of the offset and the range behind the offset is dropped from the page cache (one-pass transfer)
+#define SEQ_ACCESS_THRESHOLD 2
+#define READAHEAD_WINDOW_MIN (128 * 1024)
+#define READAHEAD_WINDOW_MAX (16 * 1024 * 1024)
+// Size of the window of mapping. 32-bit targets keep the address space for other sessions
+#define MMAP_WINDOW_SZ ((sizeof(void*) > 4) ? (256 * 1024 * 1024) : (16 * 1024 * 1024))
+#define WRITE_BEHIND_MB 4  // Size of write-behind buffer of the stream by default
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// file_handlers_tbl_t
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// Handle of a stream: low bits are the slot index + 1 (so 0 is never a valid handle), high bits are the generation
+// of the slot. A stale handle of the closed stream does not match the reused slot.
+#define FHANDLE_INDEX_BITS 16
+#define FHANDLE_INDEX_MASK ((1U << FHANDLE_INDEX_BITS) - 1)
+#define FHANDLE_SLAB_SZ 32     // Number of slots in one slab
+#define FHANDLE_OPEN_MAX 256   // Limit of open streams per session by default
+
+typedef struct file_handlers_tbl_t {
+  file_handlers_t** slabs;  // Slabs are never moved, so a slot address is stable while the stream is open
+  uint32_t slabs_cnt;
+  uint32_t free_head;  // First free slot (index + 1), 0 - free list is empty
+  uint32_t opened;
+  uint32_t opened_max;
+} file_handlers_tbl_t;
+
+ssize_t init_file_handlers_tbl_t(file_handlers_tbl_t* tbl, uint32_t opened_max);
+ssize_t dinit_file_handlers_tbl_t(file_handlers_tbl_t* tbl);
+// Return value: on success returns 0 and sets 'fhandle_key', otherwise -1 and errno is set (EMFILE, ENOMEM)
+ssize_t insert_file_handlers_tbl_t(file_handlers_tbl_t* tbl, FILE* fhandle, uint32_t* fhandle_key);
+// Return value: slot of the open stream, NULL if handle is unknown or stale
+file_handlers_t* find_file_handlers_tbl_t(const file_handlers_tbl_t* tbl, uint32_t fhandle_key);
+// Close the stream (if it is still open) and release the slot
+ssize_t remove_file_handlers_tbl_t(file_handlers_tbl_t* tbl, uint32_t fhandle_key);
+// Flush write-behind buffers of all open streams (e.g. before 'stat()' by path)
+ssize_t flush_write_behind_file_handlers_tbl_t(file_handlers_tbl_t* tbl);
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// aligned_buf_pool_t
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// Buffers for direct I/O: address, size and file offset of a transfer must be multiple of the alignment
+#define DIRECT_IO_ALIGN 4096
+#define DIRECT_IO_BUF_SZ (1024 * 1024)
+#define DIRECT_IO_BUFS_MAX 4  // Released buffers kept by the pool
+
+typedef struct aligned_buf_pool_t {
+  uint8_t* bufs[DIRECT_IO_BUFS_MAX];
+  uint32_t bufs_cnt;
+  size_t buf_sz;
+  size_t align;
+} aligned_buf_pool_t;
+ssize_t init_aligned_buf_pool_t(aligned_buf_pool_t* pool, size_t buf_sz, size_t align);
+ssize_t dinit_aligned_buf_pool_t(aligned_buf_pool_t* pool);
+// Return value: aligned buffer of 'buf_sz' bytes, NULL on error and errno is set
+uint8_t* get_aligned_buf_pool_t(aligned_buf_pool_t* pool);
+void put_aligned_buf_pool_t(aligned_buf_pool_t* pool, uint8_t* buf);
 //////////////////////////////////////////////////////////////////////////////////////////////////
 // addr_t
 //////////////////////////////////////////////////////////////////////////////////////////////////
@@ -77,6 +163,7 @@ typedef struct user_info_t {
   char pass[PATH_MAX];
   char group[PATH_MAX];
   char home_dir[PATH_MAX];
+  char rate_limit[PATH_MAX];  // Optional: 'RATE[:BURST]' of data channels of the user
 } user_info_t;
 
 void* new_user_info_t(size_t count);
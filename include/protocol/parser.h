@@ -32,7 +32,9 @@ extern "C" {
 ssize_t parse_addr(char* optarg, dlist_t** addr_allowed_lst);
 // Parse args
 ssize_t parse_args(int cnt, char* val[], uint32_t* addr_rxs, uint16_t* port_rxs, dlist_t** addr_allowed,
-                   int* mode_running, char* file_users, int* pid_host, uint8_t* encoder_mode);
+                   int* mode_running, char* file_users, int* pid_host, uint8_t* encoder_mode, uint8_t* io_backend,
+                   uint8_t* read_mode, uint8_t* durability, uint32_t* durability_mb, uint64_t* rate_limit,
+                   uint64_t* rate_burst);
 // Parse user info file
 ssize_t parse_user_info(const char* filename, dlist_t** user_info_t_lst);
 // Parse format: username:password@address:port
@@ -82,7 +82,11 @@ typedef enum rxs_operation_t {
   operation_file_exist = 21,
   operation_dir_exist = 22,
   operation_port = 23,
-  operation_max = 24,
+  operation_ping = 24,
+  operation_pread = 25,
+  operation_pwrite = 26,
+  operation_preadv = 27,
+  operation_max = 28,
 } rxs_operation_t;
 //////////////////////////////////////////////////////////////////////////////////////////////////
 // Packet RXS
@@ -177,6 +181,33 @@ typedef struct slot05_t {
 ssize_t init_slot05_t(slot05_t* slot05);
 ssize_t dinit_slot05_t(slot05_t* slot05);
 
+typedef struct slot06_t {
+  uint32_t stream_id;  // stream_id
+  uint64_t offset;     // Position in the file
+  uint32_t data_sz;
+} slot06_t;
+
+ssize_t init_slot06_t(slot06_t* slot06);
+ssize_t dinit_slot06_t(slot06_t* slot06);
+
+#define RXS_PREADV_RANGES_MAX 1024                  // Max number of ranges in one request
+#define RXS_PREADV_BATCH_SZ_MAX (64 * 1024 * 1024)  // Max total length of the ranges in one request
+
+typedef struct rxs_range_t {
+  uint64_t offset;
+  uint64_t len;
+} rxs_range_t;
+
+typedef struct slot07_t {
+  uint32_t stream_id;  // stream_id
+  uint32_t val;        // errno of answer B1
+  uint32_t ranges_cnt;
+  rxs_range_t* ranges;
+} slot07_t;
+
+ssize_t init_slot07_t(slot07_t* slot07);
+ssize_t dinit_slot07_t(slot07_t* slot07);
+
 typedef struct crypt_data_t {
   uint8_t key_info[CRYPT_DATA_KEY_SIZE];
   uint16_t len;
@@ -264,14 +295,14 @@ typedef struct rcv_slot0x_t {
 // RESP B0: none
 // RESP B1: errno | use: slot00_t
 
-// FCNT: fseek(RXS_HANDLE stream, long offset, int whence)
-// RQST: stream_id | use: slot04_t
-// RESP B0: none
-// RESP B1: errno | use: slot00_t
+// FCNT: fseeko(RXS_HANDLE stream, int64_t offset, int whence)
+// RQST: stream_id, offset (two's complement), whence | use: slot06_t
+// RESP B0: stream_id, position, 0 | use: slot06_t
+// RESP B1: stream_id, 0, errno | use: slot06_t
 
-// FCNT: ftell(RXS_HANDLE stream)
+// FCNT: ftell(RXS_HANDLE stream), 32-bit position. The client uses fseeko(stream, 0, SEEK_CUR) instead.
 // RQST: stream_id | use: slot00_t
-// RESP B0: none
+// RESP B0: position | use: slot00_t
 // RESP B1: errno | use: slot00_t
 
 // FCNT: rewind(RXS_HANDLE stream)
@@ -279,6 +310,22 @@ typedef struct rcv_slot0x_t {
 // RESP B0: none
 // RESP B1: errno | use: slot00_t
 
+// FCNT: pread(RXS_HANDLE stream, void *buf, size_t count, uint64_t offset)
+// RQST: stream_id, offset, size | use: slot06_t
+// RESP B0: as fread | use: slot04_t
+// RESP B1: errno | use: slot04_t
+
+// FCNT: pwrite(RXS_HANDLE stream, const void *buf, size_t count, uint64_t offset)
+// RQST: stream_id, offset, size | use: slot06_t
+// RESP B0: as fwrite | use: slot04_t
+// RESP B1: errno | use: slot04_t
+
+// FCNT: preadv(RXS_HANDLE stream, const struct iovec *iov, int iovcnt, const uint64_t *offsets)
+// RQST: stream_id, 0, ranges (offset, length) | use: slot07_t
+// RESP B0: data of the ranges back to back on the data channel, then stream_id, 0, ranges (offset, sent length) |
+// use: slot07_t. The ranges are cut by the end of file.
+// RESP B1: stream_id, errno | use: slot07_t
+
 // FCNT: port(RXS_HANDLE stream)
 // RQST: stream_id | use: slot00_t
 // RESP B0: port_number | use: slot05_t
@@ -295,6 +342,15 @@ ssize_t rxs_send_packet_x04(int sockfd, rxs_type_t type, rxs_operation_t operati
                             uint16_t eof);
 ssize_t rxs_recv_packet_x04(int sockfd, rxs_type_t* type, rxs_operation_t operation, uint32_t* stream,
                             uint32_t* data_sz, uint16_t* eof);
+ssize_t rxs_send_packet_x06(int sockfd, rxs_type_t type, rxs_operation_t operation, uint32_t stream, uint64_t offset,
+                            uint32_t data_sz);
+ssize_t rxs_recv_packet_x06(int sockfd, rxs_type_t* type, rxs_operation_t operation, uint32_t* stream,
+                            uint64_t* offset, uint32_t* data_sz);
+ssize_t rxs_send_packet_x07(int sockfd, rxs_type_t type, rxs_operation_t operation, uint32_t stream, uint32_t val,
+                            const rxs_range_t* ranges, uint32_t ranges_cnt);
+// Ranges of the answer are copied to 'ranges' (at most 'ranges_max')
+ssize_t rxs_recv_packet_x07(int sockfd, rxs_type_t* type, rxs_operation_t operation, uint32_t* stream, uint32_t* val,
+                            rxs_range_t* ranges, uint32_t ranges_max, uint32_t* ranges_cnt);
 ssize_t rxs_recv_slot0x(int sockfd, void* buf, size_t buf_sz, void* slot0x, int* errno_other_side);
 ssize_t rxs_recv_data_x(int sockfd, uint8_t* data, uint32_t data_sz);
 //////////////////////////////////////////////////////////////////////////////////
@@ -313,6 +369,10 @@ ssize_t serialize_slot04_t(void* slot04, uint8_t** data, size_t* data_sz);
 ssize_t deserialize_slot04_t(uint8_t* data, size_t data_sz, slot04_t* slot04);
 ssize_t serialize_slot05_t(void* slot0x, uint8_t** data, size_t* data_sz);
 ssize_t deserialize_slot05_t(uint8_t* data, size_t data_sz, slot05_t* slot05);
+ssize_t serialize_slot06_t(void* slot0x, uint8_t** data, size_t* data_sz);
+ssize_t deserialize_slot06_t(uint8_t* data, size_t data_sz, slot06_t* slot06);
+ssize_t serialize_slot07_t(void* slot0x, uint8_t** data, size_t* data_sz);
+ssize_t deserialize_slot07_t(uint8_t* data, size_t data_sz, slot07_t* slot07);
 // Serialization encrypted header
 ssize_t serialize_crypt_data_t(void* crypt_data_x, uint8_t** data);
 ssize_t deserialize_crypt_data_t(uint8_t* data, crypt_data_t* crypt_data);
@@ -328,6 +388,9 @@ ssize_t compose_slot02_t(const char* data1, size_t data1_sz, const char* data2,
 ssize_t compose_slot03_t(const char* data, size_t data_sz, uint32_t val, slot03_t* slot03);
 ssize_t compose_slot04_t(uint32_t stream, uint32_t data_sz, uint16_t eof, slot04_t* slot04);
 ssize_t compose_slot05_t(uint32_t stream, uint16_t port, slot05_t* slot05);
+ssize_t compose_slot06_t(uint32_t stream, uint64_t offset, uint32_t data_sz, slot06_t* slot06);
+ssize_t compose_slot07_t(uint32_t stream, uint32_t val, const rxs_range_t* ranges, uint32_t ranges_cnt,
+                         slot07_t* slot07);
 // Create crypted data
 ssize_t compose_crypt_data_t(const uint8_t* key_info, uint16_t len, const uint8_t* data, const uint8_t* imit,
                              crypt_data_t* crypt_data);
@@ -353,6 +416,10 @@ ssize_t compose_packet_rxs_x04(rxs_type_t type, rxs_operation_t operation, uint3
                                uint16_t eof, packet_rxs_t* packet_rxs);
 ssize_t compose_packet_rxs_x05(rxs_type_t type, rxs_operation_t operation, uint32_t stream, uint16_t port,
                                packet_rxs_t* packet_rxs);
+ssize_t compose_packet_rxs_x06(rxs_type_t type, rxs_operation_t operation, uint32_t stream, uint64_t offset,
+                               uint32_t data_sz, packet_rxs_t* packet_rxs);
+ssize_t compose_packet_rxs_x07(rxs_type_t type, rxs_operation_t operation, uint32_t stream, uint32_t val,
+                               const rxs_range_t* ranges, uint32_t ranges_cnt, packet_rxs_t* packet_rxs);
 //////////////////////////////////////////////////////////////////////////////////
 // send/receive data slot functions
 //////////////////////////////////////////////////////////////////////////////////
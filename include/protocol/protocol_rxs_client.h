@@ -30,6 +30,7 @@ extern "C" {
 #include <stdint.h>
 #include <sys/stat.h>
 #include <sys/types.h>  // for 'mode_t'
+#include <sys/uio.h>    // for 'struct iovec'
 #include <unistd.h>
 
 #include "protocol/protocol_rxs.h"
@@ -38,6 +39,13 @@ extern "C" {
 // RXS Remote eXchange System: Allows editing files and perform commands on remote file systems
 //////////////////////////////////////////////////////////////////////////////////////////////////
 
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// Session: connection to remote side with its streams, caches and last error. Functions without 'rxs_session_' prefix
+// use the default session of the process. Different sessions can be used by different threads at the same time, but
+// one session must not be used by several threads at once.
+//////////////////////////////////////////////////////////////////////////////////////////////////
+typedef struct rxs_session_t rxs_session_t;
+
 //////////////////////////////////////////////////////////////////////////////////////////////////
 // Functions for a create, close, existatnce of a connection to remote side
 //////////////////////////////////////////////////////////////////////////////////////////////////
@@ -101,6 +109,10 @@ int rxs_rename(const char* oldname, const char* newname);
 long rxs_filesize(const char* fname);
 
 // stream open functions
+// Every stream has own data channel, so several streams can be open and used at the same time in one session.
+// Flag 'd' in the mode (e.g. "rbd", "abd") requests direct I/O on the server: data of plain mode bypass the page cache
+// of the remote host. It is ignored if the remote file system does not support O_DIRECT.
+// Flag 's' requests full durability of the written file on the server (see '--durability=full').
 // Return value: Upon successful completion return a file handler. Otherwise, zero is returned and errno is set to
 // indicate the error.
 RXS_HANDLE rxs_fopen(const char* fname, const char* mode);
@@ -112,12 +124,42 @@ RXS_HANDLE rxs_fopen(const char* fname, const char* mode);
 // determine which occurred.
 size_t rxs_fread(void* buf, size_t size, size_t count, RXS_HANDLE stream);
 
+// set the memory cap of readahead cache. Sequential reads of a stream by equal portions are served from the cache while
+// next portions are fetched in the background. Zero value disables readahead (default cap is 32 MB).
+// Return value: returns no value.
+void rxs_set_readahead(size_t mem_max);
+
+// statistics of readahead cache: reads are served from memory (hits) and reads are waited for the remote side (misses)
+// Return value: returns no value.
+void rxs_readahead_stat(uint64_t* hits, uint64_t* misses);
+
 // binary stream output
 // Return value: On success, return the number of items written. This number equals the number of bytes transferred only
 // when size is 1. If an error occurs, or the end of the file is reached, the return value is a short item count (or
 // zero).
 size_t rxs_fwrite(const void* buf, size_t size, size_t count, RXS_HANDLE stream);
 
+// set write-back buffer of a stream. Small writes are coalesced in the buffer (its size is rounded up to whole blocks)
+// and sent when it is full, when the oldest data are kept longer than 'flush_msec' (0 - 1000 msec), by rxs_fflush(),
+// rxs_fclose() and before reads of the stream. Error of the sending is reported by that call. Zero 'buf_sz' sends
+// buffered data and disables the buffer.
+// Return value: on success returns 0, otherwise -1 and errno is set appropriately.
+int rxs_set_write_back(RXS_HANDLE stream, size_t buf_sz, uint32_t flush_msec);
+
+// positioned stream input/output: data are read from (written to) 'offset' of the file by one request, so random
+// access does not need 'rxs_fseek()'. The position of the stream is moved behind the data. Sizes and offsets are
+// 64-bit.
+// Return value: On success, return the number of bytes transferred. If an error occurs, or the end of the file is
+// reached, the return value is a short count (or zero), rxs_errno() is set (RXS_EOF - end of file).
+size_t rxs_pread(void* buf, size_t size, size_t count, RXS_HANDLE stream, uint64_t offset);
+size_t rxs_pwrite(const void* buf, size_t size, size_t count, RXS_HANDLE stream, uint64_t offset);
+
+// vectored positioned input: 'iov[i]' is filled from 'offsets[i]' of the file. The ranges are sent by few requests,
+// the server joins adjacent ranges and reads them ahead. The position of the stream is not changed.
+// Return value: On success, return the number of bytes read. If the end of the file is reached in any range, the rest
+// of the range is filled by zeros and rxs_errno() is set to RXS_EOF.
+size_t rxs_preadv(const struct iovec* iov, int iovcnt, const uint64_t* offsets, RXS_HANDLE stream);
+
 // flush a stream
 // Return value: Upon successful completion 0 is returned. Otherwise, EOF is returned and errno is set to indicate the
 // error.
@@ -138,6 +180,10 @@ int rxs_fseek(RXS_HANDLE stream, long offset, int whence);
 // indicate the error.
 long rxs_ftell(RXS_HANDLE stream);
 
+// reposition a stream by 64-bit offset (the same as rxs_fseek()/rxs_ftell() where 'long' is 32-bit)
+int rxs_fseeko(RXS_HANDLE stream, int64_t offset, int whence);
+int64_t rxs_ftello(RXS_HANDLE stream);
+
 // reposition a stream
 // Return value: returns no value.
 void rxs_rewind(RXS_HANDLE stream);
@@ -150,6 +196,277 @@ int rxs_file_exist(const char* path_file);
 // Return value: on successful returns 1, if not exist 0; otherwise -1
 int rxs_dir_exist(const char* path_dir);
 
+// set TTL of metadata cache. Results of rxs_file_exist(), rxs_dir_exist(), rxs_filesize() and rxs_getcwd() (negative
+// results too) are kept in memory for 'ttl_msec'. The cache is cleared by own calls which change files (mkdir, rmdir,
+// unlink, rename, chdir, ls, fopen for writing, fwrite, fflush, fclose), changes of other clients are seen after TTL.
+// Zero value disables the cache (default).
+// Return value: returns no value.
+#define RXS_META_CACHE_TTL_MSEC 2000  // Suggested TTL
+void rxs_set_meta_cache(uint32_t ttl_msec);
+
+// statistics of metadata cache: requests are served from memory (hits) and requests are sent to the remote side
+// (misses)
+// Return value: returns no value.
+void rxs_meta_cache_stat(uint64_t* hits, uint64_t* misses);
+
+// set rate limit of data channels in bytes per second. A token bucket of 'burst' bytes is shared by data of both
+// directions, zero 'burst' selects the default (100 ms of the rate, 64 KiB at least). Zero 'rate' disables the limit
+// (default). Limits of the server are applied independently.
+// Return value: on successful returns 0; otherwise -1 and errno is set appropriately.
+int rxs_set_rate_limit(uint64_t rate, uint64_t burst);
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// Asynchronous functions
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// Requests are performed in order by the internal event loop thread. The result of a request ('res') and its error
+// ('err_no') are the same as the return value and rxs_errno() of the blocking function. Completion is passed to the
+// callback (it is called by the event loop thread) or, if the callback is NULL, is put to the completion queue: the
+// descriptor rxs_async_fd() becomes readable and completions are taken by rxs_async_complete().
+// Blocking functions wait for pending requests. Buffers of fread/fwrite must be valid until completion.
+typedef uint64_t RXS_TOKEN;  // Token of request (0 - request is not accepted)
+
+typedef enum rxs_async_op_t {
+  async_op_fopen = 0,
+  async_op_fread,
+  async_op_fwrite,
+  async_op_fflush,
+  async_op_fclose,
+  async_op_filesize,
+  async_op_unlink
+} rxs_async_op_t;
+
+typedef struct rxs_completion_t {
+  RXS_TOKEN token;
+  rxs_async_op_t op;
+  int64_t res;
+  int err_no;
+  void* user_data;
+} rxs_completion_t;
+
+typedef void (*rxs_callback_t)(const rxs_completion_t* completion);
+
+// Return value: on success returns token of the request, otherwise 0 and errno is set appropriately.
+RXS_TOKEN rxs_fopen_async(const char* fname, const char* mode, rxs_callback_t cb, void* user_data);
+RXS_TOKEN rxs_fread_async(void* buf, size_t size, size_t count, RXS_HANDLE stream, rxs_callback_t cb,
+                          void* user_data);
+RXS_TOKEN rxs_fwrite_async(const void* buf, size_t size, size_t count, RXS_HANDLE stream, rxs_callback_t cb,
+                           void* user_data);
+RXS_TOKEN rxs_fflush_async(RXS_HANDLE stream, rxs_callback_t cb, void* user_data);
+RXS_TOKEN rxs_fclose_async(RXS_HANDLE stream, rxs_callback_t cb, void* user_data);
+RXS_TOKEN rxs_filesize_async(const char* fname, rxs_callback_t cb, void* user_data);
+RXS_TOKEN rxs_unlink_async(const char* path, rxs_callback_t cb, void* user_data);
+
+// descriptor of completion queue, it is readable while the queue is not empty
+// Return value: on success returns the descriptor, otherwise -1 and errno is set appropriately.
+int rxs_async_fd();
+
+// take completions from the queue without waiting
+// Return value: number of completions are copied to 'completions'
+size_t rxs_async_complete(rxs_completion_t* completions, size_t count);
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// Functions of a session. They have the same behavior as the functions of the default session above.
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// create a session and connect it to remote side
+// Return value: on success returns the session, otherwise NULL and errno is set appropriately.
+rxs_session_t* rxs_session_open(const char* host_p, uint16_t port_h, const char* username, const char* password,
+                                int encoder);
+
+// close the connection of a session and free it
+// Return value: returns no value.
+void rxs_session_close(rxs_session_t* s);
+
+size_t rxs_session_connected(rxs_session_t* s);
+
+// check a session by the round trip to remote side
+// Return value: on success returns 0, otherwise -1 and rxs_session_errno() is set.
+int rxs_session_ping(rxs_session_t* s);
+
+int rxs_session_errno(rxs_session_t* s);
+char* rxs_session_strerror(rxs_session_t* s);
+size_t rxs_session_ls(rxs_session_t* s, const char* path, void* buf, size_t count);
+int rxs_session_mkdir(rxs_session_t* s, const char* path, mode_t mode);
+int rxs_session_mkdir_ex(rxs_session_t* s, const char* path, mode_t mode);
+int rxs_session_rmdir(rxs_session_t* s, const char* path);
+char* rxs_session_getcwd(rxs_session_t* s, char* buf, size_t size);
+int rxs_session_chdir(rxs_session_t* s, const char* path);
+int rxs_session_unlink(rxs_session_t* s, const char* path);
+int rxs_session_rename(rxs_session_t* s, const char* oldname, const char* newname);
+long rxs_session_filesize(rxs_session_t* s, const char* fname);
+RXS_HANDLE rxs_session_fopen(rxs_session_t* s, const char* fname, const char* mode);
+size_t rxs_session_fread(rxs_session_t* s, void* buf, size_t size, size_t count, RXS_HANDLE stream);
+void rxs_session_set_readahead(rxs_session_t* s, size_t mem_max);
+void rxs_session_readahead_stat(rxs_session_t* s, uint64_t* hits, uint64_t* misses);
+size_t rxs_session_fwrite(rxs_session_t* s, const void* buf, size_t size, size_t count, RXS_HANDLE stream);
+int rxs_session_set_write_back(rxs_session_t* s, RXS_HANDLE stream, size_t buf_sz, uint32_t flush_msec);
+size_t rxs_session_pread(rxs_session_t* s, void* buf, size_t size, size_t count, RXS_HANDLE stream, uint64_t offset);
+size_t rxs_session_pwrite(rxs_session_t* s, const void* buf, size_t size, size_t count, RXS_HANDLE stream,
+                          uint64_t offset);
+size_t rxs_session_preadv(rxs_session_t* s, const struct iovec* iov, int iovcnt, const uint64_t* offsets,
+                          RXS_HANDLE stream);
+int rxs_session_fflush(rxs_session_t* s, RXS_HANDLE stream);
+int rxs_session_fclose(rxs_session_t* s, RXS_HANDLE stream);
+int rxs_session_fseek(rxs_session_t* s, RXS_HANDLE stream, long offset, int whence);
+long rxs_session_ftell(rxs_session_t* s, RXS_HANDLE stream);
+int rxs_session_fseeko(rxs_session_t* s, RXS_HANDLE stream, int64_t offset, int whence);
+int64_t rxs_session_ftello(rxs_session_t* s, RXS_HANDLE stream);
+void rxs_session_rewind(rxs_session_t* s, RXS_HANDLE stream);
+int rxs_session_file_exist(rxs_session_t* s, const char* path_file);
+int rxs_session_dir_exist(rxs_session_t* s, const char* path_dir);
+void rxs_session_set_meta_cache(rxs_session_t* s, uint32_t ttl_msec);
+void rxs_session_meta_cache_stat(rxs_session_t* s, uint64_t* hits, uint64_t* misses);
+int rxs_session_set_rate_limit(rxs_session_t* s, uint64_t rate, uint64_t burst);
+
+RXS_TOKEN rxs_session_fopen_async(rxs_session_t* s, const char* fname, const char* mode, rxs_callback_t cb,
+                                  void* user_data);
+RXS_TOKEN rxs_session_fread_async(rxs_session_t* s, void* buf, size_t size, size_t count, RXS_HANDLE stream,
+                                  rxs_callback_t cb, void* user_data);
+RXS_TOKEN rxs_session_fwrite_async(rxs_session_t* s, const void* buf, size_t size, size_t count, RXS_HANDLE stream,
+                                   rxs_callback_t cb, void* user_data);
+RXS_TOKEN rxs_session_fflush_async(rxs_session_t* s, RXS_HANDLE stream, rxs_callback_t cb, void* user_data);
+RXS_TOKEN rxs_session_fclose_async(rxs_session_t* s, RXS_HANDLE stream, rxs_callback_t cb, void* user_data);
+RXS_TOKEN rxs_session_filesize_async(rxs_session_t* s, const char* fname, rxs_callback_t cb, void* user_data);
+RXS_TOKEN rxs_session_unlink_async(rxs_session_t* s, const char* path, rxs_callback_t cb, void* user_data);
+int rxs_session_async_fd(rxs_session_t* s);
+size_t rxs_session_async_complete(rxs_session_t* s, rxs_completion_t* completions, size_t count);
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// Connection pool
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// Authenticated sessions are kept for reuse by host, port and user. The control connection has TCP keepalive, and a
+// session is checked before it is handed out (sessions are idle for a second or more are pinged). Idle sessions are
+// closed after the idle time (60 sec by default) and all sessions are closed after the max age (10 min by default).
+// Working directory of a session is not reset by the pool.
+
+// set limits of sessions, zero value disables the limit
+// Return value: returns no value.
+void rxs_pool_set_limits(uint32_t idle_sec, uint32_t max_age_sec);
+
+// set rate limit of all sessions of the pool together (see rxs_set_rate_limit()), a limit of a session is applied too
+// Return value: on successful returns 0; otherwise -1 and errno is set appropriately.
+int rxs_pool_set_rate_limit(uint64_t rate, uint64_t burst);
+
+// get a warm session of the pool, or open a new one
+// Return value: on success returns the session, otherwise NULL and errno is set appropriately.
+rxs_session_t* rxs_pool_get(const char* host_p, uint16_t port_h, const char* username, const char* password,
+                            int encoder);
+
+// return a session to the pool. Streams are left open are closed. Broken or expired sessions are closed.
+// Return value: returns no value.
+void rxs_pool_put(rxs_session_t* s);
+
+// close idle sessions of the pool
+// Return value: returns no value.
+void rxs_pool_clear();
+
+// statistics of the pool: sessions are reused (hits) and opened (misses)
+// Return value: returns no value.
+void rxs_pool_stat(uint64_t* hits, uint64_t* misses);
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// Striped transfer
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// The file is split into ranges (stripes) and every stripe is moved by own session of the pool over own connection
+// at the same time: positioned reads/writes on the server and 'pwrite()' to the local file at the offset of the stripe.
+// A failed stripe is resumed from its last moved portion on a new session (up to 3 times). Small files are moved by
+// less stripes (at least 1 MB per stripe).
+#define RXS_STRIPES_MAX 16
+
+typedef struct rxs_stripe_stat_t {
+  uint64_t offset;   // Range of the file
+  uint64_t len;
+  uint64_t done;     // Moved bytes
+  double sec;        // Time of the stripe
+  uint32_t retries;  // Number of resumes
+  int err_no;        // Last error (0 - the stripe is moved)
+} rxs_stripe_stat_t;
+
+// get a remote file by 'stripes' connections (0 - RXS_STRIPES_MAX). 'stat' must have RXS_STRIPES_MAX items.
+// Return value: on success returns number of used stripes, otherwise -1 and errno is set appropriately.
+int rxs_get_striped(const char* host_p, uint16_t port_h, const char* username, const char* password, int encoder,
+                    const char* fname_local, const char* fname_remote, uint32_t stripes, rxs_stripe_stat_t* stat);
+
+// put a local file to remote side by 'stripes' connections (0 - RXS_STRIPES_MAX). 'stat' must have RXS_STRIPES_MAX
+// items.
+// Return value: on success returns number of used stripes, otherwise -1 and errno is set appropriately.
+int rxs_put_striped(const char* host_p, uint16_t port_h, const char* username, const char* password, int encoder,
+                    const char* fname_local, const char* fname_remote, uint32_t stripes, rxs_stripe_stat_t* stat);
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// Mirror of directory trees
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// Regular files of the source tree are compared with the destination by size and mtime: new files, files of other size
+// and files are newer than the copy are moved by a pool of worker sessions (large files first). Empty directories and
+// symbolic links are not moved. The remote tree is listed by 'find' on the remote side, so its path must not contain
+// quotes, '$', '`' or '\'.
+#define RXS_MIRROR_WORKERS_MAX 32
+#define RXS_MIRROR_PULL 0x01    // The remote tree is mirrored to the local one (default is push)
+#define RXS_MIRROR_DELETE 0x02  // Files are absent in the source tree are deleted in the destination
+
+typedef struct rxs_mirror_stat_t {
+  uint64_t files_total;  // Files of the source tree
+  uint64_t files_moved;
+  uint64_t files_failed;
+  uint64_t files_deleted;
+  uint64_t bytes_moved;
+  double sec;
+} rxs_mirror_stat_t;
+
+// mirror 'dir_local' and 'dir_remote' by 'workers' connections (0 - RXS_MIRROR_WORKERS_MAX), 'flags' is RXS_MIRROR_*
+// Return value: on success returns 0, otherwise -1 and errno is set appropriately (the first error).
+int rxs_mirror(const char* host_p, uint16_t port_h, const char* username, const char* password, int encoder,
+               const char* dir_local, const char* dir_remote, uint32_t flags, uint32_t workers,
+               rxs_mirror_stat_t* stat);
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// Batch of operations
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// The manifest has one operation per line (empty lines and lines are started by '#' are skipped), a path with spaces
+// is quoted by '"':
+//   get ./local_file ./remote_file
+//   put ./local_file ./remote_file
+//   mkdir ./remote_dir (parent directories are created too, an existing directory is not an error)
+//   rm ./remote_file
+//   rename ./remote_old ./remote_new
+// Operations are run by 'streams' sessions of the pool, so every connection is authorized once. Transfers between
+// two metadata operations are moved by all streams at once, a metadata operation (mkdir, rm, rename) is run after all
+// earlier operations are done. A failed operation does not stop the batch.
+#define RXS_BATCH_STREAMS_MAX 32
+
+typedef enum rxs_batch_op_t {
+  batch_op_none,  // The line is not parsed
+  batch_op_get,
+  batch_op_put,
+  batch_op_mkdir,
+  batch_op_rm,
+  batch_op_rename
+} rxs_batch_op_t;
+
+typedef struct rxs_batch_result_t {
+  uint32_t line;  // Line of the manifest
+  rxs_batch_op_t op;
+  char* arg1;
+  char* arg2;      // Empty for mkdir and rm
+  int err_no;      // 0 - the operation is done
+  uint64_t bytes;  // Moved bytes
+  double sec;
+} rxs_batch_result_t;
+
+// run operations of the manifest by 'streams' connections (0 - RXS_BATCH_STREAMS_MAX). Results are set to '*results'
+// in order of the manifest, they must be freed by rxs_batch_free().
+// Return value: on success (all operations are done) returns 0, otherwise -1 and errno is set appropriately (the
+// first error).
+int rxs_batch(const char* host_p, uint16_t port_h, const char* username, const char* password, int encoder,
+              const char* fname_manifest, uint32_t streams, rxs_batch_result_t** results, size_t* cnt);
+
+// free results of the batch
+// Return value: returns no value.
+void rxs_batch_free(rxs_batch_result_t* results, size_t cnt);
+
+// name of the operation as it is written in the manifest
+// Return value: returns the name.
+const char* rxs_batch_op_name(rxs_batch_op_t op);
+
 #ifdef __cplusplus
 }
 #endif
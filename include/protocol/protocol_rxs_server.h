@@ -47,6 +47,9 @@ size_t rxs_data_point_create_client(uint16_t port);
 // return value: in success to returns 0; else to returns error code
 size_t rxs_data_point_close();
 
+typedef enum io_backend_t { IO_BACKEND_POSIX = 0, IO_BACKEND_URING } io_backend_t;
+typedef enum read_mode_t { READ_MODE_STDIO = 0, READ_MODE_MMAP } read_mode_t;
+
 //////////////////////////////////////////////////////////////////////////////////////////////////
 // Internal functions
 //////////////////////////////////////////////////////////////////////////////////////////////////
@@ -57,10 +60,20 @@ void set_client_addr(struct sockaddr_in* addr);
 int set_socket_data(int sockfd);
 int get_socket_data();
 // Close file handlers
-ssize_t clear_file_handlers_lst();
+ssize_t clear_file_handlers_tbl();
 //////////////////////////////////////////////////////////////////////////////////////////////////
 // Policy functions
 //////////////////////////////////////////////////////////////////////////////////////////////////
+// Limit of open streams per session (see 'FHANDLE_OPEN_MAX')
+ssize_t set_open_streams_max(uint32_t open_streams_max);
+// Size of write-behind buffer of the stream in MiB (see 'WRITE_BEHIND_MB')
+ssize_t set_write_behind_mb(uint32_t mb);
+// Storage backend of data paths in plain mode (see '--io_backend')
+ssize_t set_io_backend(io_backend_t backend);
+io_backend_t get_io_backend();
+// Read-only streams are read by stdio or through the mapping of the file (see '--read_mode')
+ssize_t set_read_mode(read_mode_t mode);
+read_mode_t get_read_mode();
 ssize_t set_encoder_mode(uint8_t encoder_mode);
 ssize_t is_encoder_mode();
 
@@ -96,12 +109,28 @@ ssize_t rxs_handler_filesize(uint8_t* data, long* status, uint32_t* err_no);
 
 ssize_t rxs_handler_fopen(uint8_t* data1, uint8_t* data2, uint32_t* fhandle_key, uint32_t* err_no);
 ssize_t rxs_handler_fread(uint32_t key, uint8_t** data, uint32_t* len, uint32_t* err_no);
+// Send whole blocks (see 'rxs_handler_fread()') of the mapped stream to the socket while they fit into 'count' bytes.
+// Returns RXS_EOF on end of file, 1 if the stream is not mapped
+ssize_t rxs_handler_fread_mmap(uint32_t key, int sockfd, size_t count, size_t* len, uint32_t* err_no);
+// Send up to 'count' bytes of the stream to the socket by io_uring or 'sendfile()' (plain mode only).
+// Returns RXS_EOF on end of file
+ssize_t rxs_handler_fread_plain(uint32_t key, int sockfd, size_t count, size_t* len, uint32_t* err_no);
+// Send the ranges of the stream to the socket back to back (plain mode only). The ranges are cut by the end of file
+// ('len' is set to the sent size), the position of the stream is not changed.
+ssize_t rxs_handler_preadv(uint32_t key, int sockfd, rxs_range_t* ranges, uint32_t ranges_cnt, uint32_t* err_no);
 ssize_t rxs_handler_fwrite(uint32_t key, uint8_t* data, uint32_t len, uint32_t* err_no);
+// Receive 'count' bytes from the socket to the stream by io_uring, 'splice()' or the large buffer (plain mode only)
+ssize_t rxs_handler_fwrite_plain(uint32_t key, int sockfd, size_t count, size_t* len, uint32_t* err_no);
 ssize_t rxs_handler_fflush(uint32_t key, int* status, uint32_t* err_no);
 ssize_t rxs_handler_fclose(uint32_t key, int* status, uint32_t* err_no);
-ssize_t rxs_handler_fseek(uint32_t key, uint32_t val2, uint32_t val3, int* status, uint32_t* err_no);
+// Reposition the stream, 'position' is the new offset from the beginning of the file
+// Return value: on success returns 0, otherwise -1 and 'err_no' is set
+ssize_t rxs_handler_fseek(uint32_t key, int64_t offset, int whence, int64_t* position, uint32_t* err_no);
 ssize_t rxs_handler_ftell(uint32_t key, long* status, uint32_t* err_no);
 ssize_t rxs_handler_rewind(uint32_t key, int* status, uint32_t* err_no);
+// Move the stream to 'offset' (positioned read/write)
+// Return value: on success returns 0, otherwise -1 and 'err_no' is set
+ssize_t rxs_handler_seek(uint32_t key, uint64_t offset, uint32_t* err_no);
 ssize_t rxs_handler_is_file(uint8_t* data, int* status, uint32_t* err_no);
 ssize_t rxs_handler_is_dir(uint8_t* data, int* status, uint32_t* err_no);
 // Run operation
@@ -0,0 +1,75 @@
+/*******************************************************************************
+** Copyright (c) 2012 - 2023 v.arteev
+
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+
+** The above copyright notice and this permission notice shall be included in all
+** copies or substantial portions of the Software.
+
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+*******************************************************************************/
+#ifndef _RXS_RATE_LIMIT_H
+#define _RXS_RATE_LIMIT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <pthread.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// Rate limit of data channels (token bucket): tokens (bytes) are added at 'rate' bytes per second up to 'burst' bytes.
+// Moved data take tokens, the taker sleeps while the bucket is in debt. Data of both directions are counted.
+//////////////////////////////////////////////////////////////////////////////////////////////////
+#define RATE_LIMIT_PORTION_SZ (64 * 1024)  // Shaped data are moved by portions up to this size
+#define RATE_LIMIT_BURST_MSEC 100          // Default burst: data of this time at the rate
+#define RATE_LIMIT_USERS_MAX 64            // Users are shaped by the shared buckets of the server
+#define RATE_LIMIT_USER_SZ 64
+
+typedef struct rate_limit_t {
+  pthread_mutex_t mutex;
+  uint64_t rate;        // Bytes per second (0 - no limit)
+  uint64_t burst;       // Capacity of the bucket
+  int64_t tokens;       // Negative value is the debt of taken data
+  uint64_t stamp_nsec;  // Time of the last refill
+} rate_limit_t;
+
+// 'pshared' - the bucket is placed in the shared memory and it is used by several processes
+ssize_t init_rate_limit_t(rate_limit_t* limit, uint64_t rate, uint64_t burst, uint8_t pshared);
+ssize_t dinit_rate_limit_t(rate_limit_t* limit);
+// Change the limit, zero 'burst' sets the default one. The bucket becomes full.
+ssize_t set_rate_limit_t(rate_limit_t* limit, uint64_t rate, uint64_t burst);
+uint8_t rate_limit_active(const rate_limit_t* limit);
+// Take tokens of moved data, the caller sleeps while the bucket is in debt (nothing for NULL or unlimited bucket)
+void rate_limit_take(rate_limit_t* limit, size_t bytes);
+// Parse limit: 'RATE[:BURST]', values are bytes with optional suffix 'K', 'M' or 'G' (e.g. '10M:512K')
+ssize_t parse_rate_limit(const char* lexeme, uint64_t* rate, uint64_t* burst);
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// Buckets of the server (server-wide and per user) are shared by processes forked after 'init_rate_limit_shared()'
+//////////////////////////////////////////////////////////////////////////////////////////////////
+ssize_t init_rate_limit_shared(uint64_t rate, uint64_t burst);
+ssize_t dinit_rate_limit_shared();
+// Server-wide bucket (NULL - the shared state is not created)
+rate_limit_t* get_rate_limit_server();
+// Bucket of the user is shared by all sessions of the user, its limit is updated by the values of the session
+// Return value: the bucket, or NULL if the shared state is not created or all buckets are taken by other users
+rate_limit_t* get_rate_limit_user(const char* name, uint64_t rate, uint64_t burst);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // _RXS_RATE_LIMIT_H
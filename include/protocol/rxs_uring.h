@@ -0,0 +1,83 @@
+/*******************************************************************************
+** Copyright (c) 2012 - 2023 v.arteev
+
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+
+** The above copyright notice and this permission notice shall be included in all
+** copies or substantial portions of the Software.
+
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+*******************************************************************************/
+#ifndef _RXS_URING_H
+#define _RXS_URING_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <sys/types.h>
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// io_uring storage backend of the server (Linux 5.6+). It is used by the data paths of streams in plain mode:
+// file -> socket (linked read/send) and socket -> file (recv, then write while next recv is in flight).
+// On other systems or kernels without io_uring the functions fail with ENOSYS and the server uses the POSIX path.
+//////////////////////////////////////////////////////////////////////////////////////////////////
+#define RXS_URING_ENTRIES 32
+#define RXS_URING_BUFS_CNT 4
+#define RXS_URING_BUF_SZ (256 * 1024)
+
+typedef struct rxs_uring_t {
+  int ring_fd;
+  // Submission queue
+  void* sq_ptr;
+  size_t sq_ptr_sz;
+  unsigned* sq_head;
+  unsigned* sq_tail;
+  unsigned* sq_mask;
+  unsigned* sq_array;
+  void* sqes;  // struct io_uring_sqe[]
+  size_t sqes_sz;
+  unsigned sq_entries;
+  // Completion queue
+  void* cq_ptr;
+  size_t cq_ptr_sz;
+  unsigned* cq_head;
+  unsigned* cq_tail;
+  unsigned* cq_mask;
+  void* cqes;  // struct io_uring_cqe[]
+  // Buffers (registered if it is allowed by RLIMIT_MEMLOCK)
+  uint8_t* bufs;
+  uint32_t bufs_cnt;
+  size_t buf_sz;
+  uint8_t bufs_registered;
+} rxs_uring_t;
+
+// Return value: 1 if io_uring can be used on this system, otherwise 0
+ssize_t rxs_uring_available();
+// Return value: on success returns 0, otherwise -1 and errno is set
+ssize_t init_rxs_uring_t(rxs_uring_t* ring, uint32_t entries, uint32_t bufs_cnt, size_t buf_sz);
+ssize_t dinit_rxs_uring_t(rxs_uring_t* ring);
+// Send up to 'count' bytes of the file from 'offset' to the socket. 'offset' is moved behind sent data.
+// Return value: on success returns 0 (short count is the end of file), otherwise -1 and errno is set
+ssize_t rxs_uring_file_to_socket(rxs_uring_t* ring, int fd, int sockfd, off_t* offset, size_t count, size_t* len);
+// Receive 'count' bytes from the socket to the file from 'offset'. 'offset' is moved behind written data.
+// Return value: on success returns 0, otherwise -1 and errno is set
+ssize_t rxs_uring_socket_to_file(rxs_uring_t* ring, int sockfd, int fd, off_t* offset, size_t count, size_t* len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // _RXS_URING_H
@@ -72,6 +72,13 @@ const char* MSGS[] = {"%s",  // 0
                       "%s file not specified",  // 57
                       "",
                       "setsockopt(%s) error:%s",
+                      "limit of open streams '%" PRIu32 "' has been reached",  // 60
+                      "%s I/O backend: %s",                                     // 61
+                      "io_uring is not available (%s), fallback to %s",         // 62
+                      "direct I/O is not available for '%s' (%s)",              // 63
+                      "%s read mode: %s",                                       // 64
+                      "%s durability: %s (periodic %" PRIu32 " MB)",            // 65
+                      "%s rate limit: %" PRIu64 " B/s (burst %" PRIu64 " B)",   // 66
                       ""};  //
 
 void log_msg(int severity, int number_msg, ...) {
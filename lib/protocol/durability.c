@@ -0,0 +1,236 @@
+/*******************************************************************************
+** Copyright (c) 2012 - 2023 v.arteev
+
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+
+** The above copyright notice and this permission notice shall be included in all
+** copies or substantial portions of the Software.
+
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+*******************************************************************************/
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE  // for 'MAP_ANONYMOUS'
+#endif
+#include <errno.h>  // for 'errno'
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>  // for 'mmap()'
+#include <sys/types.h>
+#include <time.h>
+#include <unistd.h>
+#ifndef __QNXNTO__
+#include <linux/limits.h>  // for 'PATH_MAX'
+#else
+#include <limits.h>
+#endif
+
+#include "protocol/durability.h"
+#include "protocol/generic.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// Group commit: the state is placed in the shared memory, so it is common for all sessions of the server
+//////////////////////////////////////////////////////////////////////////////////////////////////
+typedef struct group_commit_t {
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  uint64_t wave;          // Number of the current wave of flushes
+  uint32_t flushing;      // Commits of the wave which are flushing own files (0 - no wave is in progress)
+  struct timespec lease;  // The wave is not waited after this time
+} group_commit_t;
+
+static durability_t durability_mode = DURABILITY_CLOSE;
+static uint32_t durability_periodic_mb = DURABILITY_PERIODIC_MB;
+static group_commit_t* group_commit = NULL;
+
+ssize_t set_durability_policy(durability_t mode, uint32_t periodic_mb) {
+  durability_mode = mode;
+  durability_periodic_mb = (periodic_mb) ? (periodic_mb) : (DURABILITY_PERIODIC_MB);
+  return 0;
+}
+durability_t get_durability_policy(uint32_t* periodic_mb) {
+  if (periodic_mb) *periodic_mb = durability_periodic_mb;
+  return durability_mode;
+}
+ssize_t parse_durability_policy(const char* lexeme, durability_t* mode, uint32_t* periodic_mb) {
+  if (!lexeme || !mode || !periodic_mb) return -1;
+
+  *periodic_mb = DURABILITY_PERIODIC_MB;
+  if (strcmp(lexeme, "none") == 0) {
+    *mode = DURABILITY_NONE;
+  } else if (strcmp(lexeme, "close") == 0) {
+    *mode = DURABILITY_CLOSE;
+  } else if (strcmp(lexeme, "full") == 0) {
+    *mode = DURABILITY_FULL;
+  } else if (strncmp(lexeme, "periodic", strlen("periodic")) == 0) {
+    *mode = DURABILITY_PERIODIC;
+    const char* value = lexeme + strlen("periodic");
+    if ('\0' == *value) return 0;
+    if ((*value != ':') || (str_to_uint32_t(value + 1, strlen(value + 1), periodic_mb) != 0) || !*periodic_mb)
+      return -1;
+  } else {
+    return -1;
+  }
+  return 0;
+}
+ssize_t init_group_commit() {
+#ifdef __QNXNTO__
+  return 0;
+#else
+  if (group_commit) return 0;
+
+  void* ptr = mmap(NULL, sizeof(group_commit_t), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (MAP_FAILED == ptr) return -1;
+  group_commit_t* group = (group_commit_t*)ptr;
+  memset(group, 0, sizeof(*group));
+
+  pthread_mutexattr_t mutex_attr;
+  pthread_mutexattr_init(&mutex_attr);
+  pthread_mutexattr_setpshared(&mutex_attr, PTHREAD_PROCESS_SHARED);
+  pthread_mutexattr_setrobust(&mutex_attr, PTHREAD_MUTEX_ROBUST);
+  int res = pthread_mutex_init(&group->mutex, &mutex_attr);
+  pthread_mutexattr_destroy(&mutex_attr);
+
+  pthread_condattr_t cond_attr;
+  pthread_condattr_init(&cond_attr);
+  pthread_condattr_setpshared(&cond_attr, PTHREAD_PROCESS_SHARED);
+  pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
+  if (0 == res) res = pthread_cond_init(&group->cond, &cond_attr);
+  pthread_condattr_destroy(&cond_attr);
+  if (res != 0) {
+    munmap(ptr, sizeof(group_commit_t));
+    errno = res;
+    return -1;
+  }
+  group_commit = group;
+  return 0;
+#endif
+}
+ssize_t dinit_group_commit() {
+  if (!group_commit) return 0;
+
+  // CAUTION: the state is destroyed only by the process which has created it, sessions just unmap it
+  munmap(group_commit, sizeof(group_commit_t));
+  group_commit = NULL;
+  return 0;
+}
+static int flush_fd(int fd, durability_t mode) {
+  int res = 0;
+  do {
+    res = (DURABILITY_FULL == mode) ? fsync(fd) : fdatasync(fd);
+  } while ((res != 0) && (EINTR == errno));
+  return res;
+}
+static void deadline_after(struct timespec* ts, uint32_t msec) {
+  clock_gettime(CLOCK_MONOTONIC, ts);
+  ts->tv_sec += msec / 1000;
+  ts->tv_nsec += (long)(msec % 1000) * 1000000L;
+  if (ts->tv_nsec >= 1000000000L) {
+    ts->tv_sec++;
+    ts->tv_nsec -= 1000000000L;
+  }
+}
+// The wave is not done in time: its commits are not waited anymore
+static uint8_t lease_expired(const group_commit_t* group) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return ((now.tv_sec > group->lease.tv_sec) ||
+          ((now.tv_sec == group->lease.tv_sec) && (now.tv_nsec >= group->lease.tv_nsec)))
+             ? (1)
+             : (0);
+}
+// Close the wave, so the waiting commits start the next one
+static void end_wave(group_commit_t* group) {
+  group->flushing = 0;
+  group->wave++;
+  pthread_cond_broadcast(&group->cond);
+}
+static int lock_group_commit(group_commit_t* group) {
+  int res = pthread_mutex_lock(&group->mutex);
+  // The owner has died: the wave is lost, the waiting commits start the next one
+  if (EOWNERDEAD == res) {
+    end_wave(group);
+    pthread_mutex_consistent(&group->mutex);
+    res = 0;
+  }
+  return res;
+}
+int durable_commit_fd(int fd, durability_t mode) {
+  if (fd < 0) {
+    errno = EBADF;
+    return -1;
+  }
+  if (DURABILITY_NONE == mode) return 0;
+#ifdef __QNXNTO__
+  return flush_fd(fd, mode);
+#else
+  if (!group_commit || (lock_group_commit(group_commit) != 0)) return flush_fd(fd, mode);
+
+  //////////////////////////////////////////////////////////////////////////////////
+  // Every commit flushes own file, the group only gathers them into waves: commits coming while a wave is in progress
+  // wait for its end and flush together, so the file system commits its journal once for them.
+  //////////////////////////////////////////////////////////////////////////////////
+  group_commit_t* group = group_commit;
+  uint64_t wave = group->wave;
+  while (group->flushing && (group->wave == wave)) {
+    struct timespec deadline;
+    deadline_after(&deadline, GROUP_COMMIT_CHECK_MSEC);
+    int res = pthread_cond_timedwait(&group->cond, &group->mutex, &deadline);
+    if (EOWNERDEAD == res) {
+      end_wave(group);
+      pthread_mutex_consistent(&group->mutex);
+    } else if ((ETIMEDOUT == res) && (group->wave == wave) && lease_expired(group)) {
+      // A commit of the wave is stuck or its process is dead
+      end_wave(group);
+    }
+  }
+  if (!group->flushing) deadline_after(&group->lease, GROUP_COMMIT_WAIT_SEC * 1000);
+  group->flushing++;
+  wave = group->wave;
+  pthread_mutex_unlock(&group->mutex);
+
+  int res = flush_fd(fd, mode);
+  int err_no = errno;
+
+  // The wave can be closed by the lease meanwhile, so the next one is not touched
+  if (lock_group_commit(group) == 0) {
+    if ((group->wave == wave) && group->flushing && (0 == --group->flushing)) end_wave(group);
+    pthread_mutex_unlock(&group->mutex);
+  }
+  errno = err_no;
+  return res;
+#endif
+}
+int durable_commit_dir(const char* path, durability_t mode) {
+  if (!path) return -1;
+  if (mode != DURABILITY_FULL) return 0;
+
+  char dir[PATH_MAX] = {0};
+  const char* slash = strrchr(path, '/');
+  if (!slash)
+    snprintf(dir, sizeof(dir), ".");
+  else if (slash == path)
+    snprintf(dir, sizeof(dir), "/");
+  else
+    snprintf(dir, sizeof(dir), "%.*s", (int)(slash - path), path);
+
+  int fd = open(dir, O_RDONLY | O_DIRECTORY);
+  if (fd < 0) return -1;
+  int res = flush_fd(fd, DURABILITY_FULL);
+  int err_no = errno;
+  close(fd);
+  errno = err_no;
+  return res;
+}
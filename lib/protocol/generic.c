@@ -27,7 +27,7 @@ all
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <time.h>    // for 'nanosleep'
-#include <unistd.h>  // for 'sync()'
+#include <unistd.h>  // for 'unlink()'
 #ifndef __QNXNTO__
 #include <linux/limits.h>  // for 'PATH_MAX'
 #if defined(__APPLE__) || defined(__FreeBSD__)
@@ -40,6 +40,7 @@ all
 #include <stdio.h>   // for 'FILE'
 #include <stdlib.h>  // for 'calloc()'
 
+#include "protocol/durability.h"
 #include "protocol/generic.h"
 
 /////////////////////////////////////////////////////////////////////////////////////
@@ -937,15 +938,15 @@ int write_file(const char* filename, const char* buf, size_t buf_sz, const char*
   }
   size_t write_bytes = fwrite(buf, sizeof(buf[0]), buf_sz, fhandle);
 
+  // Commit data of this file only (see durability policy)
+  int res = fflush(fhandle);
+  if (0 == res) res = durable_commit_fd(fileno(fhandle), get_durability_policy(NULL));
   // Close handler
-  fflush(fhandle);
-  fclose(fhandle);
+  if (fclose(fhandle) != 0) res = -1;
 
-  if (write_bytes != buf_sz) {
+  if ((write_bytes != buf_sz) || (res != 0)) {
     return -1;
   }
-  // first commits inodes to buffers, and then buffers to disk.
-  sync();
   return 0;
 }
 // Remove file
@@ -954,8 +955,7 @@ int remove_file(const char* dir, const char* file) {
   char path[PATH_MAX] = {0};
   snprintf(path, sizeof(path), "%s/%s", dir, file);
   int res = unlink(path);
-  // first commits inodes to buffers, and then buffers to disk.
-  sync();
+  if (0 == res) res = durable_commit_dir(path, get_durability_policy(NULL));
   return res;
 }
 // Truncate file
@@ -964,8 +964,12 @@ int truncate_file(const char* dir, const char* file) {
   char path[PATH_MAX] = {0};
   snprintf(path, sizeof(path), "%s/%s", dir, file);
   int res = truncate(path, 0);
-  // first commits inodes to buffers, and then buffers to disk.
-  sync();
+  durability_t mode = get_durability_policy(NULL);
+  if ((0 == res) && (mode != DURABILITY_NONE)) {
+    int fd = open(path, O_RDONLY);
+    res = (fd < 0) ? (-1) : (durable_commit_fd(fd, mode));
+    if (fd >= 0) close(fd);
+  }
   return res;
 }
 // Is dir
@@ -19,10 +19,15 @@
 ** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 ** SOFTWARE.
 *******************************************************************************/
+#include <errno.h>     // for 'errno'
+#include <fcntl.h>     // for 'O_APPEND'
 #include <inttypes.h>  // for 'PRIu32'
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>  // for 'munmap()'
+#include <sys/stat.h>  // for 'fstat()'
 #include <sys/types.h>
+#include <unistd.h>  // for 'close()'
 
 #include "protocol/generic.h"
 #include "protocol/internal_types.h"
@@ -36,14 +41,46 @@ ssize_t init_file_handlers_t(file_handlers_t* file_handlers, uint32_t fhandle_ke
 
   file_handlers->fhandle_key = fhandle_key;
   file_handlers->fhandle_val = fhandle;
+  file_handlers->direct_fd = -1;
+  file_handlers->data_fd = -1;
+  file_handlers->seq_next = 0;
+  file_handlers->seq_cnt = 0;
+  file_handlers->ra_window = READAHEAD_WINDOW_MIN;
+  file_handlers->ra_end = 0;
+  file_handlers->dontneed_end = 0;
+  file_handlers->durability = 0;
+  file_handlers->dirty_sz = 0;
+  file_handlers->wb_buf = NULL;
+  file_handlers->wb_sz = 0;
+  file_handlers->wb_len = 0;
+  file_handlers->wb_offset = 0;
+  file_handlers->wb_blk = 0;
+  file_handlers->wb_err = 0;
+  file_handlers->mmap_mode = 0;
+  file_handlers->map_ptr = NULL;
+  file_handlers->map_offset = 0;
+  file_handlers->map_sz = 0;
   return 0;
 }
 ssize_t dinit_file_handlers_t(file_handlers_t* file_handlers) {
   if (!file_handlers) return -1;
 
+  // Slot is in use (stream can be already closed by the caller)
+  if (file_handlers->fhandle_key) {
+    // Write the rest of data (the session is closed without 'fclose()')
+    if (file_handlers->fhandle_val) flush_write_behind_file_handlers_t(file_handlers);
+    free(file_handlers->wb_buf);
+    file_handlers->wb_buf = NULL;
+    if (file_handlers->map_ptr) munmap(file_handlers->map_ptr, file_handlers->map_sz);
+    if (file_handlers->direct_fd >= 0) close(file_handlers->direct_fd);
+    if (file_handlers->data_fd >= 0) close(file_handlers->data_fd);
+  }
   file_handlers->fhandle_key = 0;
   if (file_handlers->fhandle_val) fclose(file_handlers->fhandle_val);
   file_handlers->fhandle_val = NULL;
+  file_handlers->direct_fd = -1;
+  file_handlers->data_fd = -1;
+  file_handlers->map_ptr = NULL;
   return 0;
 }
 void free_file_handlers_t(void* file_handlers) {
@@ -51,6 +88,210 @@ void free_file_handlers_t(void* file_handlers) {
   free(file_handlers);
   return;
 }
+ssize_t write_behind_file_handlers_t(file_handlers_t* file_handlers, const uint8_t* data, size_t data_sz,
+                                     uint32_t wb_mb) {
+  if (!file_handlers || !file_handlers->fhandle_val || (!data && data_sz)) return -1;
+
+  int fd = fileno(file_handlers->fhandle_val);
+  //////////////////////////////////////////////////////////////////////////////////
+  // Buffer is aligned to the block of the file system
+  //////////////////////////////////////////////////////////////////////////////////
+  if (!file_handlers->wb_buf) {
+    struct stat st;
+    if (fstat(fd, &st) != 0) return -1;
+    size_t blk = (st.st_blksize > 0) ? ((size_t)st.st_blksize) : (4096);
+    size_t wb_sz = ((size_t)((wb_mb) ? (wb_mb) : (WRITE_BEHIND_MB)) << 20) / blk * blk;
+    if (!wb_sz) wb_sz = blk;
+    void* buf = NULL;
+    int err_no = posix_memalign(&buf, blk, wb_sz);
+    if (err_no != 0) {
+      errno = err_no;
+      return -1;
+    }
+    file_handlers->wb_buf = (uint8_t*)buf;
+    file_handlers->wb_sz = wb_sz;
+    file_handlers->wb_blk = blk;
+    file_handlers->wb_len = 0;
+  }
+  while (data_sz > 0) {
+    // Start of the dirty range: the logical position of the stream
+    if (0 == file_handlers->wb_len) {
+      if (fflush(file_handlers->fhandle_val) != 0) return -1;
+      int flags = fcntl(fd, F_GETFL);
+      off_t offset = ((flags >= 0) && (flags & O_APPEND)) ? (lseek(fd, 0, SEEK_END))
+                                                           : (ftello(file_handlers->fhandle_val));
+      if (offset < 0) return -1;
+      file_handlers->wb_offset = offset;
+    }
+    // The first write ends on the block boundary, the next ones are aligned
+    size_t limit = file_handlers->wb_sz - (size_t)(file_handlers->wb_offset % (off_t)file_handlers->wb_blk);
+    size_t part_sz = ((limit - file_handlers->wb_len) < data_sz) ? (limit - file_handlers->wb_len) : (data_sz);
+    memcpy(file_handlers->wb_buf + file_handlers->wb_len, data, part_sz);
+    file_handlers->wb_len += part_sz;
+    data += part_sz;
+    data_sz -= part_sz;
+    if ((file_handlers->wb_len == limit) && (flush_write_behind_file_handlers_t(file_handlers) != 0)) return -1;
+  }
+  return 0;
+}
+ssize_t flush_write_behind_file_handlers_t(file_handlers_t* file_handlers) {
+  if (!file_handlers || !file_handlers->fhandle_val) return -1;
+  if (0 == file_handlers->wb_len) return 0;
+
+  int fd = fileno(file_handlers->fhandle_val);
+  size_t write_bytes = 0;
+  while (write_bytes < file_handlers->wb_len) {
+    ssize_t res = pwrite(fd, file_handlers->wb_buf + write_bytes, file_handlers->wb_len - write_bytes,
+                         file_handlers->wb_offset + (off_t)write_bytes);
+    if (res < 0) {
+      if (EINTR == errno) continue;
+      // Data are lost: the error is kept for the next call on the stream
+      file_handlers->wb_err = errno;
+      file_handlers->wb_len = 0;
+      return -1;
+    }
+    write_bytes += (size_t)res;
+  }
+  file_handlers->wb_offset += (off_t)write_bytes;
+  file_handlers->wb_len = 0;
+  // Move the stream behind written data
+  return (fseeko(file_handlers->fhandle_val, file_handlers->wb_offset, SEEK_SET) == 0) ? 0 : -1;
+}
+// file_handlers_tbl_t
+static file_handlers_t* slot_file_handlers_tbl_t(const file_handlers_tbl_t* tbl, uint32_t index) {
+  if ((index / FHANDLE_SLAB_SZ) >= tbl->slabs_cnt) return NULL;
+  return &tbl->slabs[index / FHANDLE_SLAB_SZ][index % FHANDLE_SLAB_SZ];
+}
+ssize_t init_file_handlers_tbl_t(file_handlers_tbl_t* tbl, uint32_t opened_max) {
+  if (!tbl) return -1;
+
+  tbl->slabs = NULL;
+  tbl->slabs_cnt = 0;
+  tbl->free_head = 0;
+  tbl->opened = 0;
+  tbl->opened_max = (opened_max > FHANDLE_INDEX_MASK) ? FHANDLE_INDEX_MASK : opened_max;
+  return 0;
+}
+ssize_t dinit_file_handlers_tbl_t(file_handlers_tbl_t* tbl) {
+  if (!tbl) return -1;
+
+  for (uint32_t i = 0; i < tbl->slabs_cnt; ++i) {
+    // Close file handlers
+    for (uint32_t j = 0; j < FHANDLE_SLAB_SZ; ++j) dinit_file_handlers_t(&tbl->slabs[i][j]);
+    free(tbl->slabs[i]);
+  }
+  free(tbl->slabs);
+  tbl->slabs = NULL;
+  tbl->slabs_cnt = 0;
+  tbl->free_head = 0;
+  tbl->opened = 0;
+  return 0;
+}
+ssize_t insert_file_handlers_tbl_t(file_handlers_tbl_t* tbl, FILE* fhandle, uint32_t* fhandle_key) {
+  if (!tbl || !fhandle || !fhandle_key) return -1;
+
+  if (tbl->opened >= tbl->opened_max) {
+    errno = EMFILE;
+    return -1;
+  }
+  //////////////////////////////////////////////////////////////////////////////////
+  // No free slots: add a new slab
+  //////////////////////////////////////////////////////////////////////////////////
+  if (0 == tbl->free_head) {
+    file_handlers_t** slabs = realloc(tbl->slabs, (tbl->slabs_cnt + 1) * sizeof(file_handlers_t*));
+    if (!slabs) return -1;
+    tbl->slabs = slabs;
+
+    file_handlers_t* slab = new_file_handlers_t(FHANDLE_SLAB_SZ);
+    if (!slab) return -1;
+    tbl->slabs[tbl->slabs_cnt] = slab;
+    // Put slots of the new slab to the free list
+    uint32_t index_first = tbl->slabs_cnt * FHANDLE_SLAB_SZ;
+    for (uint32_t j = 0; j < FHANDLE_SLAB_SZ; ++j)
+      slab[j].next_free = (j + 1 < FHANDLE_SLAB_SZ) ? (index_first + j + 2) : (0);
+    tbl->free_head = index_first + 1;
+    ++tbl->slabs_cnt;
+  }
+  uint32_t index = tbl->free_head - 1;
+  file_handlers_t* slot = slot_file_handlers_tbl_t(tbl, index);
+  tbl->free_head = slot->next_free;
+  slot->next_free = 0;
+
+  *fhandle_key = ((uint32_t)slot->generation << FHANDLE_INDEX_BITS) | (index + 1);
+  init_file_handlers_t(slot, *fhandle_key, fhandle);
+  ++tbl->opened;
+  return 0;
+}
+file_handlers_t* find_file_handlers_tbl_t(const file_handlers_tbl_t* tbl, uint32_t fhandle_key) {
+  if (!tbl || !(fhandle_key & FHANDLE_INDEX_MASK)) return NULL;
+
+  file_handlers_t* slot = slot_file_handlers_tbl_t(tbl, (fhandle_key & FHANDLE_INDEX_MASK) - 1);
+  if (!slot || (slot->fhandle_key != fhandle_key)) return NULL;
+  return slot;
+}
+ssize_t remove_file_handlers_tbl_t(file_handlers_tbl_t* tbl, uint32_t fhandle_key) {
+  file_handlers_t* slot = find_file_handlers_tbl_t(tbl, fhandle_key);
+  if (!slot) return -1;
+
+  // Close file handler
+  dinit_file_handlers_t(slot);
+  ++slot->generation;
+  slot->next_free = tbl->free_head;
+  tbl->free_head = (fhandle_key & FHANDLE_INDEX_MASK);
+  --tbl->opened;
+  return 0;
+}
+ssize_t flush_write_behind_file_handlers_tbl_t(file_handlers_tbl_t* tbl) {
+  if (!tbl) return -1;
+
+  ssize_t result = 0;
+  for (uint32_t i = 0; i < tbl->slabs_cnt; ++i) {
+    for (uint32_t j = 0; j < FHANDLE_SLAB_SZ; ++j) {
+      file_handlers_t* slot = &tbl->slabs[i][j];
+      if (slot->fhandle_key && slot->wb_len && (flush_write_behind_file_handlers_t(slot) != 0)) result = -1;
+    }
+  }
+  return result;
+}
+// aligned_buf_pool_t
+ssize_t init_aligned_buf_pool_t(aligned_buf_pool_t* pool, size_t buf_sz, size_t align) {
+  if (!pool || !buf_sz || !align) return -1;
+
+  memset(pool->bufs, 0, sizeof(pool->bufs));
+  pool->bufs_cnt = 0;
+  pool->buf_sz = buf_sz;
+  pool->align = align;
+  return 0;
+}
+ssize_t dinit_aligned_buf_pool_t(aligned_buf_pool_t* pool) {
+  if (!pool) return -1;
+
+  // Free memory
+  while (pool->bufs_cnt > 0) free(pool->bufs[--pool->bufs_cnt]);
+  return 0;
+}
+uint8_t* get_aligned_buf_pool_t(aligned_buf_pool_t* pool) {
+  if (!pool) return NULL;
+
+  if (pool->bufs_cnt > 0) return pool->bufs[--pool->bufs_cnt];
+
+  void* buf = NULL;
+  int err_no = posix_memalign(&buf, pool->align, pool->buf_sz);
+  if (err_no != 0) {
+    errno = err_no;
+    return NULL;
+  }
+  return (uint8_t*)buf;
+}
+void put_aligned_buf_pool_t(aligned_buf_pool_t* pool, uint8_t* buf) {
+  if (!pool || !buf) return;
+
+  if (pool->bufs_cnt < DIRECT_IO_BUFS_MAX)
+    pool->bufs[pool->bufs_cnt++] = buf;
+  else
+    free(buf);
+  return;
+}
 // addr_t
 void* new_addr_t(size_t count) { return calloc(count, sizeof(addr_t)); }
 ssize_t init_addr_t(addr_t* addr, uint32_t addr_n) {
@@ -129,6 +370,7 @@ ssize_t dinit_user_info_t(user_info_t* user_info) {
   memset(user_info->pass, 0, sizeof(user_info->pass));
   memset(user_info->group, 0, sizeof(user_info->group));
   memset(user_info->home_dir, 0, sizeof(user_info->home_dir));
+  memset(user_info->rate_limit, 0, sizeof(user_info->rate_limit));
 
   return 0;
 }
@@ -144,5 +386,6 @@ ssize_t copy_user_info_t(const user_info_t* src, user_info_t* dst) {
   if (memcpy_x(dst->pass, sizeof(dst->pass), src->pass, sizeof(src->pass)) != 0) return -1;
   if (memcpy_x(dst->group, sizeof(dst->group), src->group, sizeof(src->group)) != 0) return -1;
   if (memcpy_x(dst->home_dir, sizeof(dst->home_dir), src->home_dir, sizeof(src->home_dir)) != 0) return -1;
+  if (memcpy_x(dst->rate_limit, sizeof(dst->rate_limit), src->rate_limit, sizeof(src->rate_limit)) != 0) return -1;
   return 0;
 }
@@ -38,6 +38,8 @@
 #include <limits.h>     // for 'UINT_MAX'
 
 #include "container/list.h"
+#include "protocol/durability.h"
+#include "protocol/rate_limit.h"
 #include "protocol/generic.h"
 #include "protocol/internal_types.h"
 #include "protocol/parser.h"
@@ -72,6 +74,10 @@ static int compose_user_info_t_to_object(const char* lexeme, size_t lexeme_sz, s
     case 3:
       if (memcpy_x(user_info->home_dir, sizeof(user_info->home_dir), lexeme, lexeme_sz) != 0) return -1;
       break;
+    // rate limit (optional)
+    case 4:
+      if (memcpy_x(user_info->rate_limit, sizeof(user_info->rate_limit), lexeme, lexeme_sz) != 0) return -1;
+      break;
   }
   return 0;
 }
@@ -165,7 +171,7 @@ ssize_t parse_addr(char* optarg, dlist_t** addr_allowed_lst) {
   return 0;
 }
 // Parse cmd's arguments
-ssize_t parse_args(int cnt, char* val[], uint32_t* addr_rxs, uint16_t* port_rxs, dlist_t** addr_allowed_lst, int* mode_running, char* file_users, int* pid_host, uint8_t * encoder_mode)
+ssize_t parse_args(int cnt, char* val[], uint32_t* addr_rxs, uint16_t* port_rxs, dlist_t** addr_allowed_lst, int* mode_running, char* file_users, int* pid_host, uint8_t * encoder_mode, uint8_t * io_backend, uint8_t * read_mode, uint8_t * durability, uint32_t * durability_mb, uint64_t * rate_limit, uint64_t * rate_burst)
 {
 #ifdef __QNXNTO__
   return 0;
@@ -191,6 +197,10 @@ ssize_t parse_args(int cnt, char* val[], uint32_t* addr_rxs, uint16_t* port_rxs,
         {"file_users",             required_argument,  0,  'f' },
         {"pid",                    required_argument,  0,  'p' },
         {"encoder",                no_argument,        0,  'e' },
+        {"io_backend",             required_argument,  0,  'u' },
+        {"read_mode",              required_argument,  0,  'r' },
+        {"durability",             required_argument,  0,  's' },
+        {"rate_limit",             required_argument,  0,  't' },
         {0, 0,  0,  0 }
     };
 
@@ -258,6 +268,56 @@ ssize_t parse_args(int cnt, char* val[], uint32_t* addr_rxs, uint16_t* port_rxs,
       case 'e':
         *encoder_mode = 1;
       break;
+      // io_backend (0 - posix; 1 - uring)
+      case 'u':
+      {
+        if(strcmp(optarg, "uring") == 0)
+          *io_backend = 1;
+        else if(strcmp(optarg, "posix") == 0)
+          *io_backend = 0;
+        else
+        {
+          fprintf(stderr, "ERRN: invalid value %s\n", optarg);
+          return -1;
+        }
+        break;
+      }
+      // read_mode (0 - stdio; 1 - mmap)
+      case 'r':
+      {
+        if(strcmp(optarg, "mmap") == 0)
+          *read_mode = 1;
+        else if(strcmp(optarg, "stdio") == 0)
+          *read_mode = 0;
+        else
+        {
+          fprintf(stderr, "ERRN: invalid value %s\n", optarg);
+          return -1;
+        }
+        break;
+      }
+      // durability (none, close, periodic[:N], full)
+      case 's':
+      {
+        durability_t mode = DURABILITY_CLOSE;
+        if(parse_durability_policy(optarg, &mode, durability_mb) != 0)
+        {
+          fprintf(stderr, "ERRN: invalid value %s\n", optarg);
+          return -1;
+        }
+        *durability = (uint8_t)mode;
+        break;
+      }
+      // rate_limit (RATE[:BURST])
+      case 't':
+      {
+        if(parse_rate_limit(optarg, rate_limit, rate_burst) != 0)
+        {
+          fprintf(stderr, "ERRN: invalid value %s\n", optarg);
+          return -1;
+        }
+        break;
+      }
       case 'p':
       {
         if(str_to_int_t(optarg, strlen(optarg), pid_host ) != 0)
@@ -183,6 +183,27 @@ ssize_t init_slot05_t(slot05_t* slot05) {
   return 0;
 }
 ssize_t dinit_slot05_t(slot05_t* slot05) { return init_slot05_t(slot05); }
+ssize_t init_slot06_t(slot06_t* slot06) {
+  if (!slot06) return -1;
+  slot06->stream_id = 0;
+  slot06->offset = 0;
+  slot06->data_sz = 0;
+  return 0;
+}
+ssize_t dinit_slot06_t(slot06_t* slot06) { return init_slot06_t(slot06); }
+ssize_t init_slot07_t(slot07_t* slot07) {
+  if (!slot07) return -1;
+  slot07->stream_id = 0;
+  slot07->val = 0;
+  slot07->ranges_cnt = 0;
+  slot07->ranges = NULL;
+  return 0;
+}
+ssize_t dinit_slot07_t(slot07_t* slot07) {
+  if (!slot07) return -1;
+  free(slot07->ranges);
+  return init_slot07_t(slot07);
+}
 
 ssize_t init_crypt_data_t(crypt_data_t* crypt_data) {
   if (!crypt_data) return -1;
@@ -413,6 +434,102 @@ ssize_t rxs_send_packet_x05(int sockfd, rxs_type_t type, rxs_operation_t operati
   if (impl_send < 0) return -1;
   return imp_total_data_sz;
 }
+ssize_t rxs_send_packet_x06(int sockfd, rxs_type_t type, rxs_operation_t operation, uint32_t stream, uint64_t offset,
+                            uint32_t data_sz) {
+  packet_rxs_t packet_rxs_send;
+  if (compose_packet_rxs_x06(type, operation, stream, offset, data_sz, &packet_rxs_send) < 0) return -1;
+  // Send packet
+  ssize_t impl_send = rxs_send_packet(sockfd, &packet_rxs_send);
+  if (impl_send < 0) return -1;
+  return 0;
+}
+ssize_t rxs_recv_packet_x06(int sockfd, rxs_type_t* type, rxs_operation_t operation, uint32_t* stream,
+                            uint64_t* offset, uint32_t* data_sz) {
+  if (sockfd < 0) return -1;
+
+  uint32_t buf_recv_sz = 1024 * 1024;
+  uint8_t* buf_recv = (uint8_t*)calloc(buf_recv_sz, sizeof(uint8_t));
+  if (!buf_recv) {
+    log_msg(ERRN, 6, "calloc", strerror(errno));
+    return -1;
+  }
+  ssize_t impl_recv_sz = rxs_recv_data_x(sockfd, buf_recv, buf_recv_sz);
+  if (impl_recv_sz <= 0) {
+    // Free memory
+    free(buf_recv);
+    buf_recv = NULL;
+    return -1;
+  }
+  packet_rxs_t packet_rxs_recv;
+  init_packet_rxs_t(&packet_rxs_recv);
+  slot06_t slot06;
+  init_slot06_t(&slot06);
+  ssize_t res = -1;
+  if ((deserialize_packet_rxs_t(buf_recv, (size_t)impl_recv_sz, &packet_rxs_recv) == 0) &&
+      (packet_rxs_recv.operation == operation) &&
+      (deserialize_slot06_t(packet_rxs_recv.data, (packet_rxs_recv.sz - hdr_packet_rxs_t_sz()), &slot06) == 0)) {
+    *type = packet_rxs_recv.type;
+    *stream = slot06.stream_id;
+    *offset = slot06.offset;
+    *data_sz = slot06.data_sz;
+    res = 0;
+  }
+  // Free memory
+  free(buf_recv);
+  buf_recv = NULL;
+  dinit_packet_rxs_t(&packet_rxs_recv);
+  dinit_slot06_t(&slot06);
+  return res;
+}
+ssize_t rxs_send_packet_x07(int sockfd, rxs_type_t type, rxs_operation_t operation, uint32_t stream, uint32_t val,
+                            const rxs_range_t* ranges, uint32_t ranges_cnt) {
+  packet_rxs_t packet_rxs_send;
+  if (compose_packet_rxs_x07(type, operation, stream, val, ranges, ranges_cnt, &packet_rxs_send) < 0) return -1;
+  // Send packet
+  ssize_t impl_send = rxs_send_packet(sockfd, &packet_rxs_send);
+  if (impl_send < 0) return -1;
+  return 0;
+}
+ssize_t rxs_recv_packet_x07(int sockfd, rxs_type_t* type, rxs_operation_t operation, uint32_t* stream, uint32_t* val,
+                            rxs_range_t* ranges, uint32_t ranges_max, uint32_t* ranges_cnt) {
+  if (sockfd < 0) return -1;
+
+  uint32_t buf_recv_sz = 1024 * 1024;
+  uint8_t* buf_recv = (uint8_t*)calloc(buf_recv_sz, sizeof(uint8_t));
+  if (!buf_recv) {
+    log_msg(ERRN, 6, "calloc", strerror(errno));
+    return -1;
+  }
+  ssize_t impl_recv_sz = rxs_recv_data_x(sockfd, buf_recv, buf_recv_sz);
+  if (impl_recv_sz <= 0) {
+    // Free memory
+    free(buf_recv);
+    buf_recv = NULL;
+    return -1;
+  }
+  packet_rxs_t packet_rxs_recv;
+  init_packet_rxs_t(&packet_rxs_recv);
+  slot07_t slot07;
+  init_slot07_t(&slot07);
+  ssize_t res = -1;
+  if ((deserialize_packet_rxs_t(buf_recv, (size_t)impl_recv_sz, &packet_rxs_recv) == 0) &&
+      (packet_rxs_recv.operation == operation) &&
+      (deserialize_slot07_t(packet_rxs_recv.data, (packet_rxs_recv.sz - hdr_packet_rxs_t_sz()), &slot07) == 0) &&
+      (slot07.ranges_cnt <= ranges_max)) {
+    *type = packet_rxs_recv.type;
+    *stream = slot07.stream_id;
+    *val = slot07.val;
+    *ranges_cnt = slot07.ranges_cnt;
+    if (slot07.ranges_cnt) memcpy(ranges, slot07.ranges, slot07.ranges_cnt * sizeof(rxs_range_t));
+    res = 0;
+  }
+  // Free memory
+  free(buf_recv);
+  buf_recv = NULL;
+  dinit_packet_rxs_t(&packet_rxs_recv);
+  dinit_slot07_t(&slot07);
+  return res;
+}
 //
 ssize_t rxs_recv_slot0x(int sockfd, void* buf, size_t size, void* slot0x, int* errno_other_side) {
   if (sockfd < 0) return -1;
@@ -494,7 +611,8 @@ ssize_t rxs_recv_slot0x(int sockfd, void* buf, size_t size, void* slot0x, int* e
           case operation_fseek:
           case operation_file_exist:
           case operation_dir_exist:
-          case operation_port: {
+          case operation_port:
+          case operation_ping: {
             slot00_t* slot00 = (slot00_t*)slot0x;
             // slot00_t slot00;
             // init_slot00_t(&slot00);
@@ -552,7 +670,8 @@ ssize_t rxs_recv_slot0x(int sockfd, void* buf, size_t size, void* slot0x, int* e
           case operation_fclose:
           case operation_ftell:
           case operation_filesize:
-          case operation_port: {
+          case operation_port:
+          case operation_ping: {
             // Free memory
             free(buf_recv);
             buf_recv = NULL;
@@ -984,6 +1103,130 @@ ssize_t deserialize_slot05_t(uint8_t* data, size_t data_sz, slot05_t* slot05) {
 
   return 0;
 }
+ssize_t serialize_slot06_t(void* slot0x, uint8_t** data, size_t* data_sz) {
+  if (!slot0x || !data || !data_sz) {
+    log_msg(ERRN, 14);
+    return -1;
+  }
+  slot06_t* slot06 = (slot06_t*)slot0x;
+  size_t sz = sizeof(slot06->stream_id) + sizeof(slot06->offset) + sizeof(slot06->data_sz);
+  *data = (uint8_t*)calloc(sz, sizeof(uint8_t));
+  if (!*data) {
+    log_msg(ERRN, 6, "calloc", strerror(errno));
+    return -1;
+  }
+  size_t offset = 0;
+  // stream_id
+  serialize_uint32_t(*data + offset, htonl(slot06->stream_id));
+  offset += sizeof(slot06->stream_id);
+  // offset in the file
+  serialize_uint64_t(*data + offset, htonll(slot06->offset));
+  offset += sizeof(slot06->offset);
+  // data size
+  serialize_uint32_t(*data + offset, htonl(slot06->data_sz));
+  offset += sizeof(slot06->data_sz);
+  // Set size
+  *data_sz = offset;
+
+  return 0;
+}
+ssize_t deserialize_slot06_t(uint8_t* data, size_t data_sz, slot06_t* slot06) {
+  if (!slot06 || !data) {
+    log_msg(ERRN, 14);
+    return -1;
+  }
+  if (data_sz < sizeof(slot06->stream_id) + sizeof(slot06->offset) + sizeof(slot06->data_sz)) return -1;
+  size_t offset = 0;
+  // stream_id
+  deserialize_uint32_t(data + offset, &slot06->stream_id);
+  offset += sizeof(slot06->stream_id);
+  slot06->stream_id = ntohl(slot06->stream_id);
+  // offset in the file
+  deserialize_uint64_t(data + offset, &slot06->offset);
+  offset += sizeof(slot06->offset);
+  slot06->offset = ntohll(slot06->offset);
+  // data size
+  deserialize_uint32_t(data + offset, &slot06->data_sz);
+  slot06->data_sz = ntohl(slot06->data_sz);
+
+  return 0;
+}
+ssize_t serialize_slot07_t(void* slot0x, uint8_t** data, size_t* data_sz) {
+  if (!slot0x || !data || !data_sz) {
+    log_msg(ERRN, 14);
+    return -1;
+  }
+  slot07_t* slot07 = (slot07_t*)slot0x;
+  size_t sz = sizeof(slot07->stream_id) + sizeof(slot07->val) + sizeof(slot07->ranges_cnt) +
+              slot07->ranges_cnt * (sizeof(slot07->ranges->offset) + sizeof(slot07->ranges->len));
+  *data = (uint8_t*)calloc(sz, sizeof(uint8_t));
+  if (!*data) {
+    log_msg(ERRN, 6, "calloc", strerror(errno));
+    return -1;
+  }
+  size_t offset = 0;
+  // stream_id
+  serialize_uint32_t(*data + offset, htonl(slot07->stream_id));
+  offset += sizeof(slot07->stream_id);
+  // value
+  serialize_uint32_t(*data + offset, htonl(slot07->val));
+  offset += sizeof(slot07->val);
+  // ranges
+  serialize_uint32_t(*data + offset, htonl(slot07->ranges_cnt));
+  offset += sizeof(slot07->ranges_cnt);
+  for (uint32_t i = 0; i < slot07->ranges_cnt; i++) {
+    serialize_uint64_t(*data + offset, htonll(slot07->ranges[i].offset));
+    offset += sizeof(slot07->ranges[i].offset);
+    serialize_uint64_t(*data + offset, htonll(slot07->ranges[i].len));
+    offset += sizeof(slot07->ranges[i].len);
+  }
+  // Set size
+  *data_sz = offset;
+
+  return 0;
+}
+ssize_t deserialize_slot07_t(uint8_t* data, size_t data_sz, slot07_t* slot07) {
+  if (!slot07 || !data) {
+    log_msg(ERRN, 14);
+    return -1;
+  }
+  size_t hdr_sz = sizeof(slot07->stream_id) + sizeof(slot07->val) + sizeof(slot07->ranges_cnt);
+  size_t range_sz = sizeof(slot07->ranges->offset) + sizeof(slot07->ranges->len);
+  if (data_sz < hdr_sz) return -1;
+  size_t offset = 0;
+  // stream_id
+  deserialize_uint32_t(data + offset, &slot07->stream_id);
+  offset += sizeof(slot07->stream_id);
+  slot07->stream_id = ntohl(slot07->stream_id);
+  // value
+  deserialize_uint32_t(data + offset, &slot07->val);
+  offset += sizeof(slot07->val);
+  slot07->val = ntohl(slot07->val);
+  // ranges
+  uint32_t ranges_cnt = 0;
+  deserialize_uint32_t(data + offset, &ranges_cnt);
+  offset += sizeof(ranges_cnt);
+  ranges_cnt = ntohl(ranges_cnt);
+  if ((ranges_cnt > RXS_PREADV_RANGES_MAX) || ((data_sz - hdr_sz) < ranges_cnt * range_sz)) return -1;
+  if (ranges_cnt) {
+    slot07->ranges = (rxs_range_t*)calloc(ranges_cnt, sizeof(rxs_range_t));
+    if (!slot07->ranges) {
+      log_msg(ERRN, 6, "calloc", strerror(errno));
+      return -1;
+    }
+  }
+  slot07->ranges_cnt = ranges_cnt;
+  for (uint32_t i = 0; i < ranges_cnt; i++) {
+    deserialize_uint64_t(data + offset, &slot07->ranges[i].offset);
+    offset += sizeof(slot07->ranges[i].offset);
+    slot07->ranges[i].offset = ntohll(slot07->ranges[i].offset);
+    deserialize_uint64_t(data + offset, &slot07->ranges[i].len);
+    offset += sizeof(slot07->ranges[i].len);
+    slot07->ranges[i].len = ntohll(slot07->ranges[i].len);
+  }
+
+  return 0;
+}
 ssize_t serialize_crypt_data_t(void* crypt_data_x, uint8_t** data) {
   if (!crypt_data_x || !data) {
     log_msg(ERRN, 14);
@@ -1187,6 +1430,31 @@ ssize_t compose_slot05_t(uint32_t stream, uint16_t port, slot05_t* slot05) {
   slot05->port = htons(port);
   return 0;
 }
+// Compose data slot
+ssize_t compose_slot06_t(uint32_t stream, uint64_t offset, uint32_t data_sz, slot06_t* slot06) {
+  if (!slot06) return -1;
+  slot06->stream_id = stream;
+  slot06->offset = offset;
+  slot06->data_sz = data_sz;
+  return 0;
+}
+ssize_t compose_slot07_t(uint32_t stream, uint32_t val, const rxs_range_t* ranges, uint32_t ranges_cnt,
+                         slot07_t* slot07) {
+  if (!slot07 || (ranges_cnt && !ranges) || (ranges_cnt > RXS_PREADV_RANGES_MAX)) return -1;
+
+  slot07->stream_id = stream;
+  slot07->val = val;
+  slot07->ranges_cnt = ranges_cnt;
+  if (!ranges_cnt) return 0;
+  slot07->ranges = (rxs_range_t*)calloc(ranges_cnt, sizeof(rxs_range_t));
+  if (!slot07->ranges) {
+    log_msg(ERRN, 6, "calloc", strerror(errno));
+    return -1;
+  }
+  memcpy(slot07->ranges, ranges, ranges_cnt * sizeof(rxs_range_t));
+
+  return 0;
+}
 
 // Compose crypt data slot
 ssize_t compose_crypt_data_t(const uint8_t* key_info, uint16_t len, const uint8_t* data, const uint8_t* imit,
@@ -1407,6 +1675,46 @@ ssize_t compose_packet_rxs_x05(rxs_type_t type, rxs_operation_t operation, uint3
   dinit_slot05_t(&slot05);
   return 0;
 }
+ssize_t compose_packet_rxs_x06(rxs_type_t type, rxs_operation_t operation, uint32_t stream, uint64_t offset,
+                               uint32_t data_sz, packet_rxs_t* packet_rxs) {
+  if (!packet_rxs) return -1;
+
+  slot06_t slot06;
+  init_slot06_t(&slot06);
+  if (compose_slot06_t(stream, offset, data_sz, &slot06) < 0) {
+    // Free memory
+    dinit_slot06_t(&slot06);
+    return -1;
+  }
+  if (compose_packet_rxs_0x(type, operation, serialize_slot06_t, &slot06, packet_rxs) < 0) {
+    // Free memory
+    dinit_slot06_t(&slot06);
+    return -1;
+  }
+  // Free memory
+  dinit_slot06_t(&slot06);
+  return 0;
+}
+ssize_t compose_packet_rxs_x07(rxs_type_t type, rxs_operation_t operation, uint32_t stream, uint32_t val,
+                               const rxs_range_t* ranges, uint32_t ranges_cnt, packet_rxs_t* packet_rxs) {
+  if (!packet_rxs) return -1;
+
+  slot07_t slot07;
+  init_slot07_t(&slot07);
+  if (compose_slot07_t(stream, val, ranges, ranges_cnt, &slot07) < 0) {
+    // Free memory
+    dinit_slot07_t(&slot07);
+    return -1;
+  }
+  if (compose_packet_rxs_0x(type, operation, serialize_slot07_t, &slot07, packet_rxs) < 0) {
+    // Free memory
+    dinit_slot07_t(&slot07);
+    return -1;
+  }
+  // Free memory
+  dinit_slot07_t(&slot07);
+  return 0;
+}
 
 //////////////////////////////////////////////////////////////////////////////////
 // Functions for send and receive data slot
@@ -20,6 +20,7 @@
 ** SOFTWARE.
 *******************************************************************************/
 #include <arpa/inet.h>
+#include <dirent.h>  // for 'opendir()'
 #include <errno.h>
 #include <fcntl.h>
 #include <limits.h>
@@ -30,7 +31,9 @@
 #include <sys/ioctl.h>
 #include <sys/poll.h>
 #include <sys/socket.h>
+#include <sys/stat.h>  // for 'fstat()'
 #include <sys/types.h>
+#include <time.h>  // for 'clock_gettime()'
 #ifndef __QNXNTO__
 #include <linux/limits.h>  // for 'PATH_MAX'
 #else
@@ -41,67 +44,924 @@
 #include <pthread.h>   // for 'pthread'
 
 #include "logger/logger.h"
+#include "protocol/durability.h"
 #include "protocol/generic.h"  // for 'write_file()'
 #include "protocol/protocol_rxs_client.h"
+#include "protocol/rate_limit.h"
 #include "protocol/rxs_errno.h"
 
-int sockfd_conn = -1;
-int sockfd_data = -1;
-int sockfd_data_client = -1;
-uint8_t have_encoder = 0;
-// struct sockaddr_storage hisctladdr;
-int errno_both_sides = 0;
-
-static int set_socket_connected(int sockfd) { return (sockfd_conn = sockfd); }
-static int get_socket_connected() { return sockfd_conn; }
-static int set_socket_data(int sockfd) { return (sockfd_data = sockfd); }
-static int get_socket_data() { return sockfd_data; }
-static int set_socket_data_client(int sockfd) { return (sockfd_data_client = sockfd); }
-static int get_socket_data_client() { return sockfd_data_client; }
 //////////////////////////////////////////////////////////////////////////////////////////////////
-// Data receiver
+// Types of the session
 //////////////////////////////////////////////////////////////////////////////////////////////////
 typedef struct data_exchange_t {
   int sockfd;
   RXS_HANDLE stream;
   void* buf;
   size_t buf_sz;
+  size_t channel_sz;  // Expected size of data on the channel, it is corrected by the answer of other side
   size_t total_impl_channel_sz;
   size_t total_impl_sz;
   int complete;
 } data_exchange_t;
 
-pthread_t data_receiver_thr;
-void* data_receiver(void* arg) {
-  if (!arg) pthread_exit(NULL);
+//////////////////////////////////////////////////////////////////////////////////
+// One receiver thread serves all reads of the data channel: 'rxs_fread()' posts the job and waits for the completion
+// on the condition variable. The pipe wakes the receiver which waits for data of the channel.
+//////////////////////////////////////////////////////////////////////////////////
+typedef struct data_receiver_t {
+  pthread_t thr;
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  data_exchange_t* job;  // Current job (NULL - receiver is idle)
+  int wake_fd[2];
+  rxs_session_t* session;  // Received data are shaped by the rate limits of the session
+  uint8_t have_encoder;
+  uint8_t started;
+  uint8_t stop;
+} data_receiver_t;
 
-  data_exchange_t* val = (data_exchange_t*)arg;
+// Every open stream has own data channel and own receiver, so the streams can be used at the same time
+#define DATA_CHANNELS_MAX 32
+#define RXS_OFFSET_CURRENT (-1)  // Data are read/written from the current position of the stream
 
-  size_t block_sz = ((have_encoder > 0) ? (crypt_packet_sz()) : (0));
-  size_t buf_recv_sz = ((have_encoder > 0) ? (crypt_packet_sz()) : (crypt_data_sz()));
-  uint8_t* buf_recv = calloc(buf_recv_sz, sizeof(uint8_t));
-  if (!buf_recv) {
-    log_msg(ERRN, 6, "calloc", strerror(errno));
-    pthread_exit(NULL);
-  }
-  while (val->total_impl_channel_sz < val->buf_sz) {
-    if ((val->buf_sz - val->total_impl_channel_sz) < buf_recv_sz) break;
+typedef struct data_channel_t {
+  RXS_HANDLE stream;  // Owner of the channel (0 - the slot is free)
+  int sockfd;         // Listening socket
+  int sockfd_client;  // Connection of other side
+  data_receiver_t receiver;
+} data_channel_t;
+
+// Sequential reads of a stream are served from memory: the reader thread fetches next portions of the stream while the
+// application processes the current one. The size of portion is the size of sequential requests of the application.
+// The depth of readahead grows on misses up to the memory cap.
+#define READAHEAD_SEQ_THRESHOLD 2
+#define READAHEAD_DEPTH_MAX 8
+#define READAHEAD_MEM_MAX (32 * 1024 * 1024)
+
+typedef struct readahead_blk_t {
+  uint8_t* data;
+  size_t sz;   // Size of received data
+  size_t pos;  // Size of consumed data
+  int err_no;  // Status of the portion (RXS_EOF - the last portion of the stream)
+} readahead_blk_t;
+
+typedef struct readahead_t {
+  pthread_t thr;
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  RXS_HANDLE stream;  // Owner of the cache
+  size_t rqst_sz;     // Size of sequential requests
+  uint32_t seq_cnt;   // Count of sequential requests
+  readahead_blk_t blks[READAHEAD_DEPTH_MAX];
+  uint32_t head;       // The first filled portion
+  uint32_t cnt;        // Count of filled portions
+  uint32_t depth;      // Portions are kept in flight
+  uint32_t depth_max;  // Portions are allowed by the memory cap (0 - readahead is inactive)
+  size_t mem_max;
+  int err_no;  // Status of the last portion
+  uint64_t hits;
+  uint64_t misses;
+  uint8_t done;  // The last portion is fetched (EOF or error)
+  uint8_t started;
+  uint8_t stop;
+} readahead_t;
+
+// Small writes of a stream are coalesced in the buffer and sent by one request. The buffer is sent when it is full,
+// when the oldest data are kept longer than the flush interval (it is checked by writes of the stream), by
+// 'rxs_fflush()', 'rxs_fclose()' and before reads of the stream. Error of the sending is reported by that call.
+#define WRITE_BACK_STREAMS_MAX 8
+#define WRITE_BACK_FLUSH_MSEC 1000
+
+typedef struct write_back_t {
+  RXS_HANDLE stream;  // Owner of the buffer (0 - the slot is free)
+  uint8_t* buf;
+  size_t buf_sz;
+  size_t len;
+  uint32_t flush_msec;
+  struct timespec since;  // Time of the oldest buffered data
+} write_back_t;
+
+// Requests are queued and performed in order by the event loop thread which owns the connection while the queue is not
+// empty. Completion is reported by the callback (it is called by the event loop thread) or is put to the completion
+// queue, then the completion pipe becomes readable.
+typedef struct async_rqst_t {
+  rxs_completion_t completion;
+  rxs_callback_t cb;
+  RXS_HANDLE stream;
+  void* buf;
+  size_t buf_sz;
+  char* path;
+  char* mode;
+  struct async_rqst_t* next;
+} async_rqst_t;
+
+typedef struct async_loop_t {
+  pthread_t thr;
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  async_rqst_t* rqst_head;  // Pending requests
+  async_rqst_t* rqst_tail;
+  async_rqst_t* cmpl_head;  // Completions without callback
+  async_rqst_t* cmpl_tail;
+  RXS_TOKEN token_last;
+  int cmpl_fd[2];
+  uint8_t busy;  // The request is performed
+  uint8_t started;
+  uint8_t stop;
+} async_loop_t;
+
+// Results of metadata requests ('rxs_file_exist()', 'rxs_dir_exist()', 'rxs_filesize()' and 'rxs_getcwd()') are kept
+// for the TTL, negative results too. Own mutating calls of the session clear the cache, changes made by other clients
+// are seen after the TTL. The table has fixed size, the entry is found by hash of the path and a collision replaces it.
+#define META_CACHE_ENTRIES 1024
+#define META_CACHE_PATH_MAX 256  // Longer paths are not cached
+
+typedef enum { meta_file_exist = 1, meta_dir_exist, meta_filesize } meta_kind_t;
+
+typedef struct meta_entry_t {
+  uint8_t kind;  // 0 - the slot is free
+  uint32_t gen;  // Generation of the cache the entry belongs to
+  uint64_t expire_msec;
+  long val;    // Return value of the request
+  int err_no;  // Status of the request
+  char path[META_CACHE_PATH_MAX];
+} meta_entry_t;
+
+typedef struct meta_cache_t {
+  meta_entry_t* entries;  // NULL - the cache is off
+  uint32_t ttl_msec;
+  uint32_t gen;  // Increment drops all entries
+  char cwd[META_CACHE_PATH_MAX];
+  uint32_t cwd_gen;
+  uint64_t cwd_expire_msec;
+  uint64_t hits;
+  uint64_t misses;
+} meta_cache_t;
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// Session: connection to remote side and its streams. Sessions are independent, so they can be used by several
+// threads at the same time. Functions of the library without 'rxs_session_' prefix use the default session.
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// TCP keepalive of the control connection
+#define KEEPALIVE_IDLE_SEC 30
+#define KEEPALIVE_INTVL_SEC 10
+#define KEEPALIVE_CNT 3
+
+struct rxs_session_t {
+  int sockfd_conn;
+  uint8_t have_encoder;
+  // struct sockaddr_storage hisctladdr;
+  int errno_both_sides;
+  uint32_t ping_seq;
+  data_channel_t data_channel_tbl[DATA_CHANNELS_MAX];
+  readahead_t readahead;
+  write_back_t write_back_tbl[WRITE_BACK_STREAMS_MAX];
+  async_loop_t async_loop;
+  meta_cache_t meta_cache;
+  // Data channels are shaped by own bucket of the session and by the bucket shared by sessions of the pool
+  rate_limit_t rate_limit;
+  rate_limit_t* rate_limit_pool;
+};
 
-    ssize_t impl_channel_sz = rxs_recv_block_x(val->sockfd, buf_recv, buf_recv_sz, block_sz);
-    if (impl_channel_sz < 0) break;
-    // printf("THR DATA BUF:%d ch:%d rl:%d impl:%d sz:%d df:%d\n", val->buf_sz, val->total_impl_channel_sz,
-    // val->total_impl_sz, impl_channel_sz, buf_recv_sz, ( val->buf_sz - val->total_impl_sz) );
+static rxs_session_t session_default = {
+    .sockfd_conn = -1,
+    .have_encoder = 0,
+    .errno_both_sides = 0,
+    .readahead = {.mutex = PTHREAD_MUTEX_INITIALIZER, .cond = PTHREAD_COND_INITIALIZER, .mem_max = READAHEAD_MEM_MAX},
+    .async_loop = {.mutex = PTHREAD_MUTEX_INITIALIZER, .cond = PTHREAD_COND_INITIALIZER, .cmpl_fd = {-1, -1}},
+    .rate_limit = {.mutex = PTHREAD_MUTEX_INITIALIZER}};
+
+static void init_rxs_session_t(rxs_session_t* s) {
+  memset(s, 0, sizeof(rxs_session_t));
+  s->sockfd_conn = -1;
+  pthread_mutex_init(&s->readahead.mutex, NULL);
+  pthread_cond_init(&s->readahead.cond, NULL);
+  s->readahead.mem_max = READAHEAD_MEM_MAX;
+  pthread_mutex_init(&s->async_loop.mutex, NULL);
+  pthread_cond_init(&s->async_loop.cond, NULL);
+  s->async_loop.cmpl_fd[0] = s->async_loop.cmpl_fd[1] = -1;
+  init_rate_limit_t(&s->rate_limit, 0, 0, 0);
+}
+static void dinit_rxs_session_t(rxs_session_t* s) {
+  free(s->meta_cache.entries);
+  s->meta_cache.entries = NULL;
+  if (s->async_loop.cmpl_fd[0] >= 0) close(s->async_loop.cmpl_fd[0]);
+  if (s->async_loop.cmpl_fd[1] >= 0) close(s->async_loop.cmpl_fd[1]);
+  pthread_mutex_destroy(&s->readahead.mutex);
+  pthread_cond_destroy(&s->readahead.cond);
+  pthread_mutex_destroy(&s->async_loop.mutex);
+  pthread_cond_destroy(&s->async_loop.cond);
+  dinit_rate_limit_t(&s->rate_limit);
+}
+static int set_socket_connected(rxs_session_t* s, int sockfd) { return (s->sockfd_conn = sockfd); }
+static int get_socket_connected(rxs_session_t* s) { return s->sockfd_conn; }
+// Take tokens of data moved by the data channel (the caller sleeps while a bucket is in debt)
+static void take_rate_limit(rxs_session_t* s, size_t bytes) {
+  rate_limit_take(&s->rate_limit, bytes);
+  rate_limit_take(s->rate_limit_pool, bytes);
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// Data receiver
+//////////////////////////////////////////////////////////////////////////////////////////////////
+static void wake_data_receiver(data_receiver_t* rcv) {
+  uint8_t val = 1;
+  if (write(rcv->wake_fd[1], &val, sizeof(val)) < 0) {
+    // Pipe is full: the receiver is already woken
+  }
+}
+// Receive the job. Return value: 0 - the job is done, 1 - expected size is changed (see 'channel_sz'), -1 - error
+static int data_receiver_job(data_receiver_t* rcv, data_exchange_t* val, uint8_t* buf_recv, size_t buf_recv_sz,
+                             size_t block_sz) {
+  for (;;) {
+    pthread_mutex_lock(&rcv->mutex);
+    size_t channel_sz = val->channel_sz;
+    uint8_t stop = rcv->stop;
+    pthread_mutex_unlock(&rcv->mutex);
+    if (stop) return -1;
+    if (val->total_impl_channel_sz >= channel_sz) return 0;
+    //////////////////////////////////////////////////////////////////////////////////
+    // Wait data of the channel or change of the job
+    //////////////////////////////////////////////////////////////////////////////////
+    struct pollfd fds[2] = {{val->sockfd, POLLIN, 0}, {rcv->wake_fd[0], POLLIN, 0}};
+    int ret_code = poll(fds, 2, POLL_TIMEOUT_DATA_MSEC);
+    if (ret_code < 0) {
+      if (EINTR == errno) continue;
+      return -1;
+    }
+    if (0 == ret_code) return -1;
+    if (fds[1].revents & POLLIN) {
+      uint8_t wake_buf[64];
+      while (read(rcv->wake_fd[0], wake_buf, sizeof(wake_buf)) > 0) {
+      }
+      continue;
+    }
+    size_t chunk_sz = ((channel_sz - val->total_impl_channel_sz) > buf_recv_sz)
+                          ? (buf_recv_sz)
+                          : (channel_sz - val->total_impl_channel_sz);
+    ssize_t impl_channel_sz = rxs_recv_block_x(val->sockfd, buf_recv, chunk_sz, block_sz);
+    if (impl_channel_sz <= 0) return -1;
+    if (rcv->session) take_rate_limit(rcv->session, (size_t)impl_channel_sz);
     size_t dec_bytes =
-        decompose_data(have_encoder, val->buf, buf_recv, buf_recv_sz, val->total_impl_sz, (size_t)impl_channel_sz);
+        decompose_data(rcv->have_encoder, val->buf, buf_recv, buf_recv_sz, val->total_impl_sz, (size_t)impl_channel_sz);
     val->total_impl_sz += dec_bytes;
     val->total_impl_channel_sz += (size_t)impl_channel_sz;
   }
-  val->complete = 1;
+}
+void* data_receiver(void* arg) {
+  data_receiver_t* rcv = (data_receiver_t*)arg;
+
+  size_t block_sz = ((rcv->have_encoder > 0) ? (crypt_packet_sz()) : (0));
+  size_t buf_recv_sz = ((rcv->have_encoder > 0) ? (crypt_packet_sz()) : (crypt_data_sz()));
+  uint8_t* buf_recv = calloc(buf_recv_sz, sizeof(uint8_t));
+  if (!buf_recv) log_msg(ERRN, 6, "calloc", strerror(errno));
+
+  for (;;) {
+    pthread_mutex_lock(&rcv->mutex);
+    while (!rcv->stop && !rcv->job)
+      pthread_cond_wait(&rcv->cond, &rcv->mutex);
+    data_exchange_t* val = rcv->job;
+    uint8_t stop = rcv->stop;
+    pthread_mutex_unlock(&rcv->mutex);
+    if (stop) break;
 
+    if (buf_recv) data_receiver_job(rcv, val, buf_recv, buf_recv_sz, block_sz);
+    //////////////////////////////////////////////////////////////////////////////////
+    // Signal completion
+    //////////////////////////////////////////////////////////////////////////////////
+    pthread_mutex_lock(&rcv->mutex);
+    val->complete = 1;
+    rcv->job = NULL;
+    pthread_cond_broadcast(&rcv->cond);
+    pthread_mutex_unlock(&rcv->mutex);
+  }
+  // Free memory
   free(buf_recv);
   buf_recv = NULL;
+  return NULL;
+}
+static int start_data_receiver(data_receiver_t* rcv) {
+  if (rcv->started) return 0;
+
+  if (pipe(rcv->wake_fd) != 0) return -1;
+  fcntl(rcv->wake_fd[0], F_SETFL, O_NONBLOCK);
+  fcntl(rcv->wake_fd[1], F_SETFL, O_NONBLOCK);
+  rcv->stop = 0;
+  rcv->job = NULL;
+  int err_no = pthread_create(&rcv->thr, NULL, data_receiver, rcv);
+  if (err_no != 0) {
+    close(rcv->wake_fd[0]);
+    close(rcv->wake_fd[1]);
+    rcv->wake_fd[0] = rcv->wake_fd[1] = -1;
+    errno = err_no;
+    return -1;
+  }
+  rcv->started = 1;
+  return 0;
+}
+static void stop_data_receiver(data_receiver_t* rcv) {
+  if (!rcv->started) return;
+
+  pthread_mutex_lock(&rcv->mutex);
+  rcv->stop = 1;
+  pthread_cond_broadcast(&rcv->cond);
+  pthread_mutex_unlock(&rcv->mutex);
+  wake_data_receiver(rcv);
+
+  int err_no = pthread_join(rcv->thr, NULL);
+  if (err_no != 0) log_msg(ERRN, 6, "pthread_join", strerror(err_no));
+  close(rcv->wake_fd[0]);
+  close(rcv->wake_fd[1]);
+  rcv->wake_fd[0] = rcv->wake_fd[1] = -1;
+  rcv->started = 0;
+}
+// Set expected size of the job and wait the completion
+static void wait_data_receiver(data_receiver_t* rcv, data_exchange_t* val, size_t channel_sz) {
+  pthread_mutex_lock(&rcv->mutex);
+  if (channel_sz < val->channel_sz) val->channel_sz = channel_sz;
+  pthread_mutex_unlock(&rcv->mutex);
+  wake_data_receiver(rcv);
+
+  pthread_mutex_lock(&rcv->mutex);
+  while (!val->complete) pthread_cond_wait(&rcv->cond, &rcv->mutex);
+  pthread_mutex_unlock(&rcv->mutex);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// Data channels
+//////////////////////////////////////////////////////////////////////////////////////////////////
+static data_channel_t* find_data_channel(rxs_session_t* s, RXS_HANDLE stream) {
+  if (!stream) return NULL;
+  for (uint32_t i = 0; i < DATA_CHANNELS_MAX; i++) {
+    if (s->data_channel_tbl[i].stream == stream) return &s->data_channel_tbl[i];
+  }
+  return NULL;
+}
+static data_channel_t* new_data_channel(rxs_session_t* s, RXS_HANDLE stream) {
+  for (uint32_t i = 0; i < DATA_CHANNELS_MAX; i++) {
+    data_channel_t* channel = &s->data_channel_tbl[i];
+    if (channel->stream) continue;
+
+    memset(channel, 0, sizeof(data_channel_t));
+    channel->stream = stream;
+    channel->receiver.session = s;
+    channel->sockfd = -1;
+    channel->sockfd_client = -1;
+    pthread_mutex_init(&channel->receiver.mutex, NULL);
+    pthread_cond_init(&channel->receiver.cond, NULL);
+    channel->receiver.wake_fd[0] = channel->receiver.wake_fd[1] = -1;
+    return channel;
+  }
+  return NULL;
+}
+static void free_data_channel(data_channel_t* channel) {
+  stop_data_receiver(&channel->receiver);
+  if (channel->sockfd != -1) close(channel->sockfd);
+  if (channel->sockfd_client != -1) close(channel->sockfd_client);
+  pthread_mutex_destroy(&channel->receiver.mutex);
+  pthread_cond_destroy(&channel->receiver.cond);
+  memset(channel, 0, sizeof(data_channel_t));
+}
+static int get_socket_data_client(rxs_session_t* s, RXS_HANDLE stream) {
+  data_channel_t* channel = find_data_channel(s, stream);
+  return (channel) ? (channel->sockfd_client) : (-1);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// Readahead cache
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// Read from 'offset' of the stream, or from the current position if it is RXS_OFFSET_CURRENT
+static size_t fread_remote(rxs_session_t* s, void* buf, size_t buf_sz, RXS_HANDLE stream, int64_t offset,
+                           int* err_no);
+
+void* readahead_reader(void* arg) {
+  rxs_session_t* s = (rxs_session_t*)arg;
+
+  pthread_mutex_lock(&s->readahead.mutex);
+  for (;;) {
+    while (!s->readahead.stop && (s->readahead.done || (s->readahead.cnt >= s->readahead.depth)))
+      pthread_cond_wait(&s->readahead.cond, &s->readahead.mutex);
+    if (s->readahead.stop) break;
+    // The slot is not visible to the application until it is filled
+    readahead_blk_t* blk = &s->readahead.blks[(s->readahead.head + s->readahead.cnt) % s->readahead.depth_max];
+    pthread_mutex_unlock(&s->readahead.mutex);
+
+    int err_no = 0;
+    size_t sz = 0;
+    if (!blk->data) blk->data = malloc(s->readahead.rqst_sz);
+    if (!blk->data) {
+      log_msg(ERRN, 44, s->readahead.rqst_sz);
+      err_no = ENOMEM;
+    } else {
+      sz = fread_remote(s, blk->data, s->readahead.rqst_sz, s->readahead.stream, RXS_OFFSET_CURRENT, &err_no);
+      // Portion without data and status is unexpected
+      if (!sz && !err_no) err_no = EIO;
+    }
+
+    pthread_mutex_lock(&s->readahead.mutex);
+    blk->sz = sz;
+    blk->pos = 0;
+    blk->err_no = err_no;
+    s->readahead.cnt++;
+    if (err_no) s->readahead.done = 1;
+    pthread_cond_broadcast(&s->readahead.cond);
+  }
+  pthread_mutex_unlock(&s->readahead.mutex);
+  return NULL;
+}
+// Return value: 0 on success, -1 if the reader can not be started
+static int readahead_resume(rxs_session_t* s) {
+  if (s->readahead.started || s->readahead.done) return 0;
+
+  s->readahead.stop = 0;
+  int err_no = pthread_create(&s->readahead.thr, NULL, readahead_reader, s);
+  if (err_no != 0) {
+    log_msg(ERRN, 6, "pthread_create", strerror(err_no));
+    return -1;
+  }
+  s->readahead.started = 1;
+  return 0;
+}
+// Stop the reader after the current portion, the cache is kept. CAUTION: it must be called before any other use of the
+// connection, the reader and the application share it
+static void readahead_pause(rxs_session_t* s) {
+  if (!s->readahead.started) return;
+
+  pthread_mutex_lock(&s->readahead.mutex);
+  s->readahead.stop = 1;
+  pthread_cond_broadcast(&s->readahead.cond);
+  pthread_mutex_unlock(&s->readahead.mutex);
+
+  int err_no = pthread_join(s->readahead.thr, NULL);
+  if (err_no != 0) log_msg(ERRN, 6, "pthread_join", strerror(err_no));
+  s->readahead.started = 0;
+  s->readahead.stop = 0;
+}
+// Stop the reader and free the cache
+static void readahead_drop(rxs_session_t* s) {
+  readahead_pause(s);
+
+  for (uint32_t i = 0; i < READAHEAD_DEPTH_MAX; i++) {
+    free(s->readahead.blks[i].data);
+    memset(&s->readahead.blks[i], 0, sizeof(s->readahead.blks[i]));
+  }
+  s->readahead.stream = 0;
+  s->readahead.rqst_sz = 0;
+  s->readahead.seq_cnt = 0;
+  s->readahead.head = 0;
+  s->readahead.cnt = 0;
+  s->readahead.depth = 0;
+  s->readahead.depth_max = 0;
+  s->readahead.err_no = 0;
+  s->readahead.done = 0;
+}
+// Size of cached data are not consumed by the owner. The reader must be paused
+static uint64_t readahead_cached(rxs_session_t* s) {
+  uint64_t cached_sz = 0;
+  for (uint32_t i = 0; i < s->readahead.cnt; i++) {
+    readahead_blk_t* blk = &s->readahead.blks[(s->readahead.head + i) % s->readahead.depth_max];
+    cached_sz += blk->sz - blk->pos;
+  }
+  return cached_sz;
+}
+// Serve a read of the owner from the cache. The application waits if the cache is empty.
+// Return value: size of data is copied to the buffer, the status is set to 's->errno_both_sides'
+static size_t readahead_read(rxs_session_t* s, void* buf, size_t buf_sz) {
+  pthread_mutex_lock(&s->readahead.mutex);
+  if (s->readahead.cnt) {
+    s->readahead.hits++;
+  } else {
+    s->readahead.misses++;
+    // The reader is behind the application: keep more portions in flight
+    if (s->readahead.depth < s->readahead.depth_max) s->readahead.depth++;
+    pthread_cond_broadcast(&s->readahead.cond);
+  }
+  if ((readahead_resume(s) != 0) && !s->readahead.cnt) {
+    // The reader can not be started: readahead is off for the stream, the cache is empty
+    RXS_HANDLE stream = s->readahead.stream;
+    pthread_mutex_unlock(&s->readahead.mutex);
+    readahead_drop(s);
+    return fread_remote(s, buf, buf_sz, stream, RXS_OFFSET_CURRENT, &s->errno_both_sides);
+  }
+  while (!s->readahead.cnt && !s->readahead.done && s->readahead.started)
+    pthread_cond_wait(&s->readahead.cond, &s->readahead.mutex);
+
+  size_t total_sz = 0;
+  while ((total_sz < buf_sz) && s->readahead.cnt) {
+    readahead_blk_t* blk = &s->readahead.blks[s->readahead.head];
+    size_t sz = ((blk->sz - blk->pos) > (buf_sz - total_sz)) ? (buf_sz - total_sz) : (blk->sz - blk->pos);
+    memcpy((uint8_t*)buf + total_sz, blk->data + blk->pos, sz);
+    blk->pos += sz;
+    total_sz += sz;
+    if (blk->pos < blk->sz) break;
+    // The portion is consumed
+    s->readahead.head = (s->readahead.head + 1) % s->readahead.depth_max;
+    s->readahead.cnt--;
+    pthread_cond_broadcast(&s->readahead.cond);
+    if (blk->err_no) {
+      s->readahead.err_no = blk->err_no;
+      break;
+    }
+  }
+  // Status is reported with the last data of the stream and by all reads after it
+  s->errno_both_sides = ((s->readahead.done && !s->readahead.cnt) || !total_sz) ? (s->readahead.err_no) : (0);
+  if (!total_sz && !s->errno_both_sides) s->errno_both_sides = EIO;
+  pthread_mutex_unlock(&s->readahead.mutex);
+  return total_sz;
+}
+void rxs_session_set_readahead(rxs_session_t* s, size_t mem_max) {
+  readahead_drop(s);
+  s->readahead.mem_max = mem_max;
+}
+void rxs_session_readahead_stat(rxs_session_t* s, uint64_t* hits, uint64_t* misses) {
+  pthread_mutex_lock(&s->readahead.mutex);
+  if (hits) *hits = s->readahead.hits;
+  if (misses) *misses = s->readahead.misses;
+  pthread_mutex_unlock(&s->readahead.mutex);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// Write-back buffers
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// Write to 'offset' of the stream, or to the current position if it is RXS_OFFSET_CURRENT
+static size_t fwrite_remote(rxs_session_t* s, const void* buf, size_t buf_sz, RXS_HANDLE stream, int64_t offset,
+                            int* err_no);
+
+static write_back_t* find_write_back(rxs_session_t* s, RXS_HANDLE stream) {
+  if (!stream) return NULL;
+  for (uint32_t i = 0; i < WRITE_BACK_STREAMS_MAX; i++) {
+    if (s->write_back_tbl[i].stream == stream) return &s->write_back_tbl[i];
+  }
+  return NULL;
+}
+static int write_back_expired(write_back_t* wb) {
+  if (!wb->len) return 0;
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  int64_t elapsed_msec =
+      (int64_t)(now.tv_sec - wb->since.tv_sec) * 1000 + (int64_t)(now.tv_nsec - wb->since.tv_nsec) / 1000000;
+  return (elapsed_msec >= wb->flush_msec) ? (1) : (0);
+}
+// Return value: on success returns 0, otherwise -1 and 's->errno_both_sides' is set. Buffered data are dropped anyway
+static int flush_write_back(rxs_session_t* s, write_back_t* wb) {
+  if (!wb || !wb->len) return 0;
+
+  readahead_pause(s);
+  size_t len = wb->len;
+  wb->len = 0;
+  int err_no = 0;
+  if (fwrite_remote(s, wb->buf, len, wb->stream, RXS_OFFSET_CURRENT, &err_no) != len) {
+    s->errno_both_sides = (err_no) ? (err_no) : (EIO);
+    return -1;
+  }
+  return 0;
+}
+static void free_write_back(write_back_t* wb) {
+  free(wb->buf);
+  memset(wb, 0, sizeof(write_back_t));
+}
+// Buffered data of all streams are sent before the connection is closed
+static int flush_write_back_all(rxs_session_t* s) {
+  int res = 0;
+  for (uint32_t i = 0; i < WRITE_BACK_STREAMS_MAX; i++) {
+    if (flush_write_back(s, &s->write_back_tbl[i]) != 0) res = -1;
+  }
+  return res;
+}
+int rxs_session_set_write_back(rxs_session_t* s, RXS_HANDLE stream, size_t buf_sz, uint32_t flush_msec) {
+  // Set errno
+  s->errno_both_sides = 0;
+  if (!stream) {
+    s->errno_both_sides = EINVAL;
+    return -1;
+  }
+  write_back_t* wb = find_write_back(s, stream);
+  if (flush_write_back(s, wb) != 0) return -1;
+  if (!buf_sz) {
+    if (wb) free_write_back(wb);
+    return 0;
+  }
+  for (uint32_t i = 0; (i < WRITE_BACK_STREAMS_MAX) && !wb; i++) {
+    if (!s->write_back_tbl[i].stream) wb = &s->write_back_tbl[i];
+  }
+  if (!wb) {
+    s->errno_both_sides = EMFILE;
+    return -1;
+  }
+  // Buffer is sent by whole blocks of the data channel
+  size_t block_sz = crypt_data_sz();
+  buf_sz = ((buf_sz + block_sz - 1) / block_sz) * block_sz;
+  uint8_t* buf = realloc(wb->buf, buf_sz);
+  if (!buf) {
+    s->errno_both_sides = ENOMEM;
+    log_msg(ERRN, 44, buf_sz);
+    return -1;
+  }
+  wb->stream = stream;
+  wb->buf = buf;
+  wb->buf_sz = buf_sz;
+  wb->len = 0;
+  wb->flush_msec = (flush_msec) ? (flush_msec) : (WRITE_BACK_FLUSH_MSEC);
+  return 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// Asynchronous requests
+//////////////////////////////////////////////////////////////////////////////////////////////////
+static void free_async_rqst(async_rqst_t* rqst) {
+  free(rqst->path);
+  free(rqst->mode);
+  free(rqst);
+}
+static void async_perform(rxs_session_t* s, async_rqst_t* rqst) {
+  rxs_completion_t* cmpl = &rqst->completion;
+  switch (cmpl->op) {
+    case async_op_fopen:
+      cmpl->res = rxs_session_fopen(s, rqst->path, rqst->mode);
+      break;
+    case async_op_fread:
+      cmpl->res = rxs_session_fread(s, rqst->buf, rqst->buf_sz, 1, rqst->stream);
+      break;
+    case async_op_fwrite:
+      cmpl->res = rxs_session_fwrite(s, rqst->buf, rqst->buf_sz, 1, rqst->stream);
+      break;
+    case async_op_fflush:
+      cmpl->res = rxs_session_fflush(s, rqst->stream);
+      break;
+    case async_op_fclose:
+      cmpl->res = rxs_session_fclose(s, rqst->stream);
+      break;
+    case async_op_filesize:
+      cmpl->res = rxs_session_filesize(s, rqst->path);
+      break;
+    case async_op_unlink:
+      cmpl->res = rxs_session_unlink(s, rqst->path);
+      break;
+    default:
+      cmpl->res = -1;
+      s->errno_both_sides = EINVAL;
+      break;
+  }
+  cmpl->err_no = rxs_session_errno(s);
+}
+void* async_loop_thr(void* arg) {
+  rxs_session_t* s = (rxs_session_t*)arg;
+
+  pthread_mutex_lock(&s->async_loop.mutex);
+  for (;;) {
+    while (!s->async_loop.stop && !s->async_loop.rqst_head)
+      pthread_cond_wait(&s->async_loop.cond, &s->async_loop.mutex);
+    if (!s->async_loop.rqst_head) break;
+    async_rqst_t* rqst = s->async_loop.rqst_head;
+    s->async_loop.rqst_head = rqst->next;
+    if (!s->async_loop.rqst_head) s->async_loop.rqst_tail = NULL;
+    rqst->next = NULL;
+    s->async_loop.busy = 1;
+    pthread_mutex_unlock(&s->async_loop.mutex);
+
+    // CAUTION: the request with callback is freed after the call, it is not used behind it
+    uint8_t has_cb = (rqst->cb != NULL) ? (1) : (0);
+    async_perform(s, rqst);
+    if (has_cb) {
+      rqst->cb(&rqst->completion);
+      free_async_rqst(rqst);
+      rqst = NULL;
+    }
+
+    pthread_mutex_lock(&s->async_loop.mutex);
+    if (!has_cb) {
+      if (s->async_loop.cmpl_tail)
+        s->async_loop.cmpl_tail->next = rqst;
+      else
+        s->async_loop.cmpl_head = rqst;
+      s->async_loop.cmpl_tail = rqst;
+      uint8_t val = 1;
+      if (write(s->async_loop.cmpl_fd[1], &val, sizeof(val)) < 0) {
+        // Pipe is full: it is readable anyway
+      }
+    }
+    s->async_loop.busy = 0;
+    pthread_cond_broadcast(&s->async_loop.cond);
+  }
+  pthread_mutex_unlock(&s->async_loop.mutex);
+  return NULL;
+}
+static int open_async_pipe(rxs_session_t* s) {
+  if (s->async_loop.cmpl_fd[0] >= 0) return 0;
+  if (pipe(s->async_loop.cmpl_fd) != 0) return -1;
+  fcntl(s->async_loop.cmpl_fd[0], F_SETFL, O_NONBLOCK);
+  fcntl(s->async_loop.cmpl_fd[1], F_SETFL, O_NONBLOCK);
+  return 0;
+}
+static int async_start(rxs_session_t* s) {
+  if (s->async_loop.started) return 0;
+
+  if (open_async_pipe(s) != 0) return -1;
+  s->async_loop.stop = 0;
+  int err_no = pthread_create(&s->async_loop.thr, NULL, async_loop_thr, s);
+  if (err_no != 0) {
+    errno = err_no;
+    return -1;
+  }
+  s->async_loop.started = 1;
+  return 0;
+}
+// Wait until pending requests are performed. The event loop thread itself performs blocking functions
+static void async_drain(rxs_session_t* s) {
+  if (!s->async_loop.started || pthread_equal(pthread_self(), s->async_loop.thr)) return;
+
+  pthread_mutex_lock(&s->async_loop.mutex);
+  while (s->async_loop.rqst_head || s->async_loop.busy) pthread_cond_wait(&s->async_loop.cond, &s->async_loop.mutex);
+  pthread_mutex_unlock(&s->async_loop.mutex);
+}
+// Perform pending requests and stop the event loop thread
+static void async_stop(rxs_session_t* s) {
+  if (!s->async_loop.started || pthread_equal(pthread_self(), s->async_loop.thr)) return;
+
+  pthread_mutex_lock(&s->async_loop.mutex);
+  s->async_loop.stop = 1;
+  pthread_cond_broadcast(&s->async_loop.cond);
+  pthread_mutex_unlock(&s->async_loop.mutex);
+
+  int err_no = pthread_join(s->async_loop.thr, NULL);
+  if (err_no != 0) log_msg(ERRN, 6, "pthread_join", strerror(err_no));
+  s->async_loop.started = 0;
+  s->async_loop.stop = 0;
+}
+// Users of the connection in background are stopped before the blocking function
+static void pause_background(rxs_session_t* s) {
+  async_drain(s);
+  readahead_pause(s);
+}
+static RXS_TOKEN async_submit(rxs_session_t* s, rxs_async_op_t op, RXS_HANDLE stream, void* buf, size_t buf_sz,
+                              const char* path, const char* mode, rxs_callback_t cb, void* user_data) {
+  async_rqst_t* rqst = calloc(1, sizeof(async_rqst_t));
+  if (!rqst) {
+    s->errno_both_sides = ENOMEM;
+    return 0;
+  }
+  rqst->completion.op = op;
+  rqst->completion.user_data = user_data;
+  rqst->cb = cb;
+  rqst->stream = stream;
+  rqst->buf = buf;
+  rqst->buf_sz = buf_sz;
+  if (path) rqst->path = strdup(path);
+  if (mode) rqst->mode = strdup(mode);
+  if ((path && !rqst->path) || (mode && !rqst->mode)) {
+    free_async_rqst(rqst);
+    s->errno_both_sides = ENOMEM;
+    return 0;
+  }
+
+  pthread_mutex_lock(&s->async_loop.mutex);
+  if (async_start(s) != 0) {
+    pthread_mutex_unlock(&s->async_loop.mutex);
+    s->errno_both_sides = errno;
+    log_msg(ERRN, 6, "pthread_create", strerror(errno));
+    free_async_rqst(rqst);
+    return 0;
+  }
+  rqst->completion.token = ++s->async_loop.token_last;
+  if (s->async_loop.rqst_tail)
+    s->async_loop.rqst_tail->next = rqst;
+  else
+    s->async_loop.rqst_head = rqst;
+  s->async_loop.rqst_tail = rqst;
+  RXS_TOKEN token = rqst->completion.token;
+  pthread_cond_broadcast(&s->async_loop.cond);
+  pthread_mutex_unlock(&s->async_loop.mutex);
+  return token;
+}
+RXS_TOKEN rxs_session_fopen_async(rxs_session_t* s, const char* fname, const char* mode, rxs_callback_t cb,
+                                  void* user_data) {
+  if (!fname || !mode) {
+    s->errno_both_sides = EINVAL;
+    return 0;
+  }
+  return async_submit(s, async_op_fopen, 0, NULL, 0, fname, mode, cb, user_data);
+}
+RXS_TOKEN rxs_session_fread_async(rxs_session_t* s, void* buf, size_t size, size_t count, RXS_HANDLE stream,
+                                  rxs_callback_t cb, void* user_data) {
+  return async_submit(s, async_op_fread, stream, buf, size * count, NULL, NULL, cb, user_data);
+}
+RXS_TOKEN rxs_session_fwrite_async(rxs_session_t* s, const void* buf, size_t size, size_t count, RXS_HANDLE stream,
+                                   rxs_callback_t cb, void* user_data) {
+  return async_submit(s, async_op_fwrite, stream, (void*)buf, size * count, NULL, NULL, cb, user_data);
+}
+RXS_TOKEN rxs_session_fflush_async(rxs_session_t* s, RXS_HANDLE stream, rxs_callback_t cb, void* user_data) {
+  return async_submit(s, async_op_fflush, stream, NULL, 0, NULL, NULL, cb, user_data);
+}
+RXS_TOKEN rxs_session_fclose_async(rxs_session_t* s, RXS_HANDLE stream, rxs_callback_t cb, void* user_data) {
+  return async_submit(s, async_op_fclose, stream, NULL, 0, NULL, NULL, cb, user_data);
+}
+RXS_TOKEN rxs_session_filesize_async(rxs_session_t* s, const char* fname, rxs_callback_t cb, void* user_data) {
+  if (!fname) {
+    s->errno_both_sides = EINVAL;
+    return 0;
+  }
+  return async_submit(s, async_op_filesize, 0, NULL, 0, fname, NULL, cb, user_data);
+}
+RXS_TOKEN rxs_session_unlink_async(rxs_session_t* s, const char* path, rxs_callback_t cb, void* user_data) {
+  if (!path) {
+    s->errno_both_sides = EINVAL;
+    return 0;
+  }
+  return async_submit(s, async_op_unlink, 0, NULL, 0, path, NULL, cb, user_data);
+}
+int rxs_session_async_fd(rxs_session_t* s) {
+  pthread_mutex_lock(&s->async_loop.mutex);
+  if (open_async_pipe(s) != 0) s->errno_both_sides = errno;
+  int fd = s->async_loop.cmpl_fd[0];
+  pthread_mutex_unlock(&s->async_loop.mutex);
+  return fd;
+}
+size_t rxs_session_async_complete(rxs_session_t* s, rxs_completion_t* completions, size_t count) {
+  if (!completions) return 0;
+
+  size_t cnt = 0;
+  pthread_mutex_lock(&s->async_loop.mutex);
+  while ((cnt < count) && s->async_loop.cmpl_head) {
+    async_rqst_t* rqst = s->async_loop.cmpl_head;
+    s->async_loop.cmpl_head = rqst->next;
+    if (!s->async_loop.cmpl_head) s->async_loop.cmpl_tail = NULL;
+    completions[cnt++] = rqst->completion;
+    free_async_rqst(rqst);
+    // Every completion is signalled by one byte of the pipe
+    uint8_t val = 0;
+    if (read(s->async_loop.cmpl_fd[0], &val, sizeof(val)) < 0) {
+      // Nothing to do
+    }
+  }
+  pthread_mutex_unlock(&s->async_loop.mutex);
+  return cnt;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// Metadata cache
+//////////////////////////////////////////////////////////////////////////////////////////////////
+static uint64_t monotonic_msec() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000 + (uint64_t)now.tv_nsec / 1000000;
+}
+void rxs_session_set_meta_cache(rxs_session_t* s, uint32_t ttl_msec) {
+  pause_background(s);
+  if (!ttl_msec) {
+    free(s->meta_cache.entries);
+    s->meta_cache.entries = NULL;
+  } else if (!s->meta_cache.entries) {
+    s->meta_cache.entries = (meta_entry_t*)calloc(META_CACHE_ENTRIES, sizeof(meta_entry_t));
+    if (!s->meta_cache.entries) log_msg(ERRN, 44, META_CACHE_ENTRIES * sizeof(meta_entry_t));
+  }
+  s->meta_cache.ttl_msec = ttl_msec;
+  s->meta_cache.gen++;
+}
+void rxs_session_meta_cache_stat(rxs_session_t* s, uint64_t* hits, uint64_t* misses) {
+  if (hits) *hits = s->meta_cache.hits;
+  if (misses) *misses = s->meta_cache.misses;
+}
+int rxs_session_set_rate_limit(rxs_session_t* s, uint64_t rate, uint64_t burst) {
+  return (set_rate_limit_t(&s->rate_limit, rate, burst) == 0) ? (0) : (-1);
+}
+// Drop all entries, the current directory is dropped when it is changed by the call
+static void meta_cache_clear(rxs_session_t* s, uint8_t with_cwd) {
+  s->meta_cache.gen++;
+  if (with_cwd) s->meta_cache.cwd_expire_msec = 0;
+}
+static meta_entry_t* meta_cache_slot(rxs_session_t* s, meta_kind_t kind, const char* path) {
+  if (!s->meta_cache.entries || !path || (strlen(path) >= META_CACHE_PATH_MAX)) return NULL;
+  // FNV-1a
+  uint32_t hash = 2166136261u ^ (uint32_t)kind;
+  for (const char* p = path; *p; p++) hash = (hash ^ (uint8_t)*p) * 16777619u;
+  return &s->meta_cache.entries[hash % META_CACHE_ENTRIES];
+}
+// Return value: 1 if the result is found ('val' and the errno of the session are set), otherwise 0
+static int meta_cache_get(rxs_session_t* s, meta_kind_t kind, const char* path, long* val) {
+  meta_entry_t* entry = meta_cache_slot(s, kind, path);
+  if (!entry) return 0;
+
+  if ((entry->kind != kind) || (entry->gen != s->meta_cache.gen) || (monotonic_msec() >= entry->expire_msec) ||
+      strcmp(entry->path, path)) {
+    s->meta_cache.misses++;
+    return 0;
+  }
+  s->meta_cache.hits++;
+  *val = entry->val;
+  s->errno_both_sides = entry->err_no;
+  return 1;
+}
+// Only answers of other side are kept, errors of the connection are not
+static void meta_cache_put(rxs_session_t* s, meta_kind_t kind, const char* path, long val) {
+  meta_entry_t* entry = meta_cache_slot(s, kind, path);
+  if (!entry) return;
 
-  pthread_exit(NULL);
+  entry->kind = kind;
+  entry->gen = s->meta_cache.gen;
+  entry->expire_msec = monotonic_msec() + s->meta_cache.ttl_msec;
+  entry->val = val;
+  entry->err_no = s->errno_both_sides;
+  snprintf(entry->path, sizeof(entry->path), "%s", path);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////
@@ -109,20 +969,29 @@ void* data_receiver(void* arg) {
 //////////////////////////////////////////////////////////////////////////////////////////////////
 // create access point to remote side (socket data transfer).
 // Return value: on successful returns 0, otherwise -1
-size_t rxs_data_point_create_client(RXS_HANDLE stream);
-// close access poit to remote side (socket data transfer)
+size_t rxs_data_point_create_client(rxs_session_t* s, RXS_HANDLE stream);
+// close access poit to remote side (socket data transfer of the stream)
 // Return value: on successful returns 0, otherwise -1
-size_t rxs_data_point_close();
+size_t rxs_data_point_close(rxs_session_t* s, RXS_HANDLE stream);
+// close access point to remote side (control socket and all streams of the session)
+// Return value: on successful returns 0, otherwise -1
+static size_t session_point_close(rxs_session_t* s);
 
 //////////////////////////////////////////////////////////////////////////////////////////////////
 // Implementation of interna/extrnal clients functions
 //////////////////////////////////////////////////////////////////////////////////////////////////
-size_t rxs_data_point_create_client(RXS_HANDLE stream) {
+size_t rxs_data_point_create_client(rxs_session_t* s, RXS_HANDLE stream) {
+  data_channel_t* channel = new_data_channel(s, stream);
+  if (!channel) {
+    s->errno_both_sides = EMFILE;
+    return -1;
+  }
   int sock_data = socket(PF_INET, SOCK_STREAM, 0);
+  channel->sockfd = sock_data;
   if (sock_data < 0) {
-    errno_both_sides = errno;
+    s->errno_both_sides = errno;
     log_msg(ERRN, 6, "socket, data connection", strerror(errno));
-    rxs_data_point_close();
+    rxs_data_point_close(s, stream);
     return -1;
   }
   struct sockaddr_in data_addr;
@@ -132,9 +1001,9 @@ size_t rxs_data_point_create_client(RXS_HANDLE stream) {
 
   int reuseaddr = 1;
   if (setsockopt(sock_data, SOL_SOCKET, SO_REUSEADDR, &reuseaddr, sizeof(reuseaddr)) < 0) {
-    errno_both_sides = errno;
+    s->errno_both_sides = errno;
     log_msg(ERRN, 59, "SO_REUSEADDR", strerror(errno));
-    rxs_data_point_close();
+    rxs_data_point_close(s, stream);
     return -1;
   }
 
@@ -144,23 +1013,23 @@ size_t rxs_data_point_create_client(RXS_HANDLE stream) {
   if (bind(sock_data, (struct sockaddr*)&data_addr, addr_len) < 0) {
     char ipAddress[INET_ADDRSTRLEN];
     inet_ntop(AF_INET, &(data_addr.sin_addr), ipAddress, INET_ADDRSTRLEN);
-    errno_both_sides = errno;
+    s->errno_both_sides = errno;
     log_msg(ERRN, 56, strerror(errno));
-    rxs_data_point_close();
+    rxs_data_point_close(s, stream);
     return -1;
   }
   if (getsockname(sock_data, (struct sockaddr*)&data_addr, &addr_len) < 0) {
-    errno_both_sides = errno;
+    s->errno_both_sides = errno;
     log_msg(ERRN, 6, "getsockname", strerror(errno));
-    rxs_data_point_close();
+    rxs_data_point_close(s, stream);
     return -1;
   }
   /*
-      if(set_socket_mode(sock_data, have_encoder) !=0)
+      if(set_socket_mode(sock_data, s->have_encoder) !=0)
       {
-          errno_both_sides = errno;
+          s->errno_both_sides = errno;
           log_msg(ERRN, 6, "set_socket_mode #1", strerror(errno));
-          rxs_data_point_close();
+          rxs_data_point_close(s, stream);
           return -1;
       }
   */
@@ -171,24 +1040,22 @@ size_t rxs_data_point_create_client(RXS_HANDLE stream) {
   // Microsoft’s dynamic backlog feature, or pick a value somewhere in the 20-200 range and tune it as required.
   int backlog = 30;  // SOMAXCONN;
   if (listen(sock_data, backlog) < 0) {
-    errno_both_sides = errno;
+    s->errno_both_sides = errno;
     log_msg(ERRN, 6, "listen", strerror(errno));
-    rxs_data_point_close();
+    rxs_data_point_close(s, stream);
     return -1;
   }
 
   ssize_t res =
-      rqst_x05_resp_x00(get_socket_connected(), CS_A0, operation_port, stream, port_h, NULL, 0, &errno_both_sides);
-  if (errno_both_sides) errno_both_sides = RXS_SRV_NONE + errno_both_sides;
+      rqst_x05_resp_x00(get_socket_connected(s), CS_A0, operation_port, stream, port_h, NULL, 0, &s->errno_both_sides);
+  if (s->errno_both_sides) s->errno_both_sides = RXS_SRV_NONE + s->errno_both_sides;
   if (res < 0) {
     // Set errno
-    if (!errno_both_sides) errno_both_sides = EIO;
-    rxs_data_point_close();
+    if (!s->errno_both_sides) s->errno_both_sides = EIO;
+    rxs_data_point_close(s, stream);
     // log_msg(ERRN, 6, "rqst_x05_resp_x00", strerror(errno));
     return -1;
   }
-  // Set socket data
-  set_socket_data(sock_data);
 
   struct pollfd sockfd_poll[1] = {{-1}};
   memset(sockfd_poll, -1, sizeof(sockfd_poll));
@@ -198,25 +1065,24 @@ size_t rxs_data_point_create_client(RXS_HANDLE stream) {
   if (ret_code > 0) {
     if ((sockfd_poll[0].revents & POLLIN) && (sockfd_poll[0].fd == sock_data)) {
       int sock_data_client = accept(sock_data, (struct sockaddr*)&data_addr, &addr_len);
+      channel->sockfd_client = sock_data_client;
       if (sock_data_client < 0) {
-        errno_both_sides = errno;
+        s->errno_both_sides = errno;
         log_msg(ERRN, 6, "accept() sock_data", strerror(errno));
-        rxs_data_point_close();
+        rxs_data_point_close(s, stream);
         return -1;
       }
-      if (set_socket_mode(sock_data_client, have_encoder) != 0) {
-        errno_both_sides = errno;
+      if (set_socket_mode(sock_data_client, s->have_encoder) != 0) {
+        s->errno_both_sides = errno;
         log_msg(ERRN, 6, "set_socket_mode #4", strerror(errno));
-        rxs_data_point_close();
+        rxs_data_point_close(s, stream);
         return -1;
       }
-      // Set socket data client
-      set_socket_data_client(sock_data_client);
       return 0;
     } else {
-      errno_both_sides = errno;
+      s->errno_both_sides = errno;
       log_msg(ERRN, 6, "poll catch unexpexted event", strerror(errno));
-      rxs_data_point_close();
+      rxs_data_point_close(s, stream);
       return -1;
     }
   }
@@ -224,25 +1090,44 @@ size_t rxs_data_point_create_client(RXS_HANDLE stream) {
   else {
     if (ret_code == 0) log_msg(WARN, 6, "poll() timeout #1", strerror(errno));
     if (ret_code < 0) log_msg(ERRN, 6, "poll() error", strerror(errno));
-    errno_both_sides = errno;
-    rxs_data_point_close();
+    s->errno_both_sides = errno;
+    rxs_data_point_close(s, stream);
     return -1;
   }
   return -1;
 }
-size_t rxs_point_create(const char* host_p, uint16_t port_h, const char* username, const char* password, int encoder) {
+// TCP keepalive of the control connection: dead peers of idle (e.g. pooled) sessions are found by the kernel
+static void set_socket_keepalive(int sockfd) {
+  int on = 1;
+  if (setsockopt(sockfd, SOL_SOCKET, SO_KEEPALIVE, &on, sizeof(on)) != 0) {
+    log_msg(WARN, 6, "setsockopt SO_KEEPALIVE", strerror(errno));
+    return;
+  }
+#if defined(TCP_KEEPIDLE) && defined(TCP_KEEPINTVL) && defined(TCP_KEEPCNT)
+  int idle_sec = KEEPALIVE_IDLE_SEC;
+  int intvl_sec = KEEPALIVE_INTVL_SEC;
+  int cnt = KEEPALIVE_CNT;
+  if ((setsockopt(sockfd, IPPROTO_TCP, TCP_KEEPIDLE, &idle_sec, sizeof(idle_sec)) != 0) ||
+      (setsockopt(sockfd, IPPROTO_TCP, TCP_KEEPINTVL, &intvl_sec, sizeof(intvl_sec)) != 0) ||
+      (setsockopt(sockfd, IPPROTO_TCP, TCP_KEEPCNT, &cnt, sizeof(cnt)) != 0))
+    log_msg(WARN, 6, "setsockopt TCP_KEEPIDLE", strerror(errno));
+#endif
+}
+static size_t session_point_create(rxs_session_t* s, const char* host_p, uint16_t port_h, const char* username,
+                                   const char* password, int encoder) {
   if (!host_p || !username || !password) {
     return -1;
   }
   // Set errno
-  errno_both_sides = 0;
-  have_encoder = encoder;
+  s->errno_both_sides = 0;
+  meta_cache_clear(s, 1);
+  s->have_encoder = encoder;
   int sockfd = socket(PF_INET, SOCK_STREAM, 0);
   if (0 > sockfd) {
     // Set errno
-    errno_both_sides = errno;
+    s->errno_both_sides = errno;
     log_msg(ERRN, 6, "socket", strerror(errno));
-    rxs_point_close();
+    session_point_close(s);
     return -1;
   }
   struct sockaddr_in addr_other;
@@ -253,11 +1138,11 @@ size_t rxs_point_create(const char* host_p, uint16_t port_h, const char* usernam
   socklen_t addr_other_len = sizeof(addr_other);
 
   /*
-      if(set_socket_mode(sockfd, have_encoder) !=0)
+      if(set_socket_mode(sockfd, s->have_encoder) !=0)
       {
-          errno_both_sides = errno;
+          s->errno_both_sides = errno;
           log_msg(ERRN, 6, "set_socket_mode#2", strerror(errno));
-          rxs_point_close();
+          session_point_close(s);
           return -1;
       }
   */
@@ -266,47 +1151,48 @@ size_t rxs_point_create(const char* host_p, uint16_t port_h, const char* usernam
   //////////////////////////////////////////////////////////////////////////////////
   if (connect(sockfd, (const struct sockaddr*)&addr_other, addr_other_len) == -1) {
     // Set errno
-    errno_both_sides = errno;
+    s->errno_both_sides = errno;
     log_msg(ERRN, 6, "connect", strerror(errno));
     log_msg(ERRN, 9, host_p, port_h);
-    rxs_point_close();
+    session_point_close(s);
     return -1;
   }
-  if (set_socket_mode(sockfd, have_encoder) != 0) {
-    errno_both_sides = errno;
+  if (set_socket_mode(sockfd, s->have_encoder) != 0) {
+    s->errno_both_sides = errno;
     log_msg(ERRN, 6, "set_socket_mode#3", strerror(errno));
-    rxs_point_close();
+    session_point_close(s);
     return -1;
   }
+  set_socket_keepalive(sockfd);
   //////////////////////////////////////////////////////////////////////////////////
   // Authorization request
   //////////////////////////////////////////////////////////////////////////////////
   ssize_t res = rqst_x02_resp_x00(sockfd, CS_A0, operation_authorization, username, strlen(username), password,
-                                  strlen(password), encoder, NULL, 0, &errno_both_sides);
+                                  strlen(password), encoder, NULL, 0, &s->errno_both_sides);
   if (res < 0) {
     // Set errno
-    if (!errno_both_sides) errno_both_sides = errno;
+    if (!s->errno_both_sides) s->errno_both_sides = errno;
     // log_msg(ERRN, 6, "rqst_x02_resp_x00", strerror(errno));
-    rxs_point_close();
+    session_point_close(s);
     return -1;
   }
 
-  if (EACCES == errno_both_sides) {
+  if (EACCES == s->errno_both_sides) {
     log_msg(ERRN, 29);
-    rxs_point_close();
+    session_point_close(s);
     return -1;
   }
   // Set socket connected
-  set_socket_connected(sockfd);
+  set_socket_connected(s, sockfd);
   // Set errno
-  if (errno_both_sides) errno_both_sides = RXS_SRV_NONE + errno_both_sides;
-  return (!errno_both_sides) ? (0) : (-1);
+  if (s->errno_both_sides) s->errno_both_sides = RXS_SRV_NONE + s->errno_both_sides;
+  return (!s->errno_both_sides) ? (0) : (-1);
 }
-size_t rxs_point_connected() {
-  if (get_socket_connected() >= 0) {
+static size_t session_point_connected(rxs_session_t* s) {
+  if (get_socket_connected(s) >= 0) {
     int err_code;
     socklen_t err_code_sz = sizeof(err_code);
-    int res = getsockopt(get_socket_connected(), SOL_SOCKET, SO_ERROR, &err_code, &err_code_sz);
+    int res = getsockopt(get_socket_connected(s), SOL_SOCKET, SO_ERROR, &err_code, &err_code_sz);
     if (!res) {
       // Broken pipe
       if (EPIPE == err_code) return 0;
@@ -315,60 +1201,93 @@ size_t rxs_point_connected() {
   }
   return 0;
 }
-size_t rxs_point_close() {
-  if (get_socket_connected() != -1) {
-    close(get_socket_connected());
-    set_socket_connected(-1);
+static size_t session_point_close(rxs_session_t* s) {
+  async_stop(s);
+  readahead_drop(s);
+  if (get_socket_connected(s) != -1) flush_write_back_all(s);
+  for (uint32_t i = 0; i < WRITE_BACK_STREAMS_MAX; i++) free_write_back(&s->write_back_tbl[i]);
+  for (uint32_t i = 0; i < DATA_CHANNELS_MAX; i++) {
+    if (s->data_channel_tbl[i].stream) free_data_channel(&s->data_channel_tbl[i]);
+  }
+  if (get_socket_connected(s) != -1) {
+    close(get_socket_connected(s));
+    set_socket_connected(s, -1);
     return 0;
   }
   // Set errno
-  errno_both_sides = errno;
+  s->errno_both_sides = errno;
   return -1;
 }
-size_t rxs_data_point_close() {
-  if (get_socket_data() != -1) {
-    close(get_socket_data());
-    set_socket_data(-1);
+size_t rxs_data_point_close(rxs_session_t* s, RXS_HANDLE stream) {
+  // Readahead cache of the stream is bound to the channel
+  if (s->readahead.stream == stream)
+    readahead_drop(s);
+  else
+    readahead_pause(s);
+  data_channel_t* channel = find_data_channel(s, stream);
+  if (!channel) return -1;
+  free_data_channel(channel);
+  return 0;
+}
+int rxs_session_ping(rxs_session_t* s) {
+  pause_background(s);
+  // Set errno
+  s->errno_both_sides = 0;
+  if (get_socket_connected(s) < 0) {
+    s->errno_both_sides = ENOTCONN;
+    return -1;
+  }
+  uint32_t val = ++s->ping_seq;
+  ssize_t res = rqst_x00_resp_x00(get_socket_connected(s), CS_A0, operation_ping, val, NULL, 0, &s->errno_both_sides);
+  // Set errno
+  if (s->errno_both_sides) s->errno_both_sides = RXS_SRV_NONE + s->errno_both_sides;
+  if (res < 0) {
+    // Set errno
+    if (!s->errno_both_sides) s->errno_both_sides = errno;
+    return -1;
   }
-  if (get_socket_data_client() != -1) {
-    close(get_socket_data_client());
-    set_socket_data_client(-1);
+  if ((uint32_t)res != val) {
+    if (!s->errno_both_sides) s->errno_both_sides = EPROTO;
+    return -1;
   }
   return 0;
 }
-int rxs_errno() { return errno_both_sides; }
-char* rxs_strerror() {
+int rxs_session_errno(rxs_session_t* s) { return s->errno_both_sides; }
+char* rxs_session_strerror(rxs_session_t* s) {
   // srv
-  if (rxs_errno() >= RXS_SRV_NONE) {
+  if (rxs_session_errno(s) >= RXS_SRV_NONE) {
     // sh command not found
-    if (rxs_errno() - RXS_SRV_NONE == 127)
+    if (rxs_session_errno(s) - RXS_SRV_NONE == 127)
       return "command not found";
     else
-      return strerror(rxs_errno() - RXS_SRV_NONE);
+      return strerror(rxs_session_errno(s) - RXS_SRV_NONE);
   }
   // cli
   else {
-    return strerror(rxs_errno());
+    return strerror(rxs_session_errno(s));
   }
 }
-size_t rxs_ls(const char* path, void* path_file, size_t size) {
+size_t rxs_session_ls(rxs_session_t* s, const char* path, void* path_file, size_t size) {
+  pause_background(s);
+  // The command can change any file
+  meta_cache_clear(s, 0);
   if (!path || !path_file) return -1;
   ////////////////////////////////////////////
   // Get path of remote file
   ////////////////////////////////////////////
   char file_remote[PATH_MAX] = {0};
   // Set errno
-  errno_both_sides = 0;
-  ssize_t res = rqst_x01_resp_x01(get_socket_connected(), CS_A0, operation_ls, path, strlen(path), file_remote,
-                                  sizeof(file_remote), &errno_both_sides);
+  s->errno_both_sides = 0;
+  ssize_t res = rqst_x01_resp_x01(get_socket_connected(s), CS_A0, operation_ls, path, strlen(path), file_remote,
+                                  sizeof(file_remote), &s->errno_both_sides);
   // Set errno
-  if (errno_both_sides) {
-    errno_both_sides = RXS_SRV_NONE + errno_both_sides;
+  if (s->errno_both_sides) {
+    s->errno_both_sides = RXS_SRV_NONE + s->errno_both_sides;
     return -1;
   }
   if (res < 0) {
     // Set errno
-    errno_both_sides = errno;
+    s->errno_both_sides = errno;
     // log_msg(ERRN, 6, "rqst_x00_resp_x00", strerror(errno));
     return -1;
   }
@@ -376,7 +1295,7 @@ size_t rxs_ls(const char* path, void* path_file, size_t size) {
   // Get remote file by path
   ////////////////////////////////////////////
   // Open the remote file
-  RXS_HANDLE handle_file_remote = rxs_fopen(file_remote, "rb");
+  RXS_HANDLE handle_file_remote = rxs_session_fopen(s, file_remote, "rb");
   if (0 == handle_file_remote) {
     log_msg(ERRN, 43, file_remote);
     return -1;
@@ -387,27 +1306,27 @@ size_t rxs_ls(const char* path, void* path_file, size_t size) {
   char file_local[PATH_MAX] = "/tmp/output_incoming.dat";
   FILE* handle_file_local = fopen(file_local, "wb");
   if (!handle_file_local) {
-    rxs_fclose(handle_file_remote);
+    rxs_session_fclose(s, handle_file_remote);
     // Remove remote file
-    rxs_unlink(file_remote);
+    rxs_session_unlink(s, file_remote);
     return -1;
   }
   // Close remote file
   fclose(handle_file_local);
   ////////////////////////////////////////////
-  uint32_t buf_recv_sz = (((have_encoder > 0) ? (crypt_packet_sz()) : (crypt_data_sz())) + 1);
+  uint32_t buf_recv_sz = (((s->have_encoder > 0) ? (crypt_packet_sz()) : (crypt_data_sz())) + 1);
   char* buf_recv = (char*)calloc(buf_recv_sz, sizeof(char));
   if (!buf_recv) {
     log_msg(ERRN, 44, buf_recv_sz);
-    rxs_fclose(handle_file_remote);
+    rxs_session_fclose(s, handle_file_remote);
     // Remove remote file
-    rxs_unlink(file_remote);
+    rxs_session_unlink(s, file_remote);
     return -1;
   }
   //////////////////////////////////////////////////////////////////////////////////////////////////
   // Progress bar. Values
   //////////////////////////////////////////////////////////////////////////////////////////////////
-  long file_sz = rxs_filesize(file_remote);
+  long file_sz = rxs_session_filesize(s, file_remote);
   uint8_t percent_last = 0;
   char lexeme[] = "Wait...";
   //////////////////////////////////////////////////////////////////////////////////////////////////
@@ -420,16 +1339,16 @@ size_t rxs_ls(const char* path, void* path_file, size_t size) {
   while (1) {
     memset(buf_recv, 0, buf_recv_sz);
     // Read the remote file
-    size_t read_bytes = rxs_fread(buf_recv, buf_recv_sz, sizeof(char), handle_file_remote);
+    size_t read_bytes = rxs_session_fread(s, buf_recv, buf_recv_sz, sizeof(char), handle_file_remote);
     read_bytes_total += read_bytes;
-    if ((rxs_errno() != 0) && (rxs_errno() != RXS_EOF)) {
+    if ((rxs_session_errno(s) != 0) && (rxs_session_errno(s) != RXS_EOF)) {
       log_msg(ERRN, 45, file_remote);
       // Free memory
       free(buf_recv);
       buf_recv = NULL;
-      rxs_fclose(handle_file_remote);
+      rxs_session_fclose(s, handle_file_remote);
       // Remove remote file
-      rxs_unlink(file_remote);
+      rxs_session_unlink(s, file_remote);
       return -1;
     }
 
@@ -442,168 +1361,213 @@ size_t rxs_ls(const char* path, void* path_file, size_t size) {
       // Free memory
       free(buf_recv);
       buf_recv = NULL;
-      rxs_fclose(handle_file_remote);
+      rxs_session_fclose(s, handle_file_remote);
       // Remove remote file
-      rxs_unlink(file_remote);
+      rxs_session_unlink(s, file_remote);
       return -1;
     }
-    if (rxs_errno() == RXS_EOF) break;
+    if (rxs_session_errno(s) == RXS_EOF) break;
   }
   // Close the remote file
-  res = rxs_fclose(handle_file_remote);
+  res = rxs_session_fclose(s, handle_file_remote);
   if (res) {
-    log_msg(ERRN, 47, res, rxs_errno());
+    log_msg(ERRN, 47, res, rxs_session_errno(s));
   }
   // Free memory
   free(buf_recv);
   buf_recv = NULL;
   // Remove remote file
-  rxs_unlink(file_remote);
+  rxs_session_unlink(s, file_remote);
   // Copy path to local file
   strncpy(path_file, file_local, strlen(file_local));
 
-  return (!errno_both_sides) ? (0) : (-1);
+  return (!s->errno_both_sides) ? (0) : (-1);
 }
-int rxs_mkdir(const char* path, mode_t mode) {
+int rxs_session_mkdir(rxs_session_t* s, const char* path, mode_t mode) {
+  pause_background(s);
+  meta_cache_clear(s, 0);
   // Set errno
-  errno_both_sides = 0;
-  ssize_t res = rqst_x03_resp_x00(get_socket_connected(), CS_A0, operation_mkdir, path, strlen(path), mode, NULL, 0,
-                                  &errno_both_sides);
+  s->errno_both_sides = 0;
+  ssize_t res = rqst_x03_resp_x00(get_socket_connected(s), CS_A0, operation_mkdir, path, strlen(path), mode, NULL, 0,
+                                  &s->errno_both_sides);
   // Set errno
-  if (errno_both_sides) errno_both_sides = RXS_SRV_NONE + errno_both_sides;
+  if (s->errno_both_sides) s->errno_both_sides = RXS_SRV_NONE + s->errno_both_sides;
   if (res < 0) {
     // Set errno
-    if (!errno_both_sides) errno_both_sides = errno;
+    if (!s->errno_both_sides) s->errno_both_sides = errno;
     // log_msg(ERRN, 6, "rqst_x03_resp_x00", strerror(errno));
     return -1;
   }
-  return (!errno_both_sides) ? (0) : (-1);
+  return (!s->errno_both_sides) ? (0) : (-1);
 }
-int rxs_mkdir_ex(const char* path, mode_t mode) {
+int rxs_session_mkdir_ex(rxs_session_t* s, const char* path, mode_t mode) {
+  pause_background(s);
+  meta_cache_clear(s, 0);
   // Set errno
-  errno_both_sides = 0;
-  ssize_t res = rqst_x03_resp_x00(get_socket_connected(), CS_A0, operation_mkdir_ex, path, strlen(path), mode, NULL, 0,
-                                  &errno_both_sides);
+  s->errno_both_sides = 0;
+  ssize_t res = rqst_x03_resp_x00(get_socket_connected(s), CS_A0, operation_mkdir_ex, path, strlen(path), mode, NULL, 0,
+                                  &s->errno_both_sides);
   // Set errno
-  if (errno_both_sides) errno_both_sides = RXS_SRV_NONE + errno_both_sides;
+  if (s->errno_both_sides) s->errno_both_sides = RXS_SRV_NONE + s->errno_both_sides;
   if (res < 0) {
     // Set errno
-    if (!errno_both_sides) errno_both_sides = errno;
+    if (!s->errno_both_sides) s->errno_both_sides = errno;
     // log_msg(ERRN, 6, "rqst_x03_resp_x00", strerror(errno));
     return -1;
   }
-  return (!errno_both_sides) ? (0) : (-1);
+  return (!s->errno_both_sides) ? (0) : (-1);
 }
-int rxs_rmdir(const char* path) {
+int rxs_session_rmdir(rxs_session_t* s, const char* path) {
+  pause_background(s);
+  meta_cache_clear(s, 1);
   // Set errno
-  errno_both_sides = 0;
-  ssize_t res =
-      rqst_x01_resp_x00(get_socket_connected(), CS_A0, operation_rmdir, path, strlen(path), NULL, 0, &errno_both_sides);
+  s->errno_both_sides = 0;
+  ssize_t res = rqst_x01_resp_x00(get_socket_connected(s), CS_A0, operation_rmdir, path, strlen(path), NULL, 0,
+                                  &s->errno_both_sides);
   // Set errno
-  if (errno_both_sides) errno_both_sides = RXS_SRV_NONE + errno_both_sides;
+  if (s->errno_both_sides) s->errno_both_sides = RXS_SRV_NONE + s->errno_both_sides;
   if (res < 0) {
     // Set errno
-    if (!errno_both_sides) errno_both_sides = errno;
+    if (!s->errno_both_sides) s->errno_both_sides = errno;
     // log_msg(ERRN, 6, "rqst_x01_resp_x00", strerror(errno));
     return -1;
   }
-  return (!errno_both_sides) ? (0) : (-1);
+  return (!s->errno_both_sides) ? (0) : (-1);
 }
-char* rxs_getcwd(char* buf, size_t size) {
+char* rxs_session_getcwd(rxs_session_t* s, char* buf, size_t size) {
+  pause_background(s);
   // Set errno
-  errno_both_sides = 0;
-  ssize_t res = rqst_x00_resp_x00(get_socket_connected(), CS_A0, operation_getcwd, size, buf, size, &errno_both_sides);
+  s->errno_both_sides = 0;
+  meta_cache_t* cache = &s->meta_cache;
+  if (cache->entries && buf) {
+    if ((cache->cwd_gen == cache->gen) && (monotonic_msec() < cache->cwd_expire_msec) && (strlen(cache->cwd) < size)) {
+      cache->hits++;
+      return strcpy(buf, cache->cwd);
+    }
+    cache->misses++;
+  }
+  ssize_t res =
+      rqst_x00_resp_x00(get_socket_connected(s), CS_A0, operation_getcwd, size, buf, size, &s->errno_both_sides);
   // Set errno
-  if (errno_both_sides) errno_both_sides = RXS_SRV_NONE + errno_both_sides;
+  if (s->errno_both_sides) s->errno_both_sides = RXS_SRV_NONE + s->errno_both_sides;
   if (res < 0) {
     // Set errno
-    if (!errno_both_sides) errno_both_sides = errno;
+    if (!s->errno_both_sides) s->errno_both_sides = errno;
     // log_msg(ERRN, 6, "rqst_x00_resp_x00", strerror(errno));
     return NULL;
   }
-  return (!errno_both_sides) ? (buf) : (NULL);
+  if (cache->entries && !s->errno_both_sides && (strnlen(buf, size) < sizeof(cache->cwd))) {
+    snprintf(cache->cwd, sizeof(cache->cwd), "%s", buf);
+    cache->cwd_gen = cache->gen;
+    cache->cwd_expire_msec = monotonic_msec() + cache->ttl_msec;
+  }
+  return (!s->errno_both_sides) ? (buf) : (NULL);
 }
-int rxs_chdir(const char* path) {
+int rxs_session_chdir(rxs_session_t* s, const char* path) {
+  pause_background(s);
+  meta_cache_clear(s, 1);
   // Set errno
-  errno_both_sides = 0;
-  ssize_t res =
-      rqst_x01_resp_x00(get_socket_connected(), CS_A0, operation_chdir, path, strlen(path), NULL, 0, &errno_both_sides);
+  s->errno_both_sides = 0;
+  ssize_t res = rqst_x01_resp_x00(get_socket_connected(s), CS_A0, operation_chdir, path, strlen(path), NULL, 0,
+                                  &s->errno_both_sides);
   // Set errno
-  if (errno_both_sides) errno_both_sides = RXS_SRV_NONE + errno_both_sides;
+  if (s->errno_both_sides) s->errno_both_sides = RXS_SRV_NONE + s->errno_both_sides;
   if (res < 0) {
     // Set errno
-    if (!errno_both_sides) errno_both_sides = errno;
+    if (!s->errno_both_sides) s->errno_both_sides = errno;
     // log_msg(ERRN, 6, "rqst_x01_resp_x00", strerror(errno));
     return -1;
   }
-  return (!errno_both_sides) ? (0) : (-1);
+  return (!s->errno_both_sides) ? (0) : (-1);
 }
-int rxs_unlink(const char* path) {
+int rxs_session_unlink(rxs_session_t* s, const char* path) {
+  pause_background(s);
+  meta_cache_clear(s, 0);
   // Set errno
-  errno_both_sides = 0;
-  ssize_t res = rqst_x01_resp_x00(get_socket_connected(), CS_A0, operation_unlink, path, strlen(path), NULL, 0,
-                                  &errno_both_sides);
+  s->errno_both_sides = 0;
+  ssize_t res = rqst_x01_resp_x00(get_socket_connected(s), CS_A0, operation_unlink, path, strlen(path), NULL, 0,
+                                  &s->errno_both_sides);
   // Set errno
-  if (errno_both_sides) errno_both_sides = RXS_SRV_NONE + errno_both_sides;
+  if (s->errno_both_sides) s->errno_both_sides = RXS_SRV_NONE + s->errno_both_sides;
   if (res < 0) {
     // Set errno
-    if (!errno_both_sides) errno_both_sides = errno;
+    if (!s->errno_both_sides) s->errno_both_sides = errno;
     // log_msg(ERRN, 6, "rqst_x01_resp_x00", strerror(errno));
     return -1;
   }
-  return (!errno_both_sides) ? (0) : (-1);
+  return (!s->errno_both_sides) ? (0) : (-1);
 }
-int rxs_rename(const char* oldname, const char* newname) {
+int rxs_session_rename(rxs_session_t* s, const char* oldname, const char* newname) {
+  pause_background(s);
+  meta_cache_clear(s, 0);
   // Set errno
-  errno_both_sides = 0;
-  ssize_t res = rqst_x02_resp_x00(get_socket_connected(), CS_A0, operation_rename, oldname, strlen(oldname), newname,
-                                  strlen(newname), have_encoder, NULL, 0, &errno_both_sides);
+  s->errno_both_sides = 0;
+  ssize_t res = rqst_x02_resp_x00(get_socket_connected(s), CS_A0, operation_rename, oldname, strlen(oldname), newname,
+                                  strlen(newname), s->have_encoder, NULL, 0, &s->errno_both_sides);
   // Set errno
-  if (errno_both_sides) errno_both_sides = RXS_SRV_NONE + errno_both_sides;
+  if (s->errno_both_sides) s->errno_both_sides = RXS_SRV_NONE + s->errno_both_sides;
   if (res < 0) {
     // Set errno
-    if (!errno_both_sides) errno_both_sides = errno;
+    if (!s->errno_both_sides) s->errno_both_sides = errno;
     // log_msg(ERRN, 6, "rqst_x02_resp_x00", strerror(errno));
     return -1;
   }
-  return (!errno_both_sides) ? (0) : (-1);
+  return (!s->errno_both_sides) ? (0) : (-1);
 }
-long rxs_filesize(const char* fname) {
+long rxs_session_filesize(rxs_session_t* s, const char* fname) {
+  pause_background(s);
   // Set errno
-  errno_both_sides = 0;
-  ssize_t res = rqst_x01_resp_x00(get_socket_connected(), CS_A0, operation_filesize, fname, strlen(fname), NULL, 0,
-                                  &errno_both_sides);
+  s->errno_both_sides = 0;
+  long val = -1;
+  if (meta_cache_get(s, meta_filesize, fname, &val)) return val;
+  ssize_t res = rqst_x01_resp_x00(get_socket_connected(s), CS_A0, operation_filesize, fname, strlen(fname), NULL, 0,
+                                  &s->errno_both_sides);
   // Set errno
-  if (errno_both_sides) errno_both_sides = RXS_SRV_NONE + errno_both_sides;
+  if (s->errno_both_sides) s->errno_both_sides = RXS_SRV_NONE + s->errno_both_sides;
   if (res < 0) {
     // Set errno
-    if (!errno_both_sides) errno_both_sides = errno;
+    if (!s->errno_both_sides) s->errno_both_sides = errno;
     // log_msg(ERRN, 6, "rqst_x01_resp_x00", strerror(errno));
+    // Negative answer of other side (e.g. the path does not exist)
+    if (s->errno_both_sides >= RXS_SRV_NONE) meta_cache_put(s, meta_filesize, fname, -1);
     return -1;
   }
-  return (!errno_both_sides) ? ((long)res) : (-1);
+  val = (!s->errno_both_sides) ? ((long)res) : (-1);
+  meta_cache_put(s, meta_filesize, fname, val);
+  return val;
 }
-RXS_HANDLE rxs_fopen(const char* fname, const char* mode) {
+RXS_HANDLE rxs_session_fopen(rxs_session_t* s, const char* fname, const char* mode) {
+  pause_background(s);
+  // The file can be created or truncated
+  if (strpbrk(mode, "wa+")) meta_cache_clear(s, 0);
   // Set errno
-  errno_both_sides = 0;
-  ssize_t res = rqst_x02_resp_x00(get_socket_connected(), CS_A0, operation_fopen, fname, strlen(fname), mode,
-                                  strlen(mode), have_encoder, NULL, 0, &errno_both_sides);
+  s->errno_both_sides = 0;
+  ssize_t res = rqst_x02_resp_x00(get_socket_connected(s), CS_A0, operation_fopen, fname, strlen(fname), mode,
+                                  strlen(mode), s->have_encoder, NULL, 0, &s->errno_both_sides);
   // Set errno
-  if (errno_both_sides) errno_both_sides = RXS_SRV_NONE + errno_both_sides;
+  if (s->errno_both_sides) s->errno_both_sides = RXS_SRV_NONE + s->errno_both_sides;
   if (-1 == res) {
     // Set errno
-    if (!errno_both_sides) errno_both_sides = errno;
+    if (!s->errno_both_sides) s->errno_both_sides = errno;
     // log_msg(ERRN, 6, "rqst_x02_resp_x00", strerror(errno));
     return -1;
   }
-  // return (!errno_both_sides)?(res):(0);
+  // return (!s->errno_both_sides)?(res):(0);
   //////////////////////////////////////////////////////////////////////////////////////////////////
   // Create RXS data point
   //////////////////////////////////////////////////////////////////////////////////////////////////
   // All Okay
-  if (!errno_both_sides) {
-    if (rxs_data_point_create_client(res) != 0) {
-      rxs_point_close();
+  if (!s->errno_both_sides) {
+    if (rxs_data_point_create_client(s, res) != 0) {
+      // The stream is released on the server, the session is kept for other streams
+      int err_no = (s->errno_both_sides) ? (s->errno_both_sides) : (EMFILE);
+      int err_no_close = 0;
+      ssize_t res_close =
+          rqst_x00_resp_x00(get_socket_connected(s), CS_A0, operation_fclose, res, NULL, 0, &err_no_close);
+      // The control connection is broken
+      if ((res_close < 0) && !err_no_close) session_point_close(s);
+      // Set errno
+      s->errno_both_sides = err_no;
       return 0;
     }
     return res;
@@ -613,53 +1577,51 @@ RXS_HANDLE rxs_fopen(const char* fname, const char* mode) {
     return 0;
   }
 }
-size_t rxs_fread(void* buf, size_t size, size_t count, RXS_HANDLE stream) {
-  if (!buf) {
-    errno_both_sides = EINVAL;
-    return 0;
-  }
-  size_t buf_sz = size * count;
-  memset(buf, 0, buf_sz);
-  if (get_socket_data_client() < 0) {
-    errno_both_sides = EINVAL;
-    return 0;
-  }
-  // Set errno
-  errno_both_sides = 0;
-  //////////////////////////////////////////////////////////////////////////////////
-  // CAUTION: Zero data size don't send to avoid overload of empty/redundant operations on the server
-  //////////////////////////////////////////////////////////////////////////////////
-  if (buf_sz > LONG_MAX) {
-    errno_both_sides = EINVAL;
-    log_msg(ERRN, 50, buf_sz, LONG_MAX);
+// Read a portion of the stream from other side. Status of the portion is set to 'err_no' (RXS_EOF - end of file)
+static size_t fread_remote(rxs_session_t* s, void* buf, size_t buf_sz, RXS_HANDLE stream, int64_t offset,
+                           int* err_no) {
+  data_channel_t* channel = find_data_channel(s, stream);
+  if (!channel || (channel->sockfd_client < 0)) {
+    *err_no = EINVAL;
     return 0;
   }
+  data_receiver_t* rcv = &channel->receiver;
   //////////////////////////////////////////////////////////////////////////////////
-  // Send to other side size of receiver buffer
+  // Send to other side size of receiver buffer (and the position of positioned read)
   //////////////////////////////////////////////////////////////////////////////////
-  if (rxs_send_packet_x04(get_socket_connected(), CS_A0, operation_fread, stream, buf_sz, 0) < 0) {
-    if (!errno_both_sides) errno_both_sides = EIO;
+  rxs_operation_t operation = (offset < 0) ? (operation_fread) : (operation_pread);
+  ssize_t res = (offset < 0) ? (rxs_send_packet_x04(get_socket_connected(s), CS_A0, operation, stream, buf_sz, 0))
+                             : (rxs_send_packet_x06(get_socket_connected(s), CS_A0, operation, stream,
+                                                    (uint64_t)offset, buf_sz));
+  if (res < 0) {
+    if (!*err_no) *err_no = EIO;
     // log_msg(ERRN, 6, "rxs_send_packet_x04", strerror(errno));
     return 0;
   }
   //////////////////////////////////////////////////////////////////////////////////
-  // Start data receiver thread
+  // Post the job to data receiver thread
   //////////////////////////////////////////////////////////////////////////////////
   data_exchange_t data_exchange;
   memset(&data_exchange, 0, sizeof(data_exchange));
-  data_exchange.sockfd = get_socket_data_client();
+  data_exchange.sockfd = channel->sockfd_client;
   data_exchange.stream = stream;
   data_exchange.buf = buf;
   data_exchange.buf_sz = buf_sz;
+  // Other side sends only whole blocks are fitted into the buffer
+  size_t block_recv_sz = ((s->have_encoder > 0) ? (crypt_packet_sz()) : (crypt_data_sz()));
+  data_exchange.channel_sz = buf_sz - (buf_sz % block_recv_sz);
   data_exchange.total_impl_channel_sz = 0;
   data_exchange.total_impl_sz = 0;
   data_exchange.complete = 0;
 
-  int err_no = 0;
-  if ((err_no = pthread_create(&data_receiver_thr, NULL, data_receiver, (void*)&data_exchange)) != 0) {
-    log_msg(ERRN, 6, "pthread_create", strerror(err_no));
+  if (start_data_receiver(rcv) != 0) {
+    log_msg(ERRN, 6, "pthread_create", strerror(errno));
     return 0;
   }
+  pthread_mutex_lock(&rcv->mutex);
+  rcv->job = &data_exchange;
+  pthread_cond_broadcast(&rcv->cond);
+  pthread_mutex_unlock(&rcv->mutex);
   //////////////////////////////////////////////////////////////////////////////////
   // Wait whole portion data or EOF from other side
   //////////////////////////////////////////////////////////////////////////////////
@@ -667,104 +1629,182 @@ size_t rxs_fread(void* buf, size_t size, size_t count, RXS_HANDLE stream) {
   uint32_t other_side_stream = 0;
   uint32_t other_side_data_sz = 0;
   uint16_t other_side_eof = 0;
-  ssize_t res = rxs_recv_packet_x04(get_socket_connected(), &type, operation_fread, &other_side_stream,
-                                    &other_side_data_sz, &other_side_eof);
+  res = rxs_recv_packet_x04(get_socket_connected(s), &type, operation, &other_side_stream, &other_side_data_sz,
+                            &other_side_eof);
   if ((res < 0) || (type != SC_B0) || (stream != other_side_stream)) {
-    if (!errno_both_sides) errno_both_sides = EIO;
+    if (!*err_no) *err_no = EIO;
     // log_msg(ERRN, 6, "rxs_recv_packet_x04", strerror(errno));
+    // Cancel the job
+    wait_data_receiver(rcv, &data_exchange, 0);
     return 0;
   }
 
-  if (other_side_eof || other_side_data_sz) {
+  if (other_side_eof) {
     //////////////////////////////////////////////////////////////////////////////////
     // Send confirm to other side for to close operation
     //////////////////////////////////////////////////////////////////////////////////
-    if (other_side_eof) {
-      if (rxs_send_packet_x04(get_socket_connected(), CS_A0, operation_fread, stream,
-                              data_exchange.total_impl_channel_sz, 0) < 0) {
-        if (!errno_both_sides) errno_both_sides = EIO;
-        // log_msg(ERRN, 6, "rxs_send_packet_x04", strerror(errno));
-        return 0;
-      }
+    if (rxs_send_packet_x04(get_socket_connected(s), CS_A0, operation, stream, other_side_data_sz, 0) < 0) {
+      if (!*err_no) *err_no = EIO;
+      // log_msg(ERRN, 6, "rxs_send_packet_x04", strerror(errno));
+      wait_data_receiver(rcv, &data_exchange, 0);
+      return 0;
     }
-
-    while ((!other_side_eof && !data_exchange.complete) ||
-           (other_side_eof && (other_side_data_sz > data_exchange.total_impl_channel_sz)))
-      sleep_x(0, 100000);  // 100 microseconds
-
-    //////////////////////////////////////////////////////////////////////////////////
-    // Close data receiver thread
-    //////////////////////////////////////////////////////////////////////////////////
-    pthread_cancel(data_receiver_thr);
-    int err_no = 0;
-    void* res = NULL;
-    if ((err_no = pthread_join(data_receiver_thr, &res)) != 0) log_msg(ERRN, 6, "pthread_join", strerror(err_no));
-
-    errno_both_sides = other_side_eof;
   }
+  //////////////////////////////////////////////////////////////////////////////////
+  // Other side reports the size of data are sent to the channel
+  //////////////////////////////////////////////////////////////////////////////////
+  wait_data_receiver(rcv, &data_exchange, other_side_data_sz);
+  if (other_side_eof || other_side_data_sz) *err_no = other_side_eof;
   return data_exchange.total_impl_sz;
 }
-size_t rxs_fwrite(const void* buf, size_t size, size_t count, RXS_HANDLE stream) {
-  size_t buf_sz = size * count;
-  if (get_socket_data_client() < 0) {
-    errno_both_sides = EINVAL;
-    return -1;
+size_t rxs_session_fread(rxs_session_t* s, void* buf, size_t size, size_t count, RXS_HANDLE stream) {
+  async_drain(s);
+  if (!buf) {
+    s->errno_both_sides = EINVAL;
+    return 0;
   }
-  if (0 == buf_sz) {
-    // Set errno
-    errno_both_sides = EINVAL;
-    log_msg(ERRN, 52, buf_sz);
+  size_t buf_sz = size * count;
+  memset(buf, 0, buf_sz);
+  if (get_socket_data_client(s, stream) < 0) {
+    s->errno_both_sides = EINVAL;
     return 0;
   }
+  // Set errno
+  s->errno_both_sides = 0;
+  //////////////////////////////////////////////////////////////////////////////////
+  // CAUTION: Zero data size don't send to avoid overload of empty/redundant operations on the server
+  //////////////////////////////////////////////////////////////////////////////////
   if (buf_sz > LONG_MAX) {
-    // Set errno
-    errno_both_sides = EINVAL;
+    s->errno_both_sides = EINVAL;
     log_msg(ERRN, 50, buf_sz, LONG_MAX);
     return 0;
   }
+  // Written data of the stream are sent before the read
+  if (flush_write_back(s, find_write_back(s, stream)) != 0) return 0;
   //////////////////////////////////////////////////////////////////////////////////
-  // Send to other side size of transmitted data
+  // Other stream is read while the cache is kept for its owner
   //////////////////////////////////////////////////////////////////////////////////
-  if (rxs_send_packet_x04(get_socket_connected(), CS_A0, operation_fwrite, stream, buf_sz, 0) < 0) {
+  if (s->readahead.stream && (s->readahead.stream != stream)) {
+    readahead_pause(s);
+    return fread_remote(s, buf, buf_sz, stream, RXS_OFFSET_CURRENT, &s->errno_both_sides);
+  }
+  s->readahead.stream = stream;
+  if (s->readahead.depth_max) return readahead_read(s, buf, buf_sz);
+  //////////////////////////////////////////////////////////////////////////////////
+  // Detect sequential reads
+  //////////////////////////////////////////////////////////////////////////////////
+  size_t impl_sz = fread_remote(s, buf, buf_sz, stream, RXS_OFFSET_CURRENT, &s->errno_both_sides);
+  if (s->errno_both_sides) {
+    s->readahead.seq_cnt = 0;
+    return impl_sz;
+  }
+  if (buf_sz == s->readahead.rqst_sz) {
+    s->readahead.seq_cnt++;
+  } else {
+    s->readahead.rqst_sz = buf_sz;
+    s->readahead.seq_cnt = 1;
+  }
+  size_t block_sz = ((s->have_encoder > 0) ? (crypt_packet_sz()) : (crypt_data_sz()));
+  if ((s->readahead.seq_cnt >= READAHEAD_SEQ_THRESHOLD) && (buf_sz >= block_sz)) {
+    uint32_t depth_max = s->readahead.mem_max / buf_sz;
+    s->readahead.depth_max = (depth_max > READAHEAD_DEPTH_MAX) ? (READAHEAD_DEPTH_MAX) : (depth_max);
+    s->readahead.depth = 1;
+    if (s->readahead.depth_max && (readahead_resume(s) != 0)) readahead_drop(s);
+  }
+  return impl_sz;
+}
+// Move the stream on the server. Status is set to 'err_no'
+// Return value: on success returns the new position on the server, otherwise -1
+static int64_t seek_remote(rxs_session_t* s, RXS_HANDLE stream, int64_t offset, int whence, int* err_no) {
+  if (rxs_send_packet_x06(get_socket_connected(s), CS_A0, operation_fseek, stream, (uint64_t)offset,
+                          (uint32_t)whence) < 0) {
+    *err_no = errno;
+    return -1;
+  }
+  rxs_type_t type = SC_B1;
+  uint32_t other_side_stream = 0;
+  uint64_t position = 0;
+  uint32_t other_side_errno = 0;
+  if ((rxs_recv_packet_x06(get_socket_connected(s), &type, operation_fseek, &other_side_stream, &position,
+                           &other_side_errno) < 0) ||
+      (other_side_stream != stream)) {
+    *err_no = (errno) ? (errno) : (EIO);
+    return -1;
+  }
+  if (SC_B0 != type) {
+    *err_no = RXS_SRV_NONE + ((other_side_errno) ? (other_side_errno) : (EIO));
+    return -1;
+  }
+  return (int64_t)position;
+}
+// The server is ahead of the application by the cache of readahead: before a write the cache of the stream is dropped
+// and the server is moved back to the position of the application. Status is set to 'err_no'
+// Return value: on success returns 0, otherwise -1
+static int readahead_discard(rxs_session_t* s, RXS_HANDLE stream, int* err_no) {
+  if (s->readahead.stream != stream) return 0;
+
+  readahead_pause(s);
+  uint64_t cached_sz = readahead_cached(s);
+  readahead_drop(s);
+  if (!cached_sz) return 0;
+  return (seek_remote(s, stream, -(int64_t)cached_sz, SEEK_CUR, err_no) < 0) ? (-1) : (0);
+}
+// Write data to the stream of other side. Status is set to 'err_no'
+static size_t fwrite_remote(rxs_session_t* s, const void* buf, size_t buf_sz, RXS_HANDLE stream, int64_t offset,
+                            int* err_no) {
+  if ((offset < 0) && (readahead_discard(s, stream, err_no) != 0)) {
+    // Set errno
+    if (!*err_no) *err_no = EIO;
+    return 0;
+  }
+  //////////////////////////////////////////////////////////////////////////////////
+  // Send to other side size of transmitted data (and the position of positioned write)
+  //////////////////////////////////////////////////////////////////////////////////
+  rxs_operation_t operation = (offset < 0) ? (operation_fwrite) : (operation_pwrite);
+  ssize_t res = (offset < 0) ? (rxs_send_packet_x04(get_socket_connected(s), CS_A0, operation, stream, buf_sz, 0))
+                             : (rxs_send_packet_x06(get_socket_connected(s), CS_A0, operation, stream,
+                                                    (uint64_t)offset, buf_sz));
+  if (res < 0) {
     // Set errno
-    if (!errno_both_sides) errno_both_sides = EIO;
+    if (!*err_no) *err_no = EIO;
     // log_msg(ERRN, 6, "rxs_send_packet_x04_1", strerror(errno));
     return 0;
   }
-  size_t data_sz = ((have_encoder > 0) ? (crypt_packet_sz()) : (crypt_data_sz()));
+  size_t data_sz = ((s->have_encoder > 0) ? (crypt_packet_sz()) : (crypt_data_sz()));
   uint8_t* buf_send = calloc(data_sz, sizeof(uint8_t));
   if (!buf_send) {
     // Set errno
-    errno_both_sides = EINVAL;
+    *err_no = EINVAL;
     log_msg(ERRN, 6, "calloc", strerror(errno));
     return 0;
   }
   size_t total_impl_sz = 0;
   // Set errno
-  errno_both_sides = 0;
+  *err_no = 0;
   while (total_impl_sz < buf_sz) {
     size_t data_regular_sz = portion_sz(buf_sz, total_impl_sz);
-    uint16_t buf_send_sz = compose_data(have_encoder, buf, buf_send, data_sz, total_impl_sz, data_regular_sz);
+    uint16_t buf_send_sz = compose_data(s->have_encoder, buf, buf_send, data_sz, total_impl_sz, data_regular_sz);
     if (0 == buf_send_sz) {
       // Free memory
       free(buf_send);
       buf_send = NULL;
       // Set errno
-      if (!errno_both_sides) errno_both_sides = EIO;
+      if (!*err_no) *err_no = EIO;
       log_msg(ERRN, 6, "compose_data", strerror(errno));
       return 0;
     }
-    ssize_t impl_channel_sz = rxs_send_x(get_socket_data_client(), buf_send, buf_send_sz);
+    ssize_t impl_channel_sz = rxs_send_x(get_socket_data_client(s, stream), buf_send, buf_send_sz);
     if ((uint16_t)impl_channel_sz != buf_send_sz) {
       // Free memory
       free(buf_send);
       buf_send = NULL;
       // Set errno
-      if (!errno_both_sides) errno_both_sides = EIO;
+      if (!*err_no) *err_no = EIO;
       log_msg(ERRN, 6, "rxs_send_x", strerror(errno));
       return 0;
     }
     total_impl_sz += data_regular_sz;
+    take_rate_limit(s, buf_send_sz);
   }
   // Free memory
   free(buf_send);
@@ -776,108 +1816,1705 @@ size_t rxs_fwrite(const void* buf, size_t size, size_t count, RXS_HANDLE stream)
   uint32_t other_side_stream = 0;
   uint32_t other_side_data_sz = 0;
   uint16_t other_side_eof = 0;
-  ssize_t res = rxs_recv_packet_x04(get_socket_connected(), &type, operation_fwrite, &other_side_stream,
-                                    &other_side_data_sz, &other_side_eof);
+  res = rxs_recv_packet_x04(get_socket_connected(s), &type, operation, &other_side_stream, &other_side_data_sz,
+                            &other_side_eof);
   if ((res < 0) || (type == SC_B1) || (other_side_stream != stream) || (total_impl_sz != other_side_data_sz)) {
     // Set errno
-    if (!errno_both_sides) errno_both_sides = EIO;
+    if (!*err_no) *err_no = EIO;
     // log_msg(ERRN, 6, "rxs_recv_packet_x04", strerror(errno));
     return 0;
   }
   return total_impl_sz;
 }
-int rxs_fflush(RXS_HANDLE stream) {
+size_t rxs_session_fwrite(rxs_session_t* s, const void* buf, size_t size, size_t count, RXS_HANDLE stream) {
+  pause_background(s);
+  meta_cache_clear(s, 0);
+  size_t buf_sz = size * count;
+  if (get_socket_data_client(s, stream) < 0) {
+    s->errno_both_sides = EINVAL;
+    return -1;
+  }
+  if (0 == buf_sz) {
+    // Set errno
+    s->errno_both_sides = EINVAL;
+    log_msg(ERRN, 52, buf_sz);
+    return 0;
+  }
+  if (buf_sz > LONG_MAX) {
+    // Set errno
+    s->errno_both_sides = EINVAL;
+    log_msg(ERRN, 50, buf_sz, LONG_MAX);
+    return 0;
+  }
+  //////////////////////////////////////////////////////////////////////////////////
+  // Write-back buffer of the stream
+  //////////////////////////////////////////////////////////////////////////////////
+  write_back_t* wb = find_write_back(s, stream);
+  if (wb) {
+    if ((wb->len + buf_sz) > wb->buf_sz) {
+      if (flush_write_back(s, wb) != 0) return 0;
+    }
+    if (buf_sz < wb->buf_sz) {
+      if (!wb->len) clock_gettime(CLOCK_MONOTONIC, &wb->since);
+      memcpy(wb->buf + wb->len, buf, buf_sz);
+      wb->len += buf_sz;
+      s->errno_both_sides = 0;
+      // Buffer is full or the data are kept too long
+      if ((wb->len == wb->buf_sz) || write_back_expired(wb)) {
+        if (flush_write_back(s, wb) != 0) return 0;
+      }
+      return buf_sz;
+    }
+  }
+  return fwrite_remote(s, buf, buf_sz, stream, RXS_OFFSET_CURRENT, &s->errno_both_sides);
+}
+//////////////////////////////////////////////////////////////////////////////////
+// Positioned read/write: one request moves the stream to 'offset' and transfers data. Large transfers are split by
+// portions (size of data in the request is 32-bit). The server sends whole blocks only, so the tail of a read shorter
+// than a block is received to the block buffer.
+//////////////////////////////////////////////////////////////////////////////////
+#define POSITIONED_PORTION_MAX (1024 * 1024 * 1024)
+
+// Checks of positioned read/write, the background users of the connection are stopped
+// Return value: on success returns 0, otherwise -1 and 's->errno_both_sides' is set
+static int positioned_prepare(rxs_session_t* s, const void* buf, size_t buf_sz, RXS_HANDLE stream, uint64_t offset) {
+  pause_background(s);
+  if (!buf || (offset > INT64_MAX) || (get_socket_data_client(s, stream) < 0)) {
+    s->errno_both_sides = EINVAL;
+    return -1;
+  }
+  // Set errno
+  s->errno_both_sides = 0;
+  if (0 == buf_sz) {
+    s->errno_both_sides = EINVAL;
+    log_msg(ERRN, 52, buf_sz);
+    return -1;
+  }
+  if ((buf_sz > LONG_MAX) || ((INT64_MAX - offset) < buf_sz)) {
+    s->errno_both_sides = EINVAL;
+    log_msg(ERRN, 50, buf_sz, LONG_MAX);
+    return -1;
+  }
+  if (flush_write_back(s, find_write_back(s, stream)) != 0) return -1;
+  // The cache of the stream is not valid after the position is changed
+  if (s->readahead.stream == stream) readahead_drop(s);
+  return 0;
+}
+size_t rxs_session_pread(rxs_session_t* s, void* buf, size_t size, size_t count, RXS_HANDLE stream, uint64_t offset) {
+  size_t buf_sz = size * count;
+  if (positioned_prepare(s, buf, buf_sz, stream, offset) != 0) return 0;
+
+  size_t block_sz = ((s->have_encoder > 0) ? (crypt_packet_sz()) : (crypt_data_sz()));
+  size_t total_sz = 0;
+  while (total_sz < buf_sz) {
+    size_t sz = ((buf_sz - total_sz) > POSITIONED_PORTION_MAX) ? (POSITIONED_PORTION_MAX) : (buf_sz - total_sz);
+    if (sz < block_sz) {
+      uint8_t* block = (uint8_t*)malloc(block_sz);
+      if (!block) {
+        log_msg(ERRN, 44, block_sz);
+        s->errno_both_sides = ENOMEM;
+        break;
+      }
+      size_t impl_sz = fread_remote(s, block, block_sz, stream, offset + total_sz, &s->errno_both_sides);
+      if (impl_sz > sz) impl_sz = sz;
+      memcpy((uint8_t*)buf + total_sz, block, impl_sz);
+      free(block);
+      total_sz += impl_sz;
+      break;
+    }
+    size_t impl_sz = fread_remote(s, (uint8_t*)buf + total_sz, sz, stream, offset + total_sz, &s->errno_both_sides);
+    total_sz += impl_sz;
+    // Short portion without error is a whole number of blocks, the rest is read by the next request
+    if (!impl_sz || s->errno_both_sides) break;
+  }
+  // End of file is not reached if all requested data are read behind it
+  if ((total_sz == buf_sz) && (RXS_EOF == s->errno_both_sides)) s->errno_both_sides = 0;
+  return total_sz;
+}
+size_t rxs_session_pwrite(rxs_session_t* s, const void* buf, size_t size, size_t count, RXS_HANDLE stream,
+                          uint64_t offset) {
+  size_t buf_sz = size * count;
+  if (positioned_prepare(s, buf, buf_sz, stream, offset) != 0) return 0;
+  meta_cache_clear(s, 0);
+
+  size_t total_sz = 0;
+  while (total_sz < buf_sz) {
+    size_t sz = ((buf_sz - total_sz) > POSITIONED_PORTION_MAX) ? (POSITIONED_PORTION_MAX) : (buf_sz - total_sz);
+    size_t impl_sz =
+        fwrite_remote(s, (const uint8_t*)buf + total_sz, sz, stream, offset + total_sz, &s->errno_both_sides);
+    total_sz += impl_sz;
+    if (impl_sz != sz) break;
+  }
+  return total_sz;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// Vectored read
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// Read the ranges by one request, other side sends them back to back. Lengths of the ranges are cut by the end of file.
+// Return value: number of received bytes
+static size_t preadv_remote(rxs_session_t* s, uint8_t* buf, size_t buf_sz, rxs_range_t* ranges, uint32_t ranges_cnt,
+                            RXS_HANDLE stream, int* err_no) {
+  data_channel_t* channel = find_data_channel(s, stream);
+  if (!channel || (channel->sockfd_client < 0)) {
+    *err_no = EINVAL;
+    return 0;
+  }
+  data_receiver_t* rcv = &channel->receiver;
+  if (rxs_send_packet_x07(get_socket_connected(s), CS_A0, operation_preadv, stream, 0, ranges, ranges_cnt) < 0) {
+    if (!*err_no) *err_no = EIO;
+    return 0;
+  }
+  //////////////////////////////////////////////////////////////////////////////////
+  // Post the job to data receiver thread
+  //////////////////////////////////////////////////////////////////////////////////
+  data_exchange_t data_exchange;
+  memset(&data_exchange, 0, sizeof(data_exchange));
+  data_exchange.sockfd = channel->sockfd_client;
+  data_exchange.stream = stream;
+  data_exchange.buf = buf;
+  data_exchange.buf_sz = buf_sz;
+  data_exchange.channel_sz = buf_sz;
+
+  if (start_data_receiver(rcv) != 0) {
+    log_msg(ERRN, 6, "pthread_create", strerror(errno));
+    return 0;
+  }
+  pthread_mutex_lock(&rcv->mutex);
+  rcv->job = &data_exchange;
+  pthread_cond_broadcast(&rcv->cond);
+  pthread_mutex_unlock(&rcv->mutex);
+  //////////////////////////////////////////////////////////////////////////////////
+  // Other side reports the sizes of the ranges are sent to the channel
+  //////////////////////////////////////////////////////////////////////////////////
+  rxs_type_t type;
+  uint32_t other_side_stream = 0;
+  uint32_t other_side_errno = 0;
+  uint32_t other_side_ranges_cnt = 0;
+  uint64_t* rqst_len = (uint64_t*)malloc(ranges_cnt * sizeof(uint64_t));
+  if (!rqst_len) {
+    log_msg(ERRN, 44, ranges_cnt * sizeof(uint64_t));
+    *err_no = ENOMEM;
+    wait_data_receiver(rcv, &data_exchange, 0);
+    return 0;
+  }
+  for (uint32_t i = 0; i < ranges_cnt; i++) rqst_len[i] = ranges[i].len;
+  ssize_t res = rxs_recv_packet_x07(get_socket_connected(s), &type, operation_preadv, &other_side_stream,
+                                    &other_side_errno, ranges, ranges_cnt, &other_side_ranges_cnt);
+  if ((res >= 0) && (SC_B1 == type)) *err_no = RXS_SRV_NONE + (int)other_side_errno;
+  size_t channel_sz = 0;
+  uint8_t valid = ((res >= 0) && (SC_B0 == type) && (stream == other_side_stream) &&
+                   (ranges_cnt == other_side_ranges_cnt));
+  for (uint32_t i = 0; valid && (i < ranges_cnt); i++) {
+    if (ranges[i].len > rqst_len[i]) valid = 0;
+    channel_sz += (size_t)ranges[i].len;
+  }
+  // Free memory
+  free(rqst_len);
+  if (!valid) {
+    if (!*err_no) *err_no = EIO;
+    // Cancel the job
+    wait_data_receiver(rcv, &data_exchange, 0);
+    return 0;
+  }
+  wait_data_receiver(rcv, &data_exchange, channel_sz);
+  if (data_exchange.total_impl_sz != channel_sz) {
+    *err_no = EIO;
+    return 0;
+  }
+  return data_exchange.total_impl_sz;
+}
+// Encrypted data channel moves whole blocks only: the ranges are read one by one, the position is restored
+static size_t preadv_by_pread(rxs_session_t* s, const struct iovec* iov, int iovcnt, const uint64_t* offsets,
+                              RXS_HANDLE stream) {
+  int64_t position = rxs_session_ftello(s, stream);
+  if (position < 0) return 0;
+
+  size_t total_sz = 0;
+  int err_no = 0;
+  for (int i = 0; (i < iovcnt) && (!err_no || (RXS_EOF == err_no)); i++) {
+    if (0 == iov[i].iov_len) continue;
+    size_t impl_sz = rxs_session_pread(s, iov[i].iov_base, 1, iov[i].iov_len, stream, offsets[i]);
+    memset((uint8_t*)iov[i].iov_base + impl_sz, 0, iov[i].iov_len - impl_sz);
+    total_sz += impl_sz;
+    if (s->errno_both_sides) err_no = s->errno_both_sides;
+  }
+  if ((rxs_session_fseeko(s, stream, position, SEEK_SET) != 0) && !err_no) err_no = s->errno_both_sides;
+  s->errno_both_sides = err_no;
+  return total_sz;
+}
+size_t rxs_session_preadv(rxs_session_t* s, const struct iovec* iov, int iovcnt, const uint64_t* offsets,
+                          RXS_HANDLE stream) {
+  pause_background(s);
+  if (!iov || !offsets || (iovcnt <= 0) || (get_socket_data_client(s, stream) < 0)) {
+    s->errno_both_sides = EINVAL;
+    return 0;
+  }
+  // Set errno
+  s->errno_both_sides = 0;
+  for (int i = 0; i < iovcnt; i++) {
+    if ((iov[i].iov_len && !iov[i].iov_base) || (offsets[i] > INT64_MAX) ||
+        ((INT64_MAX - offsets[i]) < iov[i].iov_len)) {
+      s->errno_both_sides = EINVAL;
+      return 0;
+    }
+  }
+  // The position of the stream is not changed, so the cache of the stream is kept
+  if (flush_write_back(s, find_write_back(s, stream)) != 0) return 0;
+  if (s->have_encoder > 0) return preadv_by_pread(s, iov, iovcnt, offsets, stream);
+
+  rxs_range_t* ranges = (rxs_range_t*)malloc(RXS_PREADV_RANGES_MAX * sizeof(rxs_range_t));
+  if (!ranges) {
+    log_msg(ERRN, 44, RXS_PREADV_RANGES_MAX * sizeof(rxs_range_t));
+    s->errno_both_sides = ENOMEM;
+    return 0;
+  }
+  uint8_t* buf = NULL;
+  size_t total_sz = 0;
+  uint8_t eof = 0;
+  int i = 0;
+  size_t iov_pos = 0;
+  while ((i < iovcnt) && !s->errno_both_sides) {
+    //////////////////////////////////////////////////////////////////////////////////
+    // Batch of the ranges, large vectors are split
+    //////////////////////////////////////////////////////////////////////////////////
+    int batch_i = i;
+    size_t batch_iov_pos = iov_pos;
+    uint32_t ranges_cnt = 0;
+    size_t batch_sz = 0;
+    while ((i < iovcnt) && (ranges_cnt < RXS_PREADV_RANGES_MAX) && (batch_sz < RXS_PREADV_BATCH_SZ_MAX)) {
+      size_t sz = iov[i].iov_len - iov_pos;
+      if (sz > (RXS_PREADV_BATCH_SZ_MAX - batch_sz)) sz = RXS_PREADV_BATCH_SZ_MAX - batch_sz;
+      if (sz) {
+        ranges[ranges_cnt].offset = offsets[i] + iov_pos;
+        ranges[ranges_cnt].len = sz;
+        ranges_cnt++;
+        batch_sz += sz;
+        iov_pos += sz;
+      }
+      if (iov_pos == iov[i].iov_len) {
+        i++;
+        iov_pos = 0;
+      }
+    }
+    if (!ranges_cnt) break;
+    if (!buf) buf = (uint8_t*)malloc(RXS_PREADV_BATCH_SZ_MAX);
+    if (!buf) {
+      log_msg(ERRN, 44, RXS_PREADV_BATCH_SZ_MAX);
+      s->errno_both_sides = ENOMEM;
+      break;
+    }
+    size_t impl_sz = preadv_remote(s, buf, batch_sz, ranges, ranges_cnt, stream, &s->errno_both_sides);
+    if (s->errno_both_sides) break;
+    //////////////////////////////////////////////////////////////////////////////////
+    // Scatter the data to the vector, the rest behind the end of file is filled by zeros
+    //////////////////////////////////////////////////////////////////////////////////
+    uint8_t* data = buf;
+    size_t rqst_pos = 0;
+    for (uint32_t j = 0; j < ranges_cnt; j++) {
+      while ((iov[batch_i].iov_len - batch_iov_pos) == 0) {
+        batch_i++;
+        batch_iov_pos = 0;
+      }
+      size_t sz = iov[batch_i].iov_len - batch_iov_pos;
+      if (sz > (RXS_PREADV_BATCH_SZ_MAX - rqst_pos)) sz = RXS_PREADV_BATCH_SZ_MAX - rqst_pos;
+      uint8_t* dst = (uint8_t*)iov[batch_i].iov_base + batch_iov_pos;
+      memcpy(dst, data, (size_t)ranges[j].len);
+      memset(dst + ranges[j].len, 0, sz - (size_t)ranges[j].len);
+      if (ranges[j].len < sz) eof = 1;
+      data += ranges[j].len;
+      batch_iov_pos += sz;
+      rqst_pos += sz;
+    }
+    total_sz += impl_sz;
+  }
+  // Free memory
+  free(buf);
+  free(ranges);
+  if (eof && !s->errno_both_sides) s->errno_both_sides = RXS_EOF;
+  return total_sz;
+}
+int rxs_session_fflush(rxs_session_t* s, RXS_HANDLE stream) {
+  pause_background(s);
+  meta_cache_clear(s, 0);
   // Set errno
-  errno_both_sides = 0;
-  ssize_t res = rqst_x00_resp_x00(get_socket_connected(), CS_A0, operation_fflush, stream, NULL, 0, &errno_both_sides);
+  s->errno_both_sides = 0;
+  if (flush_write_back(s, find_write_back(s, stream)) != 0) return -1;
+  ssize_t res =
+      rqst_x00_resp_x00(get_socket_connected(s), CS_A0, operation_fflush, stream, NULL, 0, &s->errno_both_sides);
   // Set errno
-  if (errno_both_sides) errno_both_sides = RXS_SRV_NONE + errno_both_sides;
+  if (s->errno_both_sides) s->errno_both_sides = RXS_SRV_NONE + s->errno_both_sides;
   if (res < 0) {
     // Set errno
-    if (!errno_both_sides) errno_both_sides = errno;
+    if (!s->errno_both_sides) s->errno_both_sides = errno;
     // log_msg(ERRN, 6, "rqst_x00_resp_x00", strerror(errno));
     return -1;
   }
 
-  return (!errno_both_sides) ? (0) : (-1);
+  return (!s->errno_both_sides) ? (0) : (-1);
 }
-int rxs_fclose(RXS_HANDLE stream) {
+int rxs_session_fclose(rxs_session_t* s, RXS_HANDLE stream) {
+  async_drain(s);
+  meta_cache_clear(s, 0);
   // Set errno
-  errno_both_sides = 0;
-  rxs_data_point_close();
-  ssize_t res = rqst_x00_resp_x00(get_socket_connected(), CS_A0, operation_fclose, stream, NULL, 0, &errno_both_sides);
+  s->errno_both_sides = 0;
+  //////////////////////////////////////////////////////////////////////////////////
+  // Send buffered data, error of the sending is reported after close
+  //////////////////////////////////////////////////////////////////////////////////
+  int err_no = 0;
+  write_back_t* wb = find_write_back(s, stream);
+  if (wb) {
+    if (flush_write_back(s, wb) != 0) err_no = s->errno_both_sides;
+    free_write_back(wb);
+    s->errno_both_sides = 0;
+  }
+  rxs_data_point_close(s, stream);
+  ssize_t res =
+      rqst_x00_resp_x00(get_socket_connected(s), CS_A0, operation_fclose, stream, NULL, 0, &s->errno_both_sides);
   // Set errno
-  if (errno_both_sides) errno_both_sides = RXS_SRV_NONE + errno_both_sides;
+  if (s->errno_both_sides) s->errno_both_sides = RXS_SRV_NONE + s->errno_both_sides;
   if (res < 0) {
     // Set errno
-    if (!errno_both_sides) errno_both_sides = errno;
+    if (!s->errno_both_sides) s->errno_both_sides = errno;
     // log_msg(ERRN, 6, "rqst_x00_resp_x00", strerror(errno));
     return -1;
   }
-  return (!errno_both_sides) ? (0) : (-1);
+  if (!s->errno_both_sides) s->errno_both_sides = err_no;
+  return (!s->errno_both_sides) ? (0) : (-1);
 }
-int rxs_fseek(RXS_HANDLE stream, long offset, int whence) {
-  // Set errno
-  errno_both_sides = 0;
-  return -1;
-  /*
-  ssize_t res = rqst_x04_resp_x00(get_socket_connected(), CS_A0, operation_fseek, stream, offset, whence, NULL, 0,
-  NULL, 0, &errno_both_sides); if(res < 0) { log_msg(ERRN, 6, "rqst_x04_resp_x00", strerror(errno)); return -1;
+// Move the stream on the server. The position of the application is behind the cache of readahead, so the cache is
+// kept by 'ftell' only ('keep_cache') and the relative offset is corrected by the cached data.
+// Return value: on success returns the new position, otherwise -1 and 's->errno_both_sides' is set
+static int64_t session_seek(rxs_session_t* s, RXS_HANDLE stream, int64_t offset, int whence, uint8_t keep_cache) {
+  pause_background(s);
+  if (get_socket_data_client(s, stream) < 0) {
+    s->errno_both_sides = EINVAL;
+    return -1;
   }
-  return (!errno_both_sides)?(0):(-1);
-  */
-}
-long rxs_ftell(RXS_HANDLE stream) {
   // Set errno
-  errno_both_sides = 0;
-  return -1;
-  /*
-  ssize_t res = rqst_x00_resp_x00(get_socket_connected(), CS_A0, operation_ftell, stream, NULL, 0, &errno_both_sides);
-  if(res < 0) {
-      log_msg(ERRN, 6, "rqst_x00_resp_x00", strerror(errno));
-      return -1;
+  s->errno_both_sides = 0;
+  if (flush_write_back(s, find_write_back(s, stream)) != 0) return -1;
+  uint64_t cached_sz = (s->readahead.stream == stream) ? (readahead_cached(s)) : (0);
+  if (!keep_cache && (s->readahead.stream == stream)) {
+    if (SEEK_CUR == whence) offset -= (int64_t)cached_sz;
+    readahead_drop(s);
+    cached_sz = 0;
   }
-  return (!errno_both_sides)?((long)res):(-1);
-  */
+  int64_t position = seek_remote(s, stream, offset, whence, &s->errno_both_sides);
+  if (position < 0) return -1;
+  return position - (int64_t)cached_sz;
 }
-void rxs_rewind(RXS_HANDLE stream) {
-  // Set errno
-  errno_both_sides = 0;
-  return;
-  /*
-  ssize_t res = rqst_x00_resp_x00(get_socket_connected(), CS_A0, operation_rewind, stream, NULL, 0,
-  &errno_both_sides); if(res < 0) { log_msg(ERRN, 6, "rqst_x00_resp_x00", strerror(errno)); return ;
+int rxs_session_fseeko(rxs_session_t* s, RXS_HANDLE stream, int64_t offset, int whence) {
+  return (session_seek(s, stream, offset, whence, 0) < 0) ? (-1) : (0);
+}
+int64_t rxs_session_ftello(rxs_session_t* s, RXS_HANDLE stream) { return session_seek(s, stream, 0, SEEK_CUR, 1); }
+int rxs_session_fseek(rxs_session_t* s, RXS_HANDLE stream, long offset, int whence) {
+  return rxs_session_fseeko(s, stream, offset, whence);
+}
+long rxs_session_ftell(rxs_session_t* s, RXS_HANDLE stream) {
+  int64_t position = rxs_session_ftello(s, stream);
+  if (position > LONG_MAX) {
+    // Set errno
+    s->errno_both_sides = EOVERFLOW;
+    return -1;
   }
-  return;
-  */
+  return (long)position;
 }
-int rxs_file_exist(const char* path_name) {
+void rxs_session_rewind(rxs_session_t* s, RXS_HANDLE stream) { rxs_session_fseeko(s, stream, 0, SEEK_SET); }
+int rxs_session_file_exist(rxs_session_t* s, const char* path_name) {
+  pause_background(s);
   // Set errno
-  errno_both_sides = 0;
-  ssize_t res = rqst_x01_resp_x00(get_socket_connected(), CS_A0, operation_file_exist, path_name, strlen(path_name),
-                                  NULL, 0, &errno_both_sides);
+  s->errno_both_sides = 0;
+  long val = -1;
+  if (meta_cache_get(s, meta_file_exist, path_name, &val)) return (int)val;
+  ssize_t res = rqst_x01_resp_x00(get_socket_connected(s), CS_A0, operation_file_exist, path_name, strlen(path_name),
+                                  NULL, 0, &s->errno_both_sides);
   // Set errno
-  if (errno_both_sides) errno_both_sides = RXS_SRV_NONE + errno_both_sides;
+  if (s->errno_both_sides) s->errno_both_sides = RXS_SRV_NONE + s->errno_both_sides;
   if (res < 0) {
     // Set errno
-    if (!errno_both_sides) errno_both_sides = errno;
+    if (!s->errno_both_sides) s->errno_both_sides = errno;
     // log_msg(ERRN, 6, "rqst_x01_resp_x00", strerror(errno));
+    // Negative answer of other side (e.g. the path does not exist)
+    if (s->errno_both_sides >= RXS_SRV_NONE) meta_cache_put(s, meta_file_exist, path_name, -1);
     return -1;
   }
-  return (!errno_both_sides) ? (res) : (-1);
+  val = (!s->errno_both_sides) ? (res) : (-1);
+  meta_cache_put(s, meta_file_exist, path_name, val);
+  return (int)val;
 }
-int rxs_dir_exist(const char* path_name) {
+int rxs_session_dir_exist(rxs_session_t* s, const char* path_name) {
+  pause_background(s);
   // Set errno
-  errno_both_sides = 0;
-  ssize_t res = rqst_x01_resp_x00(get_socket_connected(), CS_A0, operation_dir_exist, path_name, strlen(path_name),
-                                  NULL, 0, &errno_both_sides);
+  s->errno_both_sides = 0;
+  long val = -1;
+  if (meta_cache_get(s, meta_dir_exist, path_name, &val)) return (int)val;
+  ssize_t res = rqst_x01_resp_x00(get_socket_connected(s), CS_A0, operation_dir_exist, path_name, strlen(path_name),
+                                  NULL, 0, &s->errno_both_sides);
   // Set errno
-  if (errno_both_sides) errno_both_sides = RXS_SRV_NONE + errno_both_sides;
+  if (s->errno_both_sides) s->errno_both_sides = RXS_SRV_NONE + s->errno_both_sides;
   if (res < 0) {
     // Set errno
-    if (!errno_both_sides) errno_both_sides = errno;
+    if (!s->errno_both_sides) s->errno_both_sides = errno;
     // log_msg(ERRN, 6, "rqst_x01_resp_x00", strerror(errno));
+    // Negative answer of other side (e.g. the path does not exist)
+    if (s->errno_both_sides >= RXS_SRV_NONE) meta_cache_put(s, meta_dir_exist, path_name, -1);
+    return -1;
+  }
+  val = (!s->errno_both_sides) ? (res) : (-1);
+  meta_cache_put(s, meta_dir_exist, path_name, val);
+  return (int)val;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// Sessions
+//////////////////////////////////////////////////////////////////////////////////////////////////
+rxs_session_t* rxs_session_open(const char* host_p, uint16_t port_h, const char* username, const char* password,
+                                int encoder) {
+  rxs_session_t* s = (rxs_session_t*)calloc(1, sizeof(rxs_session_t));
+  if (!s) {
+    log_msg(ERRN, 44, sizeof(rxs_session_t));
+    return NULL;
+  }
+  init_rxs_session_t(s);
+  if (session_point_create(s, host_p, port_h, username, password, encoder) != 0) {
+    int err_no = (s->errno_both_sides) ? (s->errno_both_sides) : (EINVAL);
+    dinit_rxs_session_t(s);
+    free(s);
+    errno = err_no;
+    return NULL;
+  }
+  return s;
+}
+void rxs_session_close(rxs_session_t* s) {
+  if (!s) return;
+  session_point_close(s);
+  dinit_rxs_session_t(s);
+  free(s);
+}
+size_t rxs_session_connected(rxs_session_t* s) { return session_point_connected(s); }
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// Connection pool: authenticated sessions are kept for reuse, the key is host, port and user
+//////////////////////////////////////////////////////////////////////////////////////////////////
+#define POOL_SESSIONS_MAX 64
+#define POOL_IDLE_MSEC (60 * 1000)
+#define POOL_MAX_AGE_MSEC (10 * 60 * 1000)
+#define POOL_PING_AFTER_MSEC 1000  // Sessions are idle longer are checked by ping before reuse
+#define POOL_HOST_SZ 256
+#define POOL_USER_SZ 256
+
+typedef struct pool_entry_t {
+  rxs_session_t* s;  // NULL - entry is free
+  char host[POOL_HOST_SZ];
+  uint16_t port;
+  char user[POOL_USER_SZ];
+  char pass[POOL_USER_SZ];
+  int encoder;
+  uint64_t created_msec;
+  uint64_t used_msec;
+  uint8_t busy;  // Session is handed out
+} pool_entry_t;
+
+typedef struct pool_t {
+  pthread_mutex_t mutex;
+  pool_entry_t entries[POOL_SESSIONS_MAX];
+  uint32_t idle_msec;
+  uint32_t max_age_msec;
+  uint64_t hits;
+  uint64_t misses;
+  rate_limit_t rate_limit;  // Shared by all sessions handed out by the pool
+} pool_t;
+
+static pool_t pool = {.mutex = PTHREAD_MUTEX_INITIALIZER,
+                      .idle_msec = POOL_IDLE_MSEC,
+                      .max_age_msec = POOL_MAX_AGE_MSEC,
+                      .rate_limit = {.mutex = PTHREAD_MUTEX_INITIALIZER}};
+
+static void free_pool_entry(pool_entry_t* entry) {
+  memset(entry->pass, 0, sizeof(entry->pass));
+  memset(entry, 0, sizeof(pool_entry_t));
+}
+static int pool_entry_expired(pool_entry_t* entry, uint64_t now_msec) {
+  if (pool.max_age_msec && ((now_msec - entry->created_msec) >= pool.max_age_msec)) return 1;
+  if (pool.idle_msec && ((now_msec - entry->used_msec) >= pool.idle_msec)) return 1;
+  return 0;
+}
+// Take idle sessions are expired from the pool. Lock of the pool is required
+static size_t pool_take_expired(rxs_session_t** expired, size_t expired_max, uint64_t now_msec) {
+  size_t cnt = 0;
+  for (uint32_t i = 0; (i < POOL_SESSIONS_MAX) && (cnt < expired_max); i++) {
+    pool_entry_t* entry = &pool.entries[i];
+    if (!entry->s || entry->busy || !pool_entry_expired(entry, now_msec)) continue;
+    expired[cnt++] = entry->s;
+    free_pool_entry(entry);
+  }
+  return cnt;
+}
+static void close_sessions(rxs_session_t** sessions, size_t cnt) {
+  for (size_t i = 0; i < cnt; i++) rxs_session_close(sessions[i]);
+}
+// Return value: 1 - session can be reused, otherwise 0
+static int pool_session_healthy(rxs_session_t* s, uint64_t idle_msec) {
+  if (!session_point_connected(s)) return 0;
+  if ((idle_msec >= POOL_PING_AFTER_MSEC) && (rxs_session_ping(s) != 0)) return 0;
+  return 1;
+}
+void rxs_pool_set_limits(uint32_t idle_sec, uint32_t max_age_sec) {
+  pthread_mutex_lock(&pool.mutex);
+  pool.idle_msec = idle_sec * 1000;
+  pool.max_age_msec = max_age_sec * 1000;
+  pthread_mutex_unlock(&pool.mutex);
+}
+int rxs_pool_set_rate_limit(uint64_t rate, uint64_t burst) {
+  return (set_rate_limit_t(&pool.rate_limit, rate, burst) == 0) ? (0) : (-1);
+}
+rxs_session_t* rxs_pool_get(const char* host_p, uint16_t port_h, const char* username, const char* password,
+                            int encoder) {
+  if (!host_p || !username || !password) {
+    errno = EINVAL;
+    return NULL;
+  }
+  for (;;) {
+    rxs_session_t* expired[POOL_SESSIONS_MAX];
+    pool_entry_t* found = NULL;
+    uint64_t now_msec = monotonic_msec();
+    pthread_mutex_lock(&pool.mutex);
+    size_t expired_cnt = pool_take_expired(expired, POOL_SESSIONS_MAX, now_msec);
+    for (uint32_t i = 0; i < POOL_SESSIONS_MAX; i++) {
+      pool_entry_t* entry = &pool.entries[i];
+      if (!entry->s || entry->busy || (entry->port != port_h) || (entry->encoder != encoder)) continue;
+      if (strcmp(entry->host, host_p) || strcmp(entry->user, username) || strcmp(entry->pass, password)) continue;
+      // The most recently used session is warmest
+      if (!found || (entry->used_msec > found->used_msec)) found = entry;
+    }
+    rxs_session_t* s = NULL;
+    uint64_t idle_msec = 0;
+    if (found) {
+      found->busy = 1;
+      s = found->s;
+      idle_msec = now_msec - found->used_msec;
+    }
+    pthread_mutex_unlock(&pool.mutex);
+    close_sessions(expired, expired_cnt);
+    if (!found) break;
+    //////////////////////////////////////////////////////////////////////////////////
+    // Health check out of the lock: the session is owned by the caller now
+    //////////////////////////////////////////////////////////////////////////////////
+    if (pool_session_healthy(s, idle_msec)) {
+      pthread_mutex_lock(&pool.mutex);
+      pool.hits++;
+      pthread_mutex_unlock(&pool.mutex);
+      s->errno_both_sides = 0;
+      s->rate_limit_pool = &pool.rate_limit;
+      return s;
+    }
+    pthread_mutex_lock(&pool.mutex);
+    free_pool_entry(found);
+    pthread_mutex_unlock(&pool.mutex);
+    rxs_session_close(s);
+  }
+  //////////////////////////////////////////////////////////////////////////////////
+  // New session
+  //////////////////////////////////////////////////////////////////////////////////
+  pthread_mutex_lock(&pool.mutex);
+  pool.misses++;
+  pthread_mutex_unlock(&pool.mutex);
+  rxs_session_t* s = rxs_session_open(host_p, port_h, username, password, encoder);
+  if (!s) return NULL;
+  s->rate_limit_pool = &pool.rate_limit;
+  if ((strlen(host_p) >= POOL_HOST_SZ) || (strlen(username) >= POOL_USER_SZ) || (strlen(password) >= POOL_USER_SZ))
+    return s;
+  uint64_t now_msec = monotonic_msec();
+  pthread_mutex_lock(&pool.mutex);
+  for (uint32_t i = 0; i < POOL_SESSIONS_MAX; i++) {
+    pool_entry_t* entry = &pool.entries[i];
+    if (entry->s) continue;
+    entry->s = s;
+    strcpy(entry->host, host_p);
+    entry->port = port_h;
+    strcpy(entry->user, username);
+    strcpy(entry->pass, password);
+    entry->encoder = encoder;
+    entry->created_msec = entry->used_msec = now_msec;
+    entry->busy = 1;
+    break;
+  }
+  // The pool is full: the session is closed by rxs_pool_put()
+  pthread_mutex_unlock(&pool.mutex);
+  return s;
+}
+void rxs_pool_put(rxs_session_t* s) {
+  if (!s) return;
+  //////////////////////////////////////////////////////////////////////////////////
+  // Streams are left open by the caller are closed, background work is stopped
+  //////////////////////////////////////////////////////////////////////////////////
+  for (uint32_t i = 0; i < DATA_CHANNELS_MAX; i++) {
+    if (s->data_channel_tbl[i].stream) rxs_session_fclose(s, s->data_channel_tbl[i].stream);
+  }
+  async_stop(s);
+  readahead_drop(s);
+  int healthy = session_point_connected(s) ? (1) : (0);
+
+  rxs_session_t* expired[POOL_SESSIONS_MAX];
+  uint64_t now_msec = monotonic_msec();
+  pthread_mutex_lock(&pool.mutex);
+  pool_entry_t* entry = NULL;
+  for (uint32_t i = 0; i < POOL_SESSIONS_MAX; i++) {
+    if (pool.entries[i].s == s) {
+      entry = &pool.entries[i];
+      break;
+    }
+  }
+  if (entry) {
+    entry->busy = 0;
+    entry->used_msec = now_msec;
+    if (!healthy || pool_entry_expired(entry, now_msec)) {
+      free_pool_entry(entry);
+      entry = NULL;
+    }
+  }
+  size_t expired_cnt = pool_take_expired(expired, POOL_SESSIONS_MAX, now_msec);
+  pthread_mutex_unlock(&pool.mutex);
+  close_sessions(expired, expired_cnt);
+  // Session is not kept by the pool
+  if (!entry) rxs_session_close(s);
+}
+void rxs_pool_clear() {
+  rxs_session_t* idle[POOL_SESSIONS_MAX];
+  size_t idle_cnt = 0;
+  pthread_mutex_lock(&pool.mutex);
+  for (uint32_t i = 0; i < POOL_SESSIONS_MAX; i++) {
+    pool_entry_t* entry = &pool.entries[i];
+    if (!entry->s || entry->busy) continue;
+    idle[idle_cnt++] = entry->s;
+    free_pool_entry(entry);
+  }
+  pthread_mutex_unlock(&pool.mutex);
+  close_sessions(idle, idle_cnt);
+}
+void rxs_pool_stat(uint64_t* hits, uint64_t* misses) {
+  pthread_mutex_lock(&pool.mutex);
+  if (hits) *hits = pool.hits;
+  if (misses) *misses = pool.misses;
+  pthread_mutex_unlock(&pool.mutex);
+}
+// Close a session is handed out by the pool without return to it (e.g. after an error of transfer)
+static void pool_drop(rxs_session_t* s) {
+  pthread_mutex_lock(&pool.mutex);
+  for (uint32_t i = 0; i < POOL_SESSIONS_MAX; i++) {
+    if (pool.entries[i].s == s) free_pool_entry(&pool.entries[i]);
+  }
+  pthread_mutex_unlock(&pool.mutex);
+  rxs_session_close(s);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// Striped transfer: ranges of one file are moved by positioned reads/writes over several sessions at once
+//////////////////////////////////////////////////////////////////////////////////////////////////
+#define STRIPE_SZ_MIN (1 * 1024 * 1024)  // Smaller files are moved by less stripes
+#define STRIPE_CHUNK_SZ (4 * 1024 * 1024)
+#define STRIPE_RETRIES_MAX 3  // A failed stripe is resumed on a new session
+
+typedef struct stripe_job_t {
+  const char* host_p;
+  uint16_t port_h;
+  const char* username;
+  const char* password;
+  int encoder;
+  const char* fname_remote;
+  int fd_local;
+  uint8_t is_put;
+  rxs_stripe_stat_t* stat;
+} stripe_job_t;
+
+// Return value: on success returns 0, otherwise -1 and errno is set appropriately
+static int pwrite_all(int fd, const uint8_t* buf, size_t buf_sz, off_t offset) {
+  size_t write_bytes = 0;
+  while (write_bytes < buf_sz) {
+    ssize_t res = pwrite(fd, buf + write_bytes, buf_sz - write_bytes, offset + write_bytes);
+    if (res < 0) {
+      if (EINTR == errno) continue;
+      return -1;
+    }
+    write_bytes += (size_t)res;
+  }
+  return 0;
+}
+// Move the rest of the stripe on a session of the pool
+// Return value: on success returns 0, otherwise error number
+static int stripe_transfer(stripe_job_t* job, uint8_t* buf, size_t buf_sz) {
+  rxs_stripe_stat_t* stat = job->stat;
+  rxs_session_t* s = rxs_pool_get(job->host_p, job->port_h, job->username, job->password, job->encoder);
+  if (!s) return (errno) ? (errno) : (EIO);
+  RXS_HANDLE stream = rxs_session_fopen(s, job->fname_remote, (job->is_put) ? ("r+b") : ("rb"));
+  if (!stream) {
+    int err_no = (rxs_session_errno(s)) ? (rxs_session_errno(s)) : (EIO);
+    pool_drop(s);
+    return err_no;
+  }
+  int err_no = 0;
+  while (!err_no && (stat->done < stat->len)) {
+    size_t sz = ((stat->len - stat->done) < buf_sz) ? ((size_t)(stat->len - stat->done)) : (buf_sz);
+    uint64_t offset = stat->offset + stat->done;
+    if (job->is_put) {
+      ssize_t res = pread(job->fd_local, buf, sz, (off_t)offset);
+      if (res != (ssize_t)sz) {
+        err_no = (res < 0) ? (errno) : (EIO);
+        break;
+      }
+      if (rxs_session_pwrite(s, buf, 1, sz, stream, offset) != sz) {
+        err_no = (s->errno_both_sides) ? (s->errno_both_sides) : (EIO);
+        break;
+      }
+    } else {
+      // Short read is the end of file: the remote file is truncated while it is read
+      if (rxs_session_pread(s, buf, 1, sz, stream, offset) != sz) {
+        err_no = (s->errno_both_sides && (s->errno_both_sides != RXS_EOF)) ? (s->errno_both_sides) : (EIO);
+        break;
+      }
+      if (pwrite_all(job->fd_local, buf, sz, (off_t)offset) != 0) {
+        err_no = errno;
+        break;
+      }
+    }
+    stat->done += sz;
+  }
+  //////////////////////////////////////////////////////////////////////////////////
+  // Written data are flushed by the close, so its error fails the stripe
+  //////////////////////////////////////////////////////////////////////////////////
+  if ((rxs_session_fclose(s, stream) != 0) && !err_no && job->is_put) {
+    err_no = (rxs_session_errno(s)) ? (rxs_session_errno(s)) : (EIO);
+    stat->done = 0;
+  }
+  if (err_no) {
+    pool_drop(s);
+  } else {
+    rxs_pool_put(s);
+  }
+  return err_no;
+}
+static void* stripe_thread(void* arg) {
+  stripe_job_t* job = (stripe_job_t*)arg;
+  rxs_stripe_stat_t* stat = job->stat;
+  size_t buf_sz = STRIPE_CHUNK_SZ;
+  uint8_t* buf = (uint8_t*)malloc(buf_sz);
+  if (!buf) {
+    log_msg(ERRN, 44, buf_sz);
+    stat->err_no = ENOMEM;
+    return NULL;
+  }
+  uint64_t start_msec = monotonic_msec();
+  for (;;) {
+    stat->err_no = stripe_transfer(job, buf, buf_sz);
+    if (!stat->err_no || (stat->retries >= STRIPE_RETRIES_MAX)) break;
+    stat->retries++;
+    log_msg(ERRN, 6, "stripe_transfer", strerror(stat->err_no));
+  }
+  stat->sec = (double)(monotonic_msec() - start_msec) / 1000.0;
+  free(buf);
+  return NULL;
+}
+// Split 'file_sz' between stripes and run them
+// Return value: on success returns number of stripes, otherwise -1 and errno is set appropriately
+static int stripes_run(stripe_job_t* proto, uint64_t file_sz, uint32_t stripes, rxs_stripe_stat_t* stat) {
+  if ((0 == stripes) || (stripes > RXS_STRIPES_MAX)) stripes = RXS_STRIPES_MAX;
+  if ((file_sz / stripes) < STRIPE_SZ_MIN) stripes = (uint32_t)(file_sz / STRIPE_SZ_MIN);
+  if (0 == stripes) stripes = 1;
+
+  stripe_job_t jobs[RXS_STRIPES_MAX];
+  pthread_t thrs[RXS_STRIPES_MAX];
+  uint64_t stripe_sz = file_sz / stripes;
+  for (uint32_t i = 0; i < stripes; i++) {
+    memset(&stat[i], 0, sizeof(rxs_stripe_stat_t));
+    stat[i].offset = stripe_sz * i;
+    // The last stripe takes the remainder
+    stat[i].len = (i + 1 < stripes) ? (stripe_sz) : (file_sz - stat[i].offset);
+    jobs[i] = *proto;
+    jobs[i].stat = &stat[i];
+  }
+  uint32_t started = 0;
+  for (; started < stripes; started++) {
+    int err_no = pthread_create(&thrs[started], NULL, stripe_thread, &jobs[started]);
+    if (err_no != 0) {
+      log_msg(ERRN, 6, "pthread_create", strerror(err_no));
+      stat[started].err_no = err_no;
+      break;
+    }
+  }
+  for (uint32_t i = 0; i < started; i++) pthread_join(thrs[i], NULL);
+
+  for (uint32_t i = 0; i < stripes; i++) {
+    if (stat[i].err_no || (stat[i].done != stat[i].len)) {
+      errno = (stat[i].err_no) ? (stat[i].err_no) : (EIO);
+      return -1;
+    }
+  }
+  return (int)stripes;
+}
+int rxs_get_striped(const char* host_p, uint16_t port_h, const char* username, const char* password, int encoder,
+                    const char* fname_local, const char* fname_remote, uint32_t stripes, rxs_stripe_stat_t* stat) {
+  if (!fname_local || !fname_remote || !stat) {
+    errno = EINVAL;
+    return -1;
+  }
+  rxs_session_t* s = rxs_pool_get(host_p, port_h, username, password, encoder);
+  if (!s) return -1;
+  long file_sz = rxs_session_filesize(s, fname_remote);
+  if (file_sz < 0) {
+    int err_no = (rxs_session_errno(s)) ? (rxs_session_errno(s)) : (EIO);
+    rxs_pool_put(s);
+    errno = err_no;
+    return -1;
+  }
+  rxs_pool_put(s);
+  //////////////////////////////////////////////////////////////////////////////////
+  // Local file has final size before the stripes are written at their offsets
+  //////////////////////////////////////////////////////////////////////////////////
+  int fd = open(fname_local, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) return -1;
+  if (ftruncate(fd, (off_t)file_sz) != 0) {
+    int err_no = errno;
+    close(fd);
+    errno = err_no;
+    return -1;
+  }
+  stripe_job_t proto = {.host_p = host_p,
+                        .port_h = port_h,
+                        .username = username,
+                        .password = password,
+                        .encoder = encoder,
+                        .fname_remote = fname_remote,
+                        .fd_local = fd,
+                        .is_put = 0};
+  int res = stripes_run(&proto, (uint64_t)file_sz, stripes, stat);
+  int err_no = errno;
+  if (close(fd) != 0) {
+    if (res >= 0) err_no = errno;
+    res = -1;
+  }
+  errno = err_no;
+  return res;
+}
+int rxs_put_striped(const char* host_p, uint16_t port_h, const char* username, const char* password, int encoder,
+                    const char* fname_local, const char* fname_remote, uint32_t stripes, rxs_stripe_stat_t* stat) {
+  if (!fname_local || !fname_remote || !stat) {
+    errno = EINVAL;
+    return -1;
+  }
+  int fd = open(fname_local, O_RDONLY);
+  if (fd < 0) return -1;
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    int err_no = errno;
+    close(fd);
+    errno = err_no;
+    return -1;
+  }
+  //////////////////////////////////////////////////////////////////////////////////
+  // Remote file is created (truncated) before the stripes are written at their offsets
+  //////////////////////////////////////////////////////////////////////////////////
+  rxs_session_t* s = rxs_pool_get(host_p, port_h, username, password, encoder);
+  if (!s) {
+    int err_no = errno;
+    close(fd);
+    errno = err_no;
+    return -1;
+  }
+  RXS_HANDLE stream = rxs_session_fopen(s, fname_remote, "wb");
+  if (!stream || (rxs_session_fclose(s, stream) != 0)) {
+    int err_no = (rxs_session_errno(s)) ? (rxs_session_errno(s)) : (EIO);
+    rxs_pool_put(s);
+    close(fd);
+    errno = err_no;
+    return -1;
+  }
+  rxs_pool_put(s);
+  stripe_job_t proto = {.host_p = host_p,
+                        .port_h = port_h,
+                        .username = username,
+                        .password = password,
+                        .encoder = encoder,
+                        .fname_remote = fname_remote,
+                        .fd_local = fd,
+                        .is_put = 1};
+  int res = stripes_run(&proto, (uint64_t)st.st_size, stripes, stat);
+  int err_no = errno;
+  close(fd);
+  errno = err_no;
+  return res;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// Mirror: manifests (size, mtime) of the source and destination trees are compared, new or changed files are moved by
+// the pool of worker sessions. The remote manifest is made by 'find' on the remote side.
+//////////////////////////////////////////////////////////////////////////////////////////////////
+#define MIRROR_CHUNK_SZ (4 * 1024 * 1024)
+#define MIRROR_RETRIES_MAX 2  // A failed file is moved again on a new session
+
+typedef struct mirror_entry_t {
+  char* path;  // Relative to the root of the tree
+  uint64_t size;
+  int64_t mtime;  // Seconds
+} mirror_entry_t;
+
+typedef struct mirror_manifest_t {
+  mirror_entry_t* entries;
+  size_t cnt;
+  size_t cnt_max;
+} mirror_manifest_t;
+
+// Files are taken by idle workers from the head of the queue, the queue is sorted by size (large files first)
+typedef struct mirror_queue_t {
+  pthread_mutex_t mutex;
+  const mirror_entry_t** jobs;
+  size_t cnt;
+  size_t next;
+  const char* host_p;
+  uint16_t port_h;
+  const char* username;
+  const char* password;
+  int encoder;
+  const char* dir_local;
+  const char* dir_remote;
+  uint8_t pull;
+  rxs_mirror_stat_t* stat;
+  int err_no;  // The first error
+} mirror_queue_t;
+
+static void dinit_mirror_manifest_t(mirror_manifest_t* manifest) {
+  for (size_t i = 0; i < manifest->cnt; i++) free(manifest->entries[i].path);
+  free(manifest->entries);
+  memset(manifest, 0, sizeof(mirror_manifest_t));
+}
+// Return value: on success returns 0, otherwise -1 and errno is set appropriately
+static int mirror_manifest_add(mirror_manifest_t* manifest, const char* path, uint64_t size, int64_t mtime) {
+  if (manifest->cnt == manifest->cnt_max) {
+    size_t cnt_max = (manifest->cnt_max) ? (manifest->cnt_max * 2) : (256);
+    mirror_entry_t* entries = (mirror_entry_t*)realloc(manifest->entries, cnt_max * sizeof(mirror_entry_t));
+    if (!entries) {
+      log_msg(ERRN, 44, cnt_max * sizeof(mirror_entry_t));
+      return -1;
+    }
+    manifest->entries = entries;
+    manifest->cnt_max = cnt_max;
+  }
+  mirror_entry_t* entry = &manifest->entries[manifest->cnt];
+  entry->path = strdup(path);
+  if (!entry->path) return -1;
+  entry->size = size;
+  entry->mtime = mtime;
+  manifest->cnt++;
+  return 0;
+}
+static int mirror_entry_cmp_path(const void* a, const void* b) {
+  return strcmp(((const mirror_entry_t*)a)->path, ((const mirror_entry_t*)b)->path);
+}
+static int mirror_job_cmp_size(const void* a, const void* b) {
+  uint64_t size_a = (*(const mirror_entry_t* const*)a)->size;
+  uint64_t size_b = (*(const mirror_entry_t* const*)b)->size;
+  return (size_a < size_b) ? (1) : ((size_a > size_b) ? (-1) : (0));
+}
+// Path of the tree item: 'root/rel' ('rel' for empty root)
+// Return value: on success returns 0, otherwise -1 and errno is set appropriately
+static int mirror_path(char* path, size_t path_sz, const char* root, const char* rel) {
+  int len = snprintf(path, path_sz, "%s%s%s", root, (*root && *rel) ? ("/") : (""), rel);
+  if ((len < 0) || ((size_t)len >= path_sz)) {
+    errno = ENAMETOOLONG;
+    return -1;
+  }
+  return 0;
+}
+// Walk the local tree, only regular files are taken (symbolic links are not followed)
+// Return value: on success returns 0, otherwise -1 and errno is set appropriately
+static int mirror_walk_local(const char* root, const char* rel, mirror_manifest_t* manifest) {
+  char path[PATH_MAX];
+  if (mirror_path(path, sizeof(path), root, rel) != 0) return -1;
+  DIR* dir = opendir(path);
+  if (!dir) return -1;
+
+  int res = 0;
+  struct dirent* entry = NULL;
+  while (!res && ((entry = readdir(dir)) != NULL)) {
+    if (!strcmp(entry->d_name, ".") || !strcmp(entry->d_name, "..")) continue;
+    char rel_child[PATH_MAX];
+    char path_child[PATH_MAX];
+    struct stat st;
+    if ((mirror_path(rel_child, sizeof(rel_child), rel, entry->d_name) != 0) ||
+        (mirror_path(path_child, sizeof(path_child), root, rel_child) != 0) || (lstat(path_child, &st) != 0)) {
+      res = -1;
+      break;
+    }
+    if (S_ISDIR(st.st_mode)) {
+      res = mirror_walk_local(root, rel_child, manifest);
+    } else if (S_ISREG(st.st_mode)) {
+      res = mirror_manifest_add(manifest, rel_child, (uint64_t)st.st_size, (int64_t)st.st_mtime);
+    }
+  }
+  int err_no = errno;
+  closedir(dir);
+  errno = err_no;
+  return res;
+}
+// The remote tree is listed by the command of remote side, records are separated by zero byte
+// Return value: on success returns 0, otherwise -1 and errno is set appropriately
+static int mirror_walk_remote(rxs_session_t* s, const char* root, uint8_t create, mirror_manifest_t* manifest) {
+  // CAUTION: the command is quoted by the remote side
+  if (strpbrk(root, "'\"$`\\")) {
+    errno = EINVAL;
+    return -1;
+  }
+  char cmd[PATH_MAX * 2 + 64];
+  if (create) {
+    snprintf(cmd, sizeof(cmd), "mkdir -p \"%s\" && find \"%s\" -type f -printf \"%%s %%T@ %%P\\0\"", root, root);
+  } else {
+    snprintf(cmd, sizeof(cmd), "find \"%s\" -type f -printf \"%%s %%T@ %%P\\0\"", root);
+  }
+  char path_file[PATH_MAX] = {0};
+  if (rxs_session_ls(s, cmd, path_file, sizeof(path_file)) != 0) {
+    errno = (rxs_session_errno(s)) ? (rxs_session_errno(s)) : (EIO);
+    return -1;
+  }
+  //////////////////////////////////////////////////////////////////////////////////
+  // Parse the output: 'size mtime path'
+  //////////////////////////////////////////////////////////////////////////////////
+  int fd = open(path_file, O_RDONLY);
+  struct stat st;
+  char* buf = NULL;
+  int res = -1;
+  if ((fd >= 0) && (fstat(fd, &st) == 0) && ((buf = (char*)malloc((size_t)st.st_size + 1)) != NULL)) {
+    size_t len = 0;
+    while (len < (size_t)st.st_size) {
+      ssize_t impl_bytes = read(fd, buf + len, (size_t)st.st_size - len);
+      if ((impl_bytes < 0) && (EINTR == errno)) continue;
+      if (impl_bytes <= 0) break;
+      len += (size_t)impl_bytes;
+    }
+    buf[len] = 0;
+    res = (len == (size_t)st.st_size) ? (0) : (-1);
+    for (char* rec = buf; !res && (rec < buf + len); rec += strlen(rec) + 1) {
+      char* p = NULL;
+      uint64_t size = strtoull(rec, &p, 10);
+      double mtime = strtod(p, &p);
+      if (' ' == *p) p++;
+      if (*p) res = mirror_manifest_add(manifest, p, size, (int64_t)mtime);
+    }
+  }
+  int err_no = errno;
+  free(buf);
+  if (fd >= 0) close(fd);
+  unlink(path_file);
+  errno = err_no;
+  return res;
+}
+// Move one file on the session by portions of MIRROR_CHUNK_SZ ('buf'), the pulled copy gets 'mtime' (if it is not
+// negative). The number of moved bytes is set to 'bytes', 'lost' is set if the failure is on the connection (neither
+// a local error nor an answer of other side), so the file can be moved again on other session.
+// Return value: on success returns 0, otherwise error number
+static int transfer_file(rxs_session_t* s, const char* path_local, const char* path_remote, uint8_t pull,
+                         int64_t mtime, uint8_t* buf, uint64_t* bytes, uint8_t* lost) {
+  *bytes = 0;
+  *lost = 0;
+  // The destination is opened after the source, so a missing source does not leave an empty copy
+  int fd = -1;
+  if (!pull && ((fd = open(path_local, O_RDONLY)) < 0)) return errno;
+  RXS_HANDLE stream = rxs_session_fopen(s, path_remote, (pull) ? ("rb") : ("wb"));
+  if (!stream) {
+    if (fd >= 0) close(fd);
+    int err_no = (rxs_session_errno(s)) ? (rxs_session_errno(s)) : (EIO);
+    *lost = ((err_no < RXS_SRV_NONE) || !session_point_connected(s)) ? (1) : (0);
+    return err_no;
+  }
+  if (pull && ((fd = open(path_local, O_WRONLY | O_CREAT | O_TRUNC, 0644)) < 0)) {
+    int err_no = errno;
+    rxs_session_fclose(s, stream);
+    return err_no;
+  }
+  int err_no = 0;
+  off_t offset = 0;
+  for (;;) {
+    if (pull) {
+      size_t sz = rxs_session_fread(s, buf, MIRROR_CHUNK_SZ, sizeof(uint8_t), stream);
+      int rxs_err_no = rxs_session_errno(s);
+      if (rxs_err_no && (rxs_err_no != RXS_EOF)) {
+        err_no = rxs_err_no;
+        *lost = (err_no < RXS_SRV_NONE) ? (1) : (0);
+        break;
+      }
+      if (pwrite_all(fd, buf, sz, offset) != 0) {
+        err_no = errno;
+        break;
+      }
+      offset += (off_t)sz;
+      *bytes += sz;
+      if (RXS_EOF == rxs_err_no) break;
+    } else {
+      ssize_t sz = read(fd, buf, MIRROR_CHUNK_SZ);
+      if ((sz < 0) && (EINTR == errno)) continue;
+      if (sz < 0) {
+        err_no = errno;
+        break;
+      }
+      if (0 == sz) break;
+      if ((rxs_session_fwrite(s, buf, (size_t)sz, sizeof(uint8_t), stream) != (size_t)sz) || rxs_session_errno(s)) {
+        err_no = (rxs_session_errno(s)) ? (rxs_session_errno(s)) : (EIO);
+        *lost = (err_no < RXS_SRV_NONE) ? (1) : (0);
+        break;
+      }
+      *bytes += (uint64_t)sz;
+    }
+  }
+  //////////////////////////////////////////////////////////////////////////////////
+  // Written data are flushed by the close, so its error fails the file
+  //////////////////////////////////////////////////////////////////////////////////
+  if ((rxs_session_fclose(s, stream) != 0) && !err_no && !pull) {
+    err_no = (rxs_session_errno(s)) ? (rxs_session_errno(s)) : (EIO);
+    *lost = (err_no < RXS_SRV_NONE) ? (1) : (0);
+  }
+  if (err_no && !session_point_connected(s)) *lost = 1;
+  if (pull && !err_no) {
+    // The copy gets mtime of the source, so it is not taken for changed by the next run of the mirror
+    struct timespec times[2] = {{0, UTIME_OMIT}, {(time_t)mtime, 0}};
+    if ((durable_commit_fd(fd, get_durability_policy(NULL)) != 0) || ((mtime >= 0) && (futimens(fd, times) != 0)))
+      err_no = errno;
+  }
+  if ((close(fd) != 0) && !err_no) err_no = errno;
+  return err_no;
+}
+// Move one file of the mirror, 'bytes' and 'lost' are set as by 'transfer_file'
+// Return value: on success returns 0, otherwise error number
+static int mirror_transfer(rxs_session_t* s, mirror_queue_t* queue, const mirror_entry_t* entry, uint8_t* buf,
+                           uint64_t* bytes, uint8_t* lost) {
+  char path_local[PATH_MAX];
+  char path_remote[PATH_MAX];
+  *bytes = 0;
+  *lost = 0;
+  if ((mirror_path(path_local, sizeof(path_local), queue->dir_local, entry->path) != 0) ||
+      (mirror_path(path_remote, sizeof(path_remote), queue->dir_remote, entry->path) != 0))
+    return errno;
+  return transfer_file(s, path_local, path_remote, queue->pull, entry->mtime, buf, bytes, lost);
+}
+static void* mirror_worker(void* arg) {
+  mirror_queue_t* queue = (mirror_queue_t*)arg;
+  uint8_t* buf = (uint8_t*)malloc(MIRROR_CHUNK_SZ);
+  if (!buf) log_msg(ERRN, 44, MIRROR_CHUNK_SZ);
+
+  rxs_session_t* s = NULL;
+  for (;;) {
+    pthread_mutex_lock(&queue->mutex);
+    const mirror_entry_t* entry = (queue->next < queue->cnt) ? (queue->jobs[queue->next++]) : (NULL);
+    pthread_mutex_unlock(&queue->mutex);
+    if (!entry) break;
+
+    int err_no = (buf) ? (0) : (ENOMEM);
+    uint64_t bytes = 0;
+    for (uint32_t retries = 0; buf; retries++) {
+      if (!s) s = rxs_pool_get(queue->host_p, queue->port_h, queue->username, queue->password, queue->encoder);
+      uint8_t lost = 1;
+      err_no = (s) ? (mirror_transfer(s, queue, entry, buf, &bytes, &lost)) : ((errno) ? (errno) : (EIO));
+      // Local error and an answer of other side are not repeated
+      if (!err_no || !lost) break;
+      // The session is broken
+      if (s) pool_drop(s);
+      s = NULL;
+      if (retries >= MIRROR_RETRIES_MAX) break;
+    }
+    pthread_mutex_lock(&queue->mutex);
+    if (err_no) {
+      log_msg(ERRN, 6, entry->path, (err_no >= RXS_SRV_NONE) ? (strerror(err_no - RXS_SRV_NONE)) : (strerror(err_no)));
+      queue->stat->files_failed++;
+      if (!queue->err_no) queue->err_no = err_no;
+    } else {
+      queue->stat->files_moved++;
+      queue->stat->bytes_moved += bytes;
+    }
+    pthread_mutex_unlock(&queue->mutex);
+  }
+  if (s) rxs_pool_put(s);
+  free(buf);
+  return NULL;
+}
+// Create parent directories of the files on the destination side (the jobs are sorted by path)
+static void mirror_make_dirs(rxs_session_t* s, mirror_queue_t* queue) {
+  char dir_last[PATH_MAX] = {0};
+  for (size_t i = 0; i < queue->cnt; i++) {
+    const char* sep = strrchr(queue->jobs[i]->path, '/');
+    if (!sep) continue;
+    char rel[PATH_MAX];
+    snprintf(rel, sizeof(rel), "%.*s", (int)(sep - queue->jobs[i]->path), queue->jobs[i]->path);
+    if (!strcmp(rel, dir_last)) continue;
+    snprintf(dir_last, sizeof(dir_last), "%s", rel);
+    char path[PATH_MAX];
+    if (mirror_path(path, sizeof(path), (queue->pull) ? (queue->dir_local) : (queue->dir_remote), rel) != 0) continue;
+    // Existing directory is not an error, failure is reported by the transfer of the file
+    if (queue->pull) {
+      int status = 0;
+      uint32_t err_no = 0;
+      mkdir_ex(path, S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH, &status, &err_no);
+    } else {
+      rxs_session_mkdir_ex(s, path, S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+    }
+  }
+}
+int rxs_mirror(const char* host_p, uint16_t port_h, const char* username, const char* password, int encoder,
+               const char* dir_local, const char* dir_remote, uint32_t flags, uint32_t workers,
+               rxs_mirror_stat_t* stat) {
+  if (!dir_local || !dir_remote || !stat) {
+    errno = EINVAL;
     return -1;
   }
-  return (!errno_both_sides) ? (res) : (-1);
+  if ((0 == workers) || (workers > RXS_MIRROR_WORKERS_MAX)) workers = RXS_MIRROR_WORKERS_MAX;
+  memset(stat, 0, sizeof(rxs_mirror_stat_t));
+  uint64_t start_msec = monotonic_msec();
+  uint8_t pull = (flags & RXS_MIRROR_PULL) ? (1) : (0);
+
+  rxs_session_t* s = rxs_pool_get(host_p, port_h, username, password, encoder);
+  if (!s) return -1;
+  //////////////////////////////////////////////////////////////////////////////////
+  // Manifests of both sides, the destination tree is created if it is absent
+  //////////////////////////////////////////////////////////////////////////////////
+  mirror_manifest_t src;
+  mirror_manifest_t dst;
+  memset(&src, 0, sizeof(src));
+  memset(&dst, 0, sizeof(dst));
+  int res = 0;
+  if (pull) {
+    int status = 0;
+    uint32_t err_no = 0;
+    mkdir_ex(dir_local, S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH, &status, &err_no);
+    res = ((mirror_walk_remote(s, dir_remote, 0, &src) != 0) || (mirror_walk_local(dir_local, "", &dst) != 0));
+  } else {
+    res = ((mirror_walk_local(dir_local, "", &src) != 0) || (mirror_walk_remote(s, dir_remote, 1, &dst) != 0));
+  }
+  int err_no = (res) ? (errno) : (0);
+  qsort(src.entries, src.cnt, sizeof(mirror_entry_t), mirror_entry_cmp_path);
+  qsort(dst.entries, dst.cnt, sizeof(mirror_entry_t), mirror_entry_cmp_path);
+  stat->files_total = src.cnt;
+  //////////////////////////////////////////////////////////////////////////////////
+  // New files, files of other size and files are newer than the copy are moved
+  //////////////////////////////////////////////////////////////////////////////////
+  mirror_queue_t queue = {.host_p = host_p,
+                          .port_h = port_h,
+                          .username = username,
+                          .password = password,
+                          .encoder = encoder,
+                          .dir_local = dir_local,
+                          .dir_remote = dir_remote,
+                          .pull = pull,
+                          .stat = stat};
+  const mirror_entry_t** deleted = NULL;
+  size_t deleted_cnt = 0;
+  if (!err_no) {
+    queue.jobs = (const mirror_entry_t**)malloc((src.cnt + 1) * sizeof(mirror_entry_t*));
+    deleted = (const mirror_entry_t**)malloc((dst.cnt + 1) * sizeof(mirror_entry_t*));
+    if (!queue.jobs || !deleted) {
+      log_msg(ERRN, 44, (src.cnt + dst.cnt + 2) * sizeof(mirror_entry_t*));
+      err_no = ENOMEM;
+    }
+  }
+  for (size_t i = 0, j = 0; !err_no && ((i < src.cnt) || (j < dst.cnt));) {
+    int cmp = (i == src.cnt) ? (1) : ((j == dst.cnt) ? (-1) : (strcmp(src.entries[i].path, dst.entries[j].path)));
+    if (cmp < 0) {
+      queue.jobs[queue.cnt++] = &src.entries[i++];
+    } else if (cmp > 0) {
+      deleted[deleted_cnt++] = &dst.entries[j++];
+    } else {
+      if ((src.entries[i].size != dst.entries[j].size) || (src.entries[i].mtime > dst.entries[j].mtime))
+        queue.jobs[queue.cnt++] = &src.entries[i];
+      i++;
+      j++;
+    }
+  }
+  //////////////////////////////////////////////////////////////////////////////////
+  // Workers take files from the shared queue
+  //////////////////////////////////////////////////////////////////////////////////
+  if (!err_no && queue.cnt) {
+    mirror_make_dirs(s, &queue);
+    rxs_pool_put(s);
+    s = NULL;
+    qsort(queue.jobs, queue.cnt, sizeof(mirror_entry_t*), mirror_job_cmp_size);
+    if (workers > queue.cnt) workers = (uint32_t)queue.cnt;
+    pthread_mutex_init(&queue.mutex, NULL);
+    pthread_t thrs[RXS_MIRROR_WORKERS_MAX];
+    uint32_t started = 0;
+    for (; started < workers; started++) {
+      int ret_code = pthread_create(&thrs[started], NULL, mirror_worker, &queue);
+      if (ret_code != 0) {
+        log_msg(ERRN, 6, "pthread_create", strerror(ret_code));
+        break;
+      }
+    }
+    // Without workers the files are moved by this thread
+    if (0 == started) mirror_worker(&queue);
+    for (uint32_t i = 0; i < started; i++) pthread_join(thrs[i], NULL);
+    pthread_mutex_destroy(&queue.mutex);
+    err_no = queue.err_no;
+  }
+  //////////////////////////////////////////////////////////////////////////////////
+  // Files are absent on the source side are deleted after the transfer
+  //////////////////////////////////////////////////////////////////////////////////
+  if (!err_no && (flags & RXS_MIRROR_DELETE) && deleted_cnt) {
+    if (!s) s = rxs_pool_get(host_p, port_h, username, password, encoder);
+    if (!s) err_no = (errno) ? (errno) : (EIO);
+    for (size_t i = 0; !err_no && (i < deleted_cnt); i++) {
+      char path[PATH_MAX];
+      if (mirror_path(path, sizeof(path), (pull) ? (dir_local) : (dir_remote), deleted[i]->path) != 0) {
+        err_no = errno;
+      } else if (pull) {
+        if (unlink(path) != 0) err_no = errno;
+      } else {
+        if (rxs_session_unlink(s, path) != 0) err_no = (rxs_session_errno(s)) ? (rxs_session_errno(s)) : (EIO);
+      }
+      if (!err_no) stat->files_deleted++;
+    }
+  }
+  if (s) rxs_pool_put(s);
+  free(queue.jobs);
+  free(deleted);
+  dinit_mirror_manifest_t(&src);
+  dinit_mirror_manifest_t(&dst);
+  stat->sec = (double)(monotonic_msec() - start_msec) / 1000.0;
+  if (err_no) {
+    errno = err_no;
+    return -1;
+  }
+  return 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// Batch: operations of the manifest are run by warm sessions of the pool (streams). Transfers between two metadata
+// operations are moved by all streams at once, a metadata operation is run after all earlier operations are done.
+//////////////////////////////////////////////////////////////////////////////////////////////////
+static const char* const batch_op_names[] = {"none", "get", "put", "mkdir", "rm", "rename"};
+
+typedef struct batch_queue_t {
+  pthread_mutex_t mutex;
+  rxs_batch_result_t* items;
+  size_t next;  // Transfers [next, end) are waited for a stream
+  size_t end;
+  const char* host_p;
+  uint16_t port_h;
+  const char* username;
+  const char* password;
+  int encoder;
+} batch_queue_t;
+
+typedef struct batch_stream_t {
+  batch_queue_t* queue;
+  rxs_session_t* s;  // The session is kept by the stream for all its operations
+  uint8_t* buf;
+} batch_stream_t;
+
+const char* rxs_batch_op_name(rxs_batch_op_t op) {
+  return ((op >= batch_op_none) && (op <= batch_op_rename)) ? (batch_op_names[op]) : (batch_op_names[0]);
+}
+void rxs_batch_free(rxs_batch_result_t* results, size_t cnt) {
+  if (!results) return;
+  for (size_t i = 0; i < cnt; i++) {
+    free(results[i].arg1);
+    free(results[i].arg2);
+  }
+  free(results);
+}
+// Next token of the line, a token with spaces is quoted by '"'. The token is terminated in place.
+// Return value: on success returns the token, otherwise NULL (end of the line)
+static char* batch_token(char** line) {
+  char* p = *line;
+  while ((' ' == *p) || ('\t' == *p) || ('\r' == *p) || ('\n' == *p)) p++;
+  if (!*p || ('#' == *p)) return NULL;
+  char* token = p;
+  if ('"' == *p) {
+    token = ++p;
+    while (*p && (*p != '"')) p++;
+  } else {
+    while (*p && (*p != ' ') && (*p != '\t') && (*p != '\r') && (*p != '\n')) p++;
+  }
+  if (*p) *p++ = 0;
+  *line = p;
+  return token;
+}
+// Parse the manifest: one operation per line, empty lines and lines are started by '#' are skipped. A line is not
+// parsed gets the result EINVAL and it is not run.
+// Return value: on success returns 0, otherwise -1 and errno is set appropriately
+static int batch_parse(const char* fname_manifest, rxs_batch_result_t** results, size_t* cnt) {
+  FILE* manifest = fopen(fname_manifest, "r");
+  if (!manifest) return -1;
+  rxs_batch_result_t* items = NULL;
+  size_t cnt_max = 0;
+  char* line = NULL;
+  size_t line_sz = 0;
+  uint32_t line_num = 0;
+  int res = 0;
+  while (!res && (getline(&line, &line_sz, manifest) >= 0)) {
+    line_num++;
+    char* p = line;
+    char* op = batch_token(&p);
+    if (!op) continue;
+    char* arg1 = batch_token(&p);
+    char* arg2 = batch_token(&p);
+    char* extra = batch_token(&p);
+    if (*cnt == cnt_max) {
+      cnt_max = (cnt_max) ? (cnt_max * 2) : (256);
+      rxs_batch_result_t* tmp = (rxs_batch_result_t*)realloc(items, cnt_max * sizeof(rxs_batch_result_t));
+      if (!tmp) {
+        log_msg(ERRN, 44, cnt_max * sizeof(rxs_batch_result_t));
+        res = -1;
+        break;
+      }
+      items = tmp;
+    }
+    rxs_batch_result_t* item = &items[*cnt];
+    memset(item, 0, sizeof(rxs_batch_result_t));
+    item->line = line_num;
+    for (int i = batch_op_get; i <= batch_op_rename; i++)
+      if (!strcmp(op, batch_op_names[i])) item->op = (rxs_batch_op_t)i;
+    // Number of the arguments: get, put and rename have two of them
+    uint8_t args_cnt = ((batch_op_mkdir == item->op) || (batch_op_rm == item->op)) ? (1) : (2);
+    if ((batch_op_none == item->op) || !arg1 || ((2 == args_cnt) != (NULL != arg2)) || extra) {
+      item->op = batch_op_none;
+      item->err_no = EINVAL;
+    }
+    item->arg1 = strdup((arg1) ? (arg1) : (""));
+    item->arg2 = strdup((arg2) ? (arg2) : (""));
+    (*cnt)++;
+    if (!item->arg1 || !item->arg2) res = -1;
+  }
+  int err_no = errno;
+  if (!res && ferror(manifest)) res = -1;
+  free(line);
+  fclose(manifest);
+  if (res) {
+    rxs_batch_free(items, *cnt);
+    *cnt = 0;
+    errno = err_no;
+    return -1;
+  }
+  *results = items;
+  return 0;
+}
+static void* batch_worker(void* arg) {
+  batch_stream_t* stream = (batch_stream_t*)arg;
+  batch_queue_t* queue = stream->queue;
+  for (;;) {
+    pthread_mutex_lock(&queue->mutex);
+    rxs_batch_result_t* item = (queue->next < queue->end) ? (&queue->items[queue->next++]) : (NULL);
+    pthread_mutex_unlock(&queue->mutex);
+    if (!item) break;
+
+    uint64_t start_msec = monotonic_msec();
+    uint8_t pull = (batch_op_get == item->op) ? (1) : (0);
+    for (uint32_t retries = 0;; retries++) {
+      if (!stream->s)
+        stream->s = rxs_pool_get(queue->host_p, queue->port_h, queue->username, queue->password, queue->encoder);
+      uint8_t lost = 0;
+      item->err_no = (stream->s) ? (transfer_file(stream->s, item->arg1, item->arg2, pull, -1, stream->buf,
+                                                  &item->bytes, &lost))
+                                 : ((errno) ? (errno) : (EIO));
+      // Local error and an answer of other side are not repeated
+      if (!item->err_no || (stream->s && !lost)) break;
+      // The session is broken
+      if (stream->s) pool_drop(stream->s);
+      stream->s = NULL;
+      if (retries >= MIRROR_RETRIES_MAX) break;
+    }
+    item->sec = (double)(monotonic_msec() - start_msec) / 1000.0;
+  }
+  return NULL;
+}
+// Run the metadata operation on the session
+// Return value: on success returns 0, otherwise error number
+static int batch_meta(rxs_session_t* s, const rxs_batch_result_t* item) {
+  int res = -1;
+  switch (item->op) {
+    case batch_op_mkdir: {
+      // Parent directories are created too, an existing directory is not an error (as 'mkdir -p')
+      res = rxs_session_mkdir_ex(s, item->arg1, S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+      int err_no = rxs_session_errno(s);
+      if ((res != 0) && (err_no >= RXS_SRV_NONE) && (rxs_session_dir_exist(s, item->arg1) == 1)) return 0;
+      if (res != 0) return (err_no) ? (err_no) : (EIO);
+      return 0;
+    }
+    case batch_op_rm:
+      res = rxs_session_unlink(s, item->arg1);
+      break;
+    case batch_op_rename:
+      res = rxs_session_rename(s, item->arg1, item->arg2);
+      break;
+    default:
+      return EINVAL;
+  }
+  return (!res) ? (0) : ((rxs_session_errno(s)) ? (rxs_session_errno(s)) : (EIO));
+}
+int rxs_batch(const char* host_p, uint16_t port_h, const char* username, const char* password, int encoder,
+              const char* fname_manifest, uint32_t streams, rxs_batch_result_t** results, size_t* cnt) {
+  if (!fname_manifest || !results || !cnt) {
+    errno = EINVAL;
+    return -1;
+  }
+  *results = NULL;
+  *cnt = 0;
+  if ((0 == streams) || (streams > RXS_BATCH_STREAMS_MAX)) streams = RXS_BATCH_STREAMS_MAX;
+  if (batch_parse(fname_manifest, results, cnt) != 0) return -1;
+  rxs_batch_result_t* items = *results;
+
+  batch_queue_t queue = {.items = items,
+                         .host_p = host_p,
+                         .port_h = port_h,
+                         .username = username,
+                         .password = password,
+                         .encoder = encoder};
+  batch_stream_t stream[RXS_BATCH_STREAMS_MAX];
+  memset(stream, 0, sizeof(stream));
+  pthread_mutex_init(&queue.mutex, NULL);
+  int err_no = 0;
+  for (uint32_t i = 0; i < streams; i++) {
+    stream[i].queue = &queue;
+    stream[i].buf = (uint8_t*)malloc(MIRROR_CHUNK_SZ);
+    if (!stream[i].buf) {
+      log_msg(ERRN, 44, MIRROR_CHUNK_SZ);
+      err_no = ENOMEM;
+    }
+  }
+  for (size_t i = 0; !err_no && (i < *cnt);) {
+    //////////////////////////////////////////////////////////////////////////////////
+    // Transfers up to the next metadata operation are taken by the streams
+    //////////////////////////////////////////////////////////////////////////////////
+    size_t end = i;
+    while ((end < *cnt) && ((batch_op_get == items[end].op) || (batch_op_put == items[end].op))) end++;
+    if (end > i) {
+      queue.next = i;
+      queue.end = end;
+      uint32_t workers = ((end - i) < streams) ? ((uint32_t)(end - i)) : (streams);
+      pthread_t thrs[RXS_BATCH_STREAMS_MAX];
+      uint32_t started = 1;
+      // The first stream is served by this thread
+      for (; started < workers; started++) {
+        int ret_code = pthread_create(&thrs[started], NULL, batch_worker, &stream[started]);
+        if (ret_code != 0) {
+          log_msg(ERRN, 6, "pthread_create", strerror(ret_code));
+          break;
+        }
+      }
+      batch_worker(&stream[0]);
+      for (uint32_t j = 1; j < started; j++) pthread_join(thrs[j], NULL);
+      i = end;
+      continue;
+    }
+    //////////////////////////////////////////////////////////////////////////////////
+    // Metadata operation (or a line is not parsed)
+    //////////////////////////////////////////////////////////////////////////////////
+    rxs_batch_result_t* item = &items[i++];
+    if (batch_op_none == item->op) continue;
+    uint64_t start_msec = monotonic_msec();
+    if (!stream[0].s) stream[0].s = rxs_pool_get(host_p, port_h, username, password, encoder);
+    item->err_no = (stream[0].s) ? (batch_meta(stream[0].s, item)) : ((errno) ? (errno) : (EIO));
+    // The session can be broken
+    if (stream[0].s && item->err_no && (item->err_no < RXS_SRV_NONE)) {
+      pool_drop(stream[0].s);
+      stream[0].s = NULL;
+    }
+    item->sec = (double)(monotonic_msec() - start_msec) / 1000.0;
+  }
+  for (uint32_t i = 0; i < streams; i++) {
+    if (stream[i].s) rxs_pool_put(stream[i].s);
+    free(stream[i].buf);
+  }
+  pthread_mutex_destroy(&queue.mutex);
+  for (size_t i = 0; !err_no && (i < *cnt); i++) err_no = items[i].err_no;
+  if (err_no) {
+    errno = err_no;
+    return -1;
+  }
+  return 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// Functions of the default session
+//////////////////////////////////////////////////////////////////////////////////////////////////
+size_t rxs_point_create(const char* host_p, uint16_t port_h, const char* username, const char* password, int encoder) {
+  return session_point_create(&session_default, host_p, port_h, username, password, encoder);
+}
+size_t rxs_point_connected() { return session_point_connected(&session_default); }
+size_t rxs_point_close() { return session_point_close(&session_default); }
+int rxs_errno() { return rxs_session_errno(&session_default); }
+char* rxs_strerror() { return rxs_session_strerror(&session_default); }
+size_t rxs_ls(const char* path, void* buf, size_t count) { return rxs_session_ls(&session_default, path, buf, count); }
+int rxs_mkdir(const char* path, mode_t mode) { return rxs_session_mkdir(&session_default, path, mode); }
+int rxs_mkdir_ex(const char* path, mode_t mode) { return rxs_session_mkdir_ex(&session_default, path, mode); }
+int rxs_rmdir(const char* path) { return rxs_session_rmdir(&session_default, path); }
+char* rxs_getcwd(char* buf, size_t size) { return rxs_session_getcwd(&session_default, buf, size); }
+int rxs_chdir(const char* path) { return rxs_session_chdir(&session_default, path); }
+int rxs_unlink(const char* path) { return rxs_session_unlink(&session_default, path); }
+int rxs_rename(const char* oldname, const char* newname) {
+  return rxs_session_rename(&session_default, oldname, newname);
+}
+long rxs_filesize(const char* fname) { return rxs_session_filesize(&session_default, fname); }
+RXS_HANDLE rxs_fopen(const char* fname, const char* mode) { return rxs_session_fopen(&session_default, fname, mode); }
+size_t rxs_fread(void* buf, size_t size, size_t count, RXS_HANDLE stream) {
+  return rxs_session_fread(&session_default, buf, size, count, stream);
+}
+void rxs_set_readahead(size_t mem_max) { rxs_session_set_readahead(&session_default, mem_max); }
+void rxs_readahead_stat(uint64_t* hits, uint64_t* misses) {
+  rxs_session_readahead_stat(&session_default, hits, misses);
+}
+void rxs_set_meta_cache(uint32_t ttl_msec) { rxs_session_set_meta_cache(&session_default, ttl_msec); }
+void rxs_meta_cache_stat(uint64_t* hits, uint64_t* misses) {
+  rxs_session_meta_cache_stat(&session_default, hits, misses);
+}
+int rxs_set_rate_limit(uint64_t rate, uint64_t burst) {
+  return rxs_session_set_rate_limit(&session_default, rate, burst);
+}
+size_t rxs_fwrite(const void* buf, size_t size, size_t count, RXS_HANDLE stream) {
+  return rxs_session_fwrite(&session_default, buf, size, count, stream);
+}
+int rxs_set_write_back(RXS_HANDLE stream, size_t buf_sz, uint32_t flush_msec) {
+  return rxs_session_set_write_back(&session_default, stream, buf_sz, flush_msec);
+}
+size_t rxs_pread(void* buf, size_t size, size_t count, RXS_HANDLE stream, uint64_t offset) {
+  return rxs_session_pread(&session_default, buf, size, count, stream, offset);
+}
+size_t rxs_preadv(const struct iovec* iov, int iovcnt, const uint64_t* offsets, RXS_HANDLE stream) {
+  return rxs_session_preadv(&session_default, iov, iovcnt, offsets, stream);
+}
+size_t rxs_pwrite(const void* buf, size_t size, size_t count, RXS_HANDLE stream, uint64_t offset) {
+  return rxs_session_pwrite(&session_default, buf, size, count, stream, offset);
+}
+int rxs_fflush(RXS_HANDLE stream) { return rxs_session_fflush(&session_default, stream); }
+int rxs_fclose(RXS_HANDLE stream) { return rxs_session_fclose(&session_default, stream); }
+int rxs_fseek(RXS_HANDLE stream, long offset, int whence) {
+  return rxs_session_fseek(&session_default, stream, offset, whence);
+}
+long rxs_ftell(RXS_HANDLE stream) { return rxs_session_ftell(&session_default, stream); }
+int rxs_fseeko(RXS_HANDLE stream, int64_t offset, int whence) {
+  return rxs_session_fseeko(&session_default, stream, offset, whence);
+}
+int64_t rxs_ftello(RXS_HANDLE stream) { return rxs_session_ftello(&session_default, stream); }
+void rxs_rewind(RXS_HANDLE stream) { rxs_session_rewind(&session_default, stream); }
+int rxs_file_exist(const char* path_file) { return rxs_session_file_exist(&session_default, path_file); }
+int rxs_dir_exist(const char* path_dir) { return rxs_session_dir_exist(&session_default, path_dir); }
+RXS_TOKEN rxs_fopen_async(const char* fname, const char* mode, rxs_callback_t cb, void* user_data) {
+  return rxs_session_fopen_async(&session_default, fname, mode, cb, user_data);
+}
+RXS_TOKEN rxs_fread_async(void* buf, size_t size, size_t count, RXS_HANDLE stream, rxs_callback_t cb,
+                          void* user_data) {
+  return rxs_session_fread_async(&session_default, buf, size, count, stream, cb, user_data);
+}
+RXS_TOKEN rxs_fwrite_async(const void* buf, size_t size, size_t count, RXS_HANDLE stream, rxs_callback_t cb,
+                           void* user_data) {
+  return rxs_session_fwrite_async(&session_default, buf, size, count, stream, cb, user_data);
+}
+RXS_TOKEN rxs_fflush_async(RXS_HANDLE stream, rxs_callback_t cb, void* user_data) {
+  return rxs_session_fflush_async(&session_default, stream, cb, user_data);
+}
+RXS_TOKEN rxs_fclose_async(RXS_HANDLE stream, rxs_callback_t cb, void* user_data) {
+  return rxs_session_fclose_async(&session_default, stream, cb, user_data);
+}
+RXS_TOKEN rxs_filesize_async(const char* fname, rxs_callback_t cb, void* user_data) {
+  return rxs_session_filesize_async(&session_default, fname, cb, user_data);
+}
+RXS_TOKEN rxs_unlink_async(const char* path, rxs_callback_t cb, void* user_data) {
+  return rxs_session_unlink_async(&session_default, path, cb, user_data);
+}
+int rxs_async_fd() { return rxs_session_async_fd(&session_default); }
+size_t rxs_async_complete(rxs_completion_t* completions, size_t count) {
+  return rxs_session_async_complete(&session_default, completions, count);
 }
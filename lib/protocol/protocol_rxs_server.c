@@ -19,6 +19,9 @@
 ** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 ** SOFTWARE.
 *******************************************************************************/
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE  // for 'splice()', 'F_SETPIPE_SZ'
+#endif
 #include <fcntl.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -26,6 +29,7 @@
 
 #ifndef __QNXNTO__
 #include <linux/limits.h>  // for 'PATH_MAX'
+#include <sys/sendfile.h>  // for 'sendfile'
 #else
 #include <limits.h>
 #include <netdb.h>        // for getprotobyname
@@ -37,6 +41,7 @@
 #include <inttypes.h>  // for 'PRIu32'
 #include <signal.h>    // for 'signal()'
 #include <sys/ioctl.h>
+#include <sys/mman.h>  // for 'mmap()'
 #include <sys/poll.h>
 #include <sys/socket.h>
 #include <sys/stat.h>  // for 'stat'
@@ -47,13 +52,17 @@
 
 #include "container/list.h"
 #include "logger/logger.h"
+#include "protocol/durability.h"
 #include "protocol/generic.h"
 #include "protocol/internal_types.h"
 #include "protocol/parser.h"
 #include "protocol/protocol_rxs_server.h"
+#include "protocol/rate_limit.h"
+#include "protocol/rxs_uring.h"
 
 #define USERNAME_SZ 255
 #define PASSWORD_SZ 255
+#define ZERO_COPY_CHUNK_SZ (1024 * 1024)  // Max size of data are moved by one call 'sendfile()'
 
 char path_output[PATH_MAX] = {0};
 char file_users[PATH_MAX] = {0};  // Path to file 'rxs_users'
@@ -66,8 +75,18 @@ uint8_t have_encoder = 0;
 struct sockaddr_in client_addr;
 uint32_t this_side_addr_n = 0;
 uint8_t access_granted = 0;
-// File handlers list
-dlist_t* file_handlers_lst = NULL;
+// File handlers table
+file_handlers_tbl_t file_handlers_tbl = {NULL, 0, 0, 0, FHANDLE_OPEN_MAX};
+// Storage backend of data paths in plain mode
+io_backend_t io_backend = IO_BACKEND_POSIX;
+// Bucket of the authorized user (NULL - the user is not limited)
+static rate_limit_t* rate_limit_user = NULL;
+static rxs_uring_t io_ring = {.ring_fd = -1};
+static uint8_t io_ring_ready = 0;
+read_mode_t read_mode = READ_MODE_STDIO;
+uint32_t write_behind_mb = WRITE_BEHIND_MB;
+// Aligned buffers of streams in direct I/O mode
+aligned_buf_pool_t direct_buf_pool = {{NULL}, 0, DIRECT_IO_BUF_SZ, DIRECT_IO_ALIGN};
 
 static float ceil_x(float f) {
   unsigned input;
@@ -113,14 +132,13 @@ size_t rxs_data_point_close() {
   return -1;
 }
 
-size_t rxs_data_point_create_server(uint16_t port_h) {
+size_t rxs_data_point_create_server(uint32_t stream, uint16_t port_h) {
   struct sockaddr_in local;
   struct sockaddr_in data;
 
   int socketfd = socket(AF_INET, SOCK_STREAM, 0);
   if (socketfd < 0) {
     log_msg(ERRN, 6, "socket, data connection", strerror(errno));
-    rxs_data_point_close();
     return -1;
   }
   memset(&local, 0, sizeof(local));
@@ -134,18 +152,26 @@ size_t rxs_data_point_create_server(uint16_t port_h) {
   data.sin_port = htons(port_h);
 
   if (set_socket_mode(socketfd, have_encoder) != 0) {
-    rxs_data_point_close();
+    close(socketfd);
     return -1;
   }
   int reuseaddr = 1;
   if (setsockopt(socketfd, SOL_SOCKET, SO_REUSEADDR, &reuseaddr, sizeof(reuseaddr)) < 0) {
     log_msg(ERRN, 59, "SO_REUSEADDR", strerror(errno));
-    rxs_data_point_close();
+    close(socketfd);
+    return -1;
+  }
+  // A send which has started on the full socket (e.g. 'sendfile()' of the large chunk) is not blocked forever by a
+  // stalled other side
+  struct timeval send_timeout = {POLL_TIMEOUT_DATA_MSEC / 1000, (POLL_TIMEOUT_DATA_MSEC % 1000) * 1000};
+  if (setsockopt(socketfd, SOL_SOCKET, SO_SNDTIMEO, &send_timeout, sizeof(send_timeout)) < 0) {
+    log_msg(ERRN, 59, "SO_SNDTIMEO", strerror(errno));
+    close(socketfd);
     return -1;
   }
   if (bind(socketfd, (struct sockaddr*)&local, sizeof(local)) < 0) {
     log_msg(ERRN, 56, strerror(errno));
-    rxs_data_point_close();
+    close(socketfd);
     return 1;
   }
   //////////////////////////////////////////////////////////////////////////////////
@@ -155,13 +181,20 @@ size_t rxs_data_point_create_server(uint16_t port_h) {
     // Set errno
     log_msg(ERRN, 6, "connect", strerror(errno));
     log_msg(ERRN, 9, inet_ntoa((struct in_addr)data.sin_addr), port_h);
-    rxs_data_point_close();
+    close(socketfd);
     return -1;
   }
   //////////////////////////////////////////////////////////////////////////////////
-  //
+  // Channel of the open stream, otherwise the channel of the session
   //////////////////////////////////////////////////////////////////////////////////
-  set_socket_data(socketfd);
+  file_handlers_t* file_handlers = find_file_handlers_tbl_t(&file_handlers_tbl, stream);
+  if (file_handlers) {
+    if (file_handlers->data_fd >= 0) close(file_handlers->data_fd);
+    file_handlers->data_fd = socketfd;
+  } else {
+    rxs_data_point_close();
+    set_socket_data(socketfd);
+  }
 
   return 0;
 }
@@ -200,17 +233,6 @@ static int is_host_address(uint32_t addr_n) {
 //////////////////////////////////////////////////////////////////////////////////////////////////
 // Comparators
 //////////////////////////////////////////////////////////////////////////////////////////////////
-static int cmp_file_handlers_t_uint32_t(const void* data1, const void* data2) {
-  if ((!data1) || (!data2)) {
-    log_msg(ERRN, 14);
-    return -1;
-  }
-
-  uint32_t val1 = ((file_handlers_t*)data1)->fhandle_key;
-  uint32_t val2 = *((uint32_t*)data2);
-
-  return (val1 == val2) ? 0 : ((val1 > val2) ? 1 : -1);
-}
 static int cmp_addr_t_uint32_t(const void* data1, const void* data2) {
   if (!data1 || !data2) {
     return -2;
@@ -247,14 +269,66 @@ int set_socket_data(int sockfd) { return (sockfd_data = sockfd); }
 int get_socket_data() { return sockfd_data; }
 
 // Close file handlers
-ssize_t clear_file_handlers_lst() {
-  // Close file handler and clear list
-  list_clear(&file_handlers_lst, (void*)free_file_handlers_t);
-  return 0;
+ssize_t clear_file_handlers_tbl() {
+  // Close file handlers and free slabs
+  dinit_aligned_buf_pool_t(&direct_buf_pool);
+  return dinit_file_handlers_tbl_t(&file_handlers_tbl);
 }
 //////////////////////////////////////////////////////////////////////////////////////////////////
 // Policy functions
 //////////////////////////////////////////////////////////////////////////////////////////////////
+// Stream of the handle. Deferred writes are done before any use of the stream except 'fwrite'
+static file_handlers_t* find_stream(uint32_t key) {
+  file_handlers_t* file_handlers = find_file_handlers_tbl_t(&file_handlers_tbl, key);
+  if (file_handlers) flush_write_behind_file_handlers_t(file_handlers);
+  return file_handlers;
+}
+// Data channel of the stream
+static int get_stream_socket(uint32_t key) {
+  file_handlers_t* file_handlers = find_file_handlers_tbl_t(&file_handlers_tbl, key);
+  return (file_handlers && (file_handlers->data_fd >= 0)) ? (file_handlers->data_fd) : (get_socket_data());
+}
+static void close_stream_socket(uint32_t key) {
+  file_handlers_t* file_handlers = find_file_handlers_tbl_t(&file_handlers_tbl, key);
+  if (file_handlers && (file_handlers->data_fd >= 0)) {
+    close(file_handlers->data_fd);
+    file_handlers->data_fd = -1;
+  } else {
+    rxs_data_point_close();
+  }
+}
+ssize_t set_write_behind_mb(uint32_t mb) {
+  write_behind_mb = (mb) ? (mb) : (WRITE_BEHIND_MB);
+  return 0;
+}
+ssize_t set_open_streams_max(uint32_t open_streams_max) {
+  if (file_handlers_tbl.opened > open_streams_max) return -1;
+  file_handlers_tbl.opened_max = (open_streams_max > FHANDLE_INDEX_MASK) ? FHANDLE_INDEX_MASK : open_streams_max;
+  return 0;
+}
+ssize_t set_io_backend(io_backend_t backend) {
+  io_backend = backend;
+  return 0;
+}
+io_backend_t get_io_backend() { return io_backend; }
+ssize_t set_read_mode(read_mode_t mode) {
+  read_mode = mode;
+  return 0;
+}
+read_mode_t get_read_mode() { return read_mode; }
+// The ring is created by the session process on first use. If io_uring is not available the session uses POSIX calls
+static rxs_uring_t* get_io_ring() {
+  if (io_backend != IO_BACKEND_URING) return NULL;
+  if (io_ring_ready) return &io_ring;
+
+  if (init_rxs_uring_t(&io_ring, RXS_URING_ENTRIES, RXS_URING_BUFS_CNT, RXS_URING_BUF_SZ) != 0) {
+    log_msg(WARN, 62, strerror(errno), "posix");
+    io_backend = IO_BACKEND_POSIX;
+    return NULL;
+  }
+  io_ring_ready = 1;
+  return &io_ring;
+}
 ssize_t set_encoder_mode(uint8_t encoder_mode) {
   have_encoder = encoder_mode;
   return 0;
@@ -317,6 +391,20 @@ ssize_t clear_deny_address_lst() {
   return 0;
 }
 
+// Bucket of the user is shared by all sessions of the user, the limit is set by the last field of 'rxs_users'
+static void set_rate_limit_user(const user_info_t* user_info) {
+  uint64_t rate = 0;
+  uint64_t burst = 0;
+  rate_limit_user = NULL;
+  if (!user_info->rate_limit[0]) return;
+  if (parse_rate_limit(user_info->rate_limit, &rate, &burst) != 0) {
+    log_msg(ERRN, 6, "parse_rate_limit", user_info->rate_limit);
+    return;
+  }
+  rate_limit_user = get_rate_limit_user(user_info->name, rate, burst);
+  if (!rate_limit_user && rate) log_msg(ERRN, 6, "get_rate_limit_user", user_info->name);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////
 // Handlers for commands
 //////////////////////////////////////////////////////////////////////////////////////////////////
@@ -360,13 +448,13 @@ ssize_t rxs_handler_authorization(const uint8_t* user, uint32_t user_sz, const u
   while (!list_empty(user_info_t_lst)) {
     dlist_t* node = list_front(user_info_t_lst);
     if (node) {
-      user_info_t* user_info = (user_info_t*)node->data;
-      if (set_user_info(user_info->name, strlen(user_info->name), user_info->pass, strlen(user_info->pass),
-                        user_info->group, strlen(user_info->group), user_info->home_dir,
-                        strlen(user_info->home_dir)) != 0) {
+      // The whole record is kept, the rate limit of the user is applied after authorization
+      user_info_t* user_info = ctor_copy_user_info_t((user_info_t*)node->data);
+      if (!user_info || !list_push_back(&user_info_lst, user_info)) {
         // Free memory
+        free_user_info_t(user_info);
         list_clear(&user_info_t_lst, (void*)free_user_info_t);
-        log_msg(ERRN, 6, "set_user_info", "");
+        log_msg(ERRN, 6, "ctor_copy_user_info_t", "");
         *err_no = EIO;
         return -1;
       }
@@ -407,6 +495,7 @@ ssize_t rxs_handler_authorization(const uint8_t* user, uint32_t user_sz, const u
         *err_no = 0;
         log_msg(INFO, 27, user_info->home_dir);
         have_encoder = encoder;
+        set_rate_limit_user(user_info);
 
         if (is_encoder_mode())
           log_msg(INFO, 55, "rxsd", "encoded");
@@ -425,6 +514,7 @@ ssize_t rxs_handler_authorization(const uint8_t* user, uint32_t user_sz, const u
           *err_no = 0;
           log_msg(INFO, 27, user_info->home_dir);
           have_encoder = encoder;
+          set_rate_limit_user(user_info);
 
           if (is_encoder_mode())
             log_msg(INFO, 55, "rxsd", "encoded");
@@ -541,6 +631,7 @@ ssize_t rxs_handler_unlink(uint8_t* data, int* status, uint32_t* err_no) {
   if (!data || !status || !err_no) return -1;
 
   *status = unlink((char*)data);
+  if (0 == *status) *status = durable_commit_dir((char*)data, get_durability_policy(NULL));
   *err_no = errno;
   return ((0 == *status) ? 0 : -1);
 }
@@ -549,6 +640,9 @@ ssize_t rxs_handler_rename(uint8_t* data1, uint8_t* data2, int* status, uint32_t
   if (!data1 || !data2 || !status || !err_no) return -1;
 
   *status = rename((char*)data1, (char*)data2);
+  // Both directories are changed by the rename
+  if (0 == *status) *status = durable_commit_dir((char*)data2, get_durability_policy(NULL));
+  if (0 == *status) *status = durable_commit_dir((char*)data1, get_durability_policy(NULL));
   *err_no = errno;
   return ((0 == *status) ? 0 : -1);
 }
@@ -558,38 +652,74 @@ ssize_t rxs_handler_filesize(uint8_t* data, long* status, uint32_t* err_no) {
   // Get file size
   //////////////////////////////////////////////////////////////////////////////////
   struct stat st;
+  // Size includes data of write-behind buffers
+  flush_write_behind_file_handlers_tbl_t(&file_handlers_tbl);
   int res = stat((char*)data, &st);
 
-  *status = st.st_size;
+  // Missing file is reported by error, so it is not taken for a size
+  *status = (!res) ? (long)st.st_size : -1;
   *err_no = errno;
   return (!res) ? 0 : -1;
 }
 ssize_t rxs_handler_fopen(uint8_t* data1, uint8_t* data2, uint32_t* fhandle_key, uint32_t* err_no) {
   if (!data1 || !data2 || !fhandle_key || !err_no) return -1;
 
+  //////////////////////////////////////////////////////////////////////////////////
+  // Flag 'd' of the mode requests direct I/O, it is removed before 'fopen()'.
+  // Flag 's' of the mode requests full durability of the stream (see 'DURABILITY_FULL')
+  //////////////////////////////////////////////////////////////////////////////////
+  char mode[16] = {0};
+  uint8_t direct_io = 0;
+  durability_t durability = get_durability_policy(NULL);
+  for (size_t i = 0, j = 0; data2[i] && (j < sizeof(mode) - 1); ++i) {
+    if ('d' == data2[i])
+      direct_io = 1;
+    else if ('s' == data2[i])
+      durability = DURABILITY_FULL;
+    else
+      mode[j++] = (char)data2[i];
+  }
   // Open file
-  FILE* fhandle = fopen((char*)data1, (char*)data2);
+  FILE* fhandle = fopen((char*)data1, mode);
   if (fhandle) {
     //////////////////////////////////////////////////////////////////////////////////
-    // Associate file handler with value and put it into the map/list
+    // Associate file handler with the slot of the table
     //////////////////////////////////////////////////////////////////////////////////
-    char buf[FILENAME_MAX] = {0};
-    snprintf(buf, sizeof(buf), "%p", fhandle);
-    // NOTE: 32-bit address is look like as '0xFFFFFFFF'
-    uint32_t offset = strlen("0x") + (sizeof(uint32_t) * 2);
-    memset(buf + offset, 0, sizeof(buf) - offset);
-    *fhandle_key = strtoul(buf, NULL, 16);
-
-    file_handlers_t* file_handlers = new_file_handlers_t(1);
-    if (!file_handlers) {
-      log_msg(ERRN, 6, "new_file_handlers_t", "");
+    if (insert_file_handlers_tbl_t(&file_handlers_tbl, fhandle, fhandle_key) != 0) {
+      *err_no = errno;
+      *fhandle_key = 0;
+      if (EMFILE == *err_no) log_msg(ERRN, 60, file_handlers_tbl.opened_max);
       // Close handler
       fclose(fhandle);
       return -1;
     }
-    init_file_handlers_t(file_handlers, *fhandle_key, fhandle);
-
-    list_push_back(&file_handlers_lst, file_handlers);
+    file_handlers_t* file_handlers = find_file_handlers_tbl_t(&file_handlers_tbl, *fhandle_key);
+    file_handlers->durability = (uint8_t)durability;
+    // Entry of the created file
+    if (('r' != mode[0]) && (durable_commit_dir((char*)data1, durability) != 0))
+      log_msg(ERRN, 6, "durable_commit_dir", strerror(errno));
+    //////////////////////////////////////////////////////////////////////////////////
+    // Read-only regular file is read through the mapping
+    //////////////////////////////////////////////////////////////////////////////////
+    struct stat st;
+    if ((READ_MODE_MMAP == read_mode) && ('r' == mode[0]) && !strchr(mode, '+') &&
+        (fstat(fileno(fhandle), &st) == 0) && S_ISREG(st.st_mode))
+      file_handlers->mmap_mode = 1;
+#ifndef __QNXNTO__
+    //////////////////////////////////////////////////////////////////////////////////
+    // CAUTION: the second descriptor moves data of plain mode only, the stream serves other calls. The file is already
+    // created (truncated) by 'fopen()' and append mode is handled by the write path, so only access mode is passed.
+    // If the file system does not support O_DIRECT the stream stays buffered.
+    //////////////////////////////////////////////////////////////////////////////////
+    if (direct_io) {
+      int flags = (strchr(mode, '+')) ? (O_RDWR) : (('r' == mode[0]) ? (O_RDONLY) : (O_WRONLY));
+      int direct_fd = open((char*)data1, flags | O_DIRECT);
+      if (direct_fd < 0)
+        log_msg(WARN, 63, (char*)data1, strerror(errno));
+      else
+        file_handlers->direct_fd = direct_fd;
+    }
+#endif
 
     return 0;
   } else {
@@ -597,21 +727,72 @@ ssize_t rxs_handler_fopen(uint8_t* data1, uint8_t* data2, uint32_t* fhandle_key,
     return -1;
   }
 }
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// Access pattern of the stream: it is called before the read of 'count' bytes from 'offset'. The next chunk is
+// requested from the disk while the current one is on the wire.
+//////////////////////////////////////////////////////////////////////////////////////////////////
+static void hint_stream_read(file_handlers_t* file_handlers, off_t offset, size_t count) {
+#ifndef __QNXNTO__
+  // Direct I/O does not use the page cache
+  if (!file_handlers || (file_handlers->direct_fd >= 0) || (offset < 0)) return;
+
+  int fd = fileno(file_handlers->fhandle_val);
+  if (offset == file_handlers->seq_next) {
+    if (file_handlers->seq_cnt < SEQ_ACCESS_THRESHOLD) {
+      if (++file_handlers->seq_cnt == SEQ_ACCESS_THRESHOLD) {
+        posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+        file_handlers->ra_end = offset;
+        file_handlers->dontneed_end = offset;
+      }
+    }
+  } else {
+    // Random access: return to the default policy
+    if (file_handlers->seq_cnt >= SEQ_ACCESS_THRESHOLD) posix_fadvise(fd, 0, 0, POSIX_FADV_NORMAL);
+    file_handlers->seq_cnt = 0;
+    file_handlers->ra_window = READAHEAD_WINDOW_MIN;
+  }
+  file_handlers->seq_next = offset + (off_t)count;
+  if (file_handlers->seq_cnt < SEQ_ACCESS_THRESHOLD) return;
+  //////////////////////////////////////////////////////////////////////////////////
+  // Readahead: the range is requested again when the half of the window is consumed
+  //////////////////////////////////////////////////////////////////////////////////
+  off_t ra_beg = offset + (off_t)count;
+  if (file_handlers->ra_end < ra_beg) file_handlers->ra_end = ra_beg;
+  if ((file_handlers->ra_end - ra_beg) < (off_t)(file_handlers->ra_window / 2)) {
+    size_t ra_sz = file_handlers->ra_window - (size_t)(file_handlers->ra_end - ra_beg);
+    posix_fadvise(fd, file_handlers->ra_end, (off_t)ra_sz, POSIX_FADV_WILLNEED);
+    readahead(fd, file_handlers->ra_end, ra_sz);
+    file_handlers->ra_end += (off_t)ra_sz;
+    if (file_handlers->ra_window < READAHEAD_WINDOW_MAX) file_handlers->ra_window *= 2;
+  }
+  //////////////////////////////////////////////////////////////////////////////////
+  // Drop behind: pages already sent are not needed by the one-pass transfer
+  //////////////////////////////////////////////////////////////////////////////////
+  if ((offset - file_handlers->dontneed_end) >= (off_t)READAHEAD_WINDOW_MIN) {
+    posix_fadvise(fd, file_handlers->dontneed_end, offset - file_handlers->dontneed_end, POSIX_FADV_DONTNEED);
+    file_handlers->dontneed_end = offset;
+  }
+#else
+  (void)file_handlers;
+  (void)offset;
+  (void)count;
+#endif
+}
 ssize_t rxs_handler_fread(uint32_t key, uint8_t** buf, uint32_t* len, uint32_t* err_no) {
   if (!buf || !err_no || !len) return -1;
   //////////////////////////////////////////////////////////////////////////////////
-  // Looking FILE handler by address view into the map/list
+  // Looking FILE handler by handle into the table
   //////////////////////////////////////////////////////////////////////////////////
   size_t impl_bytes = 0;
-  const dlist_t* node = list_cfind(file_handlers_lst, &key, cmp_file_handlers_t_uint32_t);
-  if (node && key) {
-    file_handlers_t* file_handlers = (file_handlers_t*)node->data;
+  file_handlers_t* file_handlers = find_stream(key);
+  if (file_handlers) {
     size_t buf_sz = ((have_encoder > 0) ? (crypt_packet_sz()) : (crypt_data_sz()));
     *buf = calloc(buf_sz, sizeof(uint8_t));
     if (!*buf) {
       log_msg(ERRN, 6, "calloc", strerror(errno));
       return -1;
     }
+    hint_stream_read(file_handlers, ftello(file_handlers->fhandle_val), buf_sz);
     impl_bytes = fread(*buf, sizeof(uint8_t), buf_sz, file_handlers->fhandle_val);
     *len = ((have_encoder > 0) ? ((impl_bytes) ? buf_sz : 0) : (impl_bytes));
     // Examine error
@@ -633,16 +814,653 @@ ssize_t rxs_handler_fread(uint32_t key, uint8_t** buf, uint32_t* len, uint32_t*
     return -1;
   }
 }
+#ifndef __QNXNTO__
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// Direct I/O: the file is read by aligned blocks covering requested range, only the requested part is sent
+//////////////////////////////////////////////////////////////////////////////////////////////////
+static ssize_t fread_direct(int direct_fd, int sockfd, off_t* offset, size_t count, size_t* len, uint32_t* err_no) {
+  uint8_t* buf = get_aligned_buf_pool_t(&direct_buf_pool);
+  if (!buf) {
+    *err_no = errno;
+    return -1;
+  }
+  ssize_t result = 0;
+  while (*len < count) {
+    off_t aligned_offset = *offset & ~((off_t)DIRECT_IO_ALIGN - 1);
+    size_t head_sz = (size_t)(*offset - aligned_offset);
+    size_t read_sz = head_sz + (count - *len);
+    if (read_sz > DIRECT_IO_BUF_SZ) read_sz = DIRECT_IO_BUF_SZ;
+    read_sz = (read_sz + DIRECT_IO_ALIGN - 1) & ~((size_t)DIRECT_IO_ALIGN - 1);
+
+    ssize_t impl_bytes = pread(direct_fd, buf, read_sz, aligned_offset);
+    if (impl_bytes < 0) {
+      if (EINTR == errno) continue;
+      *err_no = errno;
+      result = -1;
+      break;
+    }
+    // End of file
+    if ((size_t)impl_bytes <= head_sz) break;
+    size_t send_sz = (size_t)impl_bytes - head_sz;
+    if (send_sz > count - *len) send_sz = count - *len;
+    if (rxs_send_x(sockfd, buf + head_sz, send_sz) < 0) {
+      *err_no = (errno) ? errno : EIO;
+      result = -1;
+      break;
+    }
+    *offset += send_sz;
+    *len += send_sz;
+    // Short read is the end of file
+    if ((size_t)impl_bytes < read_sz) break;
+  }
+  put_aligned_buf_pool_t(&direct_buf_pool, buf);
+  return result;
+}
+static ssize_t pwrite_all(int fd, const uint8_t* buf, size_t buf_sz, off_t offset, uint32_t* err_no) {
+  size_t write_bytes = 0;
+  while (write_bytes < buf_sz) {
+    ssize_t res = pwrite(fd, buf + write_bytes, buf_sz - write_bytes, offset + write_bytes);
+    if (res < 0) {
+      if (EINTR == errno) continue;
+      *err_no = errno;
+      return -1;
+    }
+    write_bytes += (size_t)res;
+  }
+  return 0;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// Direct I/O: data are received at the same alignment in the buffer as in the file. The buffer is filled before it is
+// written, so the body goes to the disk by whole aligned buffers through the direct descriptor, only the unaligned head
+// and tail of the request go through the buffered one.
+//////////////////////////////////////////////////////////////////////////////////////////////////
+static ssize_t fwrite_direct(int sockfd, int fd, int direct_fd, off_t offset, size_t count, size_t* len,
+                             uint32_t* err_no) {
+  uint8_t* buf = get_aligned_buf_pool_t(&direct_buf_pool);
+  if (!buf) {
+    *err_no = errno;
+    return -1;
+  }
+  ssize_t result = 0;
+  while (*len < count) {
+    size_t shift = (size_t)(offset % DIRECT_IO_ALIGN);
+    size_t chunk_sz = ((count - *len) > (DIRECT_IO_BUF_SZ - shift)) ? (DIRECT_IO_BUF_SZ - shift) : (count - *len);
+    size_t data_sz = 0;
+    while (data_sz < chunk_sz) {
+      ssize_t impl_bytes = rxs_recv_x(sockfd, buf + shift + data_sz, chunk_sz - data_sz);
+      if (impl_bytes <= 0) {
+        *err_no = (impl_bytes < 0) ? errno : ECONNRESET;
+        result = -1;
+        break;
+      }
+      data_sz += (size_t)impl_bytes;
+    }
+    if (result < 0) break;
+    size_t head_sz = (shift) ? (DIRECT_IO_ALIGN - shift) : (0);
+    if (head_sz > data_sz) head_sz = data_sz;
+    size_t body_sz = (data_sz - head_sz) & ~((size_t)DIRECT_IO_ALIGN - 1);
+    size_t tail_sz = data_sz - head_sz - body_sz;
+    if ((pwrite_all(fd, buf + shift, head_sz, offset, err_no) != 0) ||
+        (pwrite_all(direct_fd, buf + shift + head_sz, body_sz, offset + head_sz, err_no) != 0) ||
+        (pwrite_all(fd, buf + shift + head_sz + body_sz, tail_sz, offset + head_sz + body_sz, err_no) != 0)) {
+      result = -1;
+      break;
+    }
+    offset += (off_t)data_sz;
+    *len += data_sz;
+  }
+  put_aligned_buf_pool_t(&direct_buf_pool, buf);
+  return result;
+}
+#endif
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// Window of mapping which covers 'offset'. The previous window is released, so only one window per stream is mapped.
+// CAUTION: access to the pages behind the end of the file which was truncated by somebody else raises SIGBUS.
+//////////////////////////////////////////////////////////////////////////////////////////////////
+static uint8_t* map_stream_window(file_handlers_t* file_handlers, off_t offset, off_t file_sz) {
+  if (file_handlers->map_ptr && (offset >= file_handlers->map_offset) &&
+      (offset < file_handlers->map_offset + (off_t)file_handlers->map_sz))
+    return file_handlers->map_ptr + (offset - file_handlers->map_offset);
+
+  if (file_handlers->map_ptr) munmap(file_handlers->map_ptr, file_handlers->map_sz);
+  file_handlers->map_ptr = NULL;
+
+  off_t page_sz = (off_t)sysconf(_SC_PAGESIZE);
+  off_t map_offset = offset - (offset % page_sz);
+  size_t map_sz = ((file_sz - map_offset) > (off_t)MMAP_WINDOW_SZ) ? (MMAP_WINDOW_SZ) : ((size_t)(file_sz - map_offset));
+  void* map_ptr = mmap(NULL, map_sz, PROT_READ, MAP_SHARED, fileno(file_handlers->fhandle_val), map_offset);
+  if (MAP_FAILED == map_ptr) return NULL;
+  posix_madvise(map_ptr, map_sz, POSIX_MADV_SEQUENTIAL);
+
+  file_handlers->map_ptr = (uint8_t*)map_ptr;
+  file_handlers->map_offset = map_offset;
+  file_handlers->map_sz = map_sz;
+  return file_handlers->map_ptr + (offset - map_offset);
+}
+ssize_t rxs_handler_fread_mmap(uint32_t key, int sockfd, size_t count, size_t* len, uint32_t* err_no) {
+  if (!len || !err_no) return -1;
+
+  *len = 0;
+  *err_no = 0;
+  file_handlers_t* file_handlers = find_stream(key);
+  if (!file_handlers) {
+    // File not found
+    *err_no = ENOENT;
+    return -1;
+  }
+  if (!file_handlers->mmap_mode) return 1;
+
+  FILE* fhandle = file_handlers->fhandle_val;
+  off_t offset = ftello(fhandle);
+  struct stat st;
+  if ((offset < 0) || (fstat(fileno(fhandle), &st) != 0)) {
+    *err_no = errno;
+    return -1;
+  }
+  hint_stream_read(file_handlers, offset, count);
+  //////////////////////////////////////////////////////////////////////////////////
+  // Blocks are the same as by 'rxs_handler_fread()': the last short block is padded by zero in encoder mode
+  //////////////////////////////////////////////////////////////////////////////////
+  static const uint8_t zero_block[1024] = {0};
+  size_t block_sz = ((have_encoder > 0) ? (crypt_packet_sz()) : (crypt_data_sz()));
+  ssize_t result = 0;
+  while ((count - *len) >= block_sz) {
+    size_t data_sz = (offset < st.st_size) ? ((size_t)(st.st_size - offset)) : (0);
+    if (data_sz > block_sz) data_sz = block_sz;
+    if (data_sz > 0) {
+      // Block can cross the end of the window
+      size_t impl_sz = 0;
+      while (impl_sz < data_sz) {
+        uint8_t* data = map_stream_window(file_handlers, offset + (off_t)impl_sz, st.st_size);
+        if (!data) {
+          *err_no = errno;
+          fseeko(fhandle, offset, SEEK_SET);
+          return -1;
+        }
+        size_t part_sz = (size_t)(file_handlers->map_offset + (off_t)file_handlers->map_sz - (offset + (off_t)impl_sz));
+        if (part_sz > data_sz - impl_sz) part_sz = data_sz - impl_sz;
+        if (rxs_send_x(sockfd, data, part_sz) < 0) {
+          *err_no = (errno) ? errno : EIO;
+          fseeko(fhandle, offset, SEEK_SET);
+          return -1;
+        }
+        impl_sz += part_sz;
+      }
+      size_t pad_sz = ((have_encoder > 0) && (data_sz < block_sz)) ? (block_sz - data_sz) : (0);
+      if ((pad_sz > 0) && (rxs_send_x(sockfd, (void*)zero_block, pad_sz) < 0)) {
+        *err_no = (errno) ? errno : EIO;
+        fseeko(fhandle, offset, SEEK_SET);
+        return -1;
+      }
+      offset += (off_t)data_sz;
+      *len += data_sz + pad_sz;
+    }
+    // End of file
+    if (data_sz < block_sz) {
+      result = RXS_EOF;
+      break;
+    }
+  }
+  if (fseeko(fhandle, offset, SEEK_SET) != 0) {
+    *err_no = errno;
+    return -1;
+  }
+  return result;
+}
+#ifndef __QNXNTO__
+// 'sendfile()' blocks on the full socket without time limit, so the other side is waited as by 'rxs_send_x()'
+// Return value: on success returns 0, otherwise -1 and 'err_no' is set
+static ssize_t wait_socket_writable(int sockfd, uint32_t* err_no) {
+  for (;;) {
+    struct pollfd sockfd_poll[1] = {{sockfd, POLLOUT, 0}};
+    int ret_code = poll(sockfd_poll, 1, POLL_TIMEOUT_DATA_MSEC);
+    if (ret_code > 0) return 0;
+    if ((ret_code < 0) && (EINTR == errno)) continue;
+    *err_no = (0 == ret_code) ? ETIMEDOUT : errno;
+    return -1;
+  }
+}
+#endif
+ssize_t rxs_handler_fread_plain(uint32_t key, int sockfd, size_t count, size_t* len, uint32_t* err_no) {
+  if (!len || !err_no) return -1;
+
+  *len = 0;
+#ifdef __QNXNTO__
+  *err_no = ENOSYS;
+  return -1;
+#else
+  file_handlers_t* file_handlers = find_stream(key);
+  if (!file_handlers) {
+    // File not found
+    *err_no = ENOENT;
+    return -1;
+  }
+  FILE* fhandle = file_handlers->fhandle_val;
+  //////////////////////////////////////////////////////////////////////////////////
+  // CAUTION: stdio keeps own buffer and position of the stream. Data are sent from the logical position by offset
+  // (the file offset of the descriptor is not changed by 'sendfile()'), then the stream is moved behind sent data.
+  //////////////////////////////////////////////////////////////////////////////////
+  off_t offset = ftello(fhandle);
+  if ((offset < 0) || (fflush(fhandle) != 0)) {
+    *err_no = errno;
+    return -1;
+  }
+  struct stat st;
+  if (fstat(fileno(fhandle), &st) != 0) {
+    *err_no = errno;
+    return -1;
+  }
+  hint_stream_read(file_handlers, offset, count);
+  if (file_handlers->direct_fd >= 0) {
+    ssize_t result = fread_direct(file_handlers->direct_fd, sockfd, &offset, count, len, err_no);
+    if ((fseeko(fhandle, offset, SEEK_SET) != 0) && !result) {
+      *err_no = errno;
+      result = -1;
+    }
+    if (result != 0) return -1;
+    return (offset >= st.st_size) ? RXS_EOF : 0;
+  }
+  rxs_uring_t* ring = get_io_ring();
+  if (ring) {
+    if (rxs_uring_file_to_socket(ring, fileno(fhandle), sockfd, &offset, count, len) != 0) {
+      *err_no = errno;
+      fseeko(fhandle, offset, SEEK_SET);
+      return -1;
+    }
+  }
+  while (!ring && (*len < count)) {
+    size_t chunk_sz = ((count - *len) > ZERO_COPY_CHUNK_SZ) ? (ZERO_COPY_CHUNK_SZ) : (count - *len);
+    if (wait_socket_writable(sockfd, err_no) != 0) {
+      fseeko(fhandle, offset, SEEK_SET);
+      return -1;
+    }
+    ssize_t impl_bytes = sendfile(sockfd, fileno(fhandle), &offset, chunk_sz);
+    if (impl_bytes < 0) {
+      if (EINTR == errno) continue;
+      *err_no = errno;
+      fseeko(fhandle, offset, SEEK_SET);
+      return -1;
+    }
+    // End of file
+    if (0 == impl_bytes) break;
+    *len += (size_t)impl_bytes;
+  }
+  if (fseeko(fhandle, offset, SEEK_SET) != 0) {
+    *err_no = errno;
+    return -1;
+  }
+  *err_no = 0;
+  return (offset >= st.st_size) ? RXS_EOF : 0;
+#endif
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// Rate limits of the data channels: data are taken from the bucket of the user and the server-wide bucket
+//////////////////////////////////////////////////////////////////////////////////////////////////
+static void take_rate_limit(size_t bytes) {
+  rate_limit_take(rate_limit_user, bytes);
+  rate_limit_take(get_rate_limit_server(), bytes);
+}
+// Shaped data are moved by portions of whole blocks, otherwise by one call
+static size_t rate_limit_portion_sz(size_t count, size_t block_sz) {
+  if (!rate_limit_active(rate_limit_user) && !rate_limit_active(get_rate_limit_server())) return count;
+  size_t portion_sz = RATE_LIMIT_PORTION_SZ - (RATE_LIMIT_PORTION_SZ % block_sz);
+  return (portion_sz > 0) ? (portion_sz) : (block_sz);
+}
+// Ranges adjacent in the file are sent as one run.
+// Return value: index of the range behind the run
+static uint32_t next_range_run(const rxs_range_t* ranges, uint32_t ranges_cnt, uint32_t idx, off_t* offset,
+                               size_t* count) {
+  *offset = (off_t)ranges[idx].offset;
+  *count = (size_t)ranges[idx].len;
+  for (idx++; (idx < ranges_cnt) && (ranges[idx].offset == (uint64_t)*offset + *count); idx++)
+    *count += (size_t)ranges[idx].len;
+  return idx;
+}
+ssize_t rxs_handler_preadv(uint32_t key, int sockfd, rxs_range_t* ranges, uint32_t ranges_cnt, uint32_t* err_no) {
+  if (!err_no || (ranges_cnt && !ranges)) return -1;
+
+  file_handlers_t* file_handlers = find_stream(key);
+  if (!file_handlers) {
+    // File not found
+    *err_no = ENOENT;
+    return -1;
+  }
+  // Lengths are bounded as the batch of the client, so the runs can not overflow
+  uint64_t batch_sz = 0;
+  for (uint32_t i = 0; i < ranges_cnt; i++) {
+    if (ranges[i].len > (RXS_PREADV_BATCH_SZ_MAX - batch_sz)) {
+      *err_no = EINVAL;
+      return -1;
+    }
+    batch_sz += ranges[i].len;
+  }
+  FILE* fhandle = file_handlers->fhandle_val;
+  struct stat st;
+  if ((fflush(fhandle) != 0) || (fstat(fileno(fhandle), &st) != 0)) {
+    *err_no = errno;
+    return -1;
+  }
+  // Ranges are cut by the end of file
+  for (uint32_t i = 0; i < ranges_cnt; i++) {
+    uint64_t file_sz = (uint64_t)st.st_size;
+    if (ranges[i].offset >= file_sz) ranges[i].len = 0;
+    if (ranges[i].len > (file_sz - ranges[i].offset)) ranges[i].len = file_sz - ranges[i].offset;
+  }
+  int fd = fileno(fhandle);
+#ifndef __QNXNTO__
+  //////////////////////////////////////////////////////////////////////////////////
+  // All runs are requested from the disk at once, so the next runs are read while the current one is on the wire
+  //////////////////////////////////////////////////////////////////////////////////
+  if (file_handlers->direct_fd < 0) {
+    for (uint32_t i = 0; i < ranges_cnt;) {
+      off_t offset = 0;
+      size_t count = 0;
+      i = next_range_run(ranges, ranges_cnt, i, &offset, &count);
+      if (count) posix_fadvise(fd, offset, (off_t)count, POSIX_FADV_WILLNEED);
+    }
+  }
+  rxs_uring_t* ring = (file_handlers->direct_fd >= 0) ? (NULL) : (get_io_ring());
+#endif
+  //////////////////////////////////////////////////////////////////////////////////
+  // CAUTION: data are sent by offset, so the position of the stream is not changed
+  //////////////////////////////////////////////////////////////////////////////////
+  for (uint32_t i = 0; i < ranges_cnt;) {
+    off_t offset = 0;
+    size_t count = 0;
+    i = next_range_run(ranges, ranges_cnt, i, &offset, &count);
+    // Shaped run is sent and taken from the buckets by portions
+    size_t portion_sz = rate_limit_portion_sz(count, 1);
+    for (size_t sent_sz = 0; sent_sz < count;) {
+      size_t part_sz = ((count - sent_sz) > portion_sz) ? (portion_sz) : (count - sent_sz);
+      size_t len = 0;
+#ifndef __QNXNTO__
+      if (file_handlers->direct_fd >= 0) {
+        if (fread_direct(file_handlers->direct_fd, sockfd, &offset, part_sz, &len, err_no) != 0) return -1;
+      } else if (ring) {
+        if (rxs_uring_file_to_socket(ring, fd, sockfd, &offset, part_sz, &len) != 0) {
+          *err_no = errno;
+          return -1;
+        }
+      }
+      while (!ring && (file_handlers->direct_fd < 0) && (len < part_sz)) {
+        size_t chunk_sz = ((part_sz - len) > ZERO_COPY_CHUNK_SZ) ? (ZERO_COPY_CHUNK_SZ) : (part_sz - len);
+        if (wait_socket_writable(sockfd, err_no) != 0) return -1;
+        ssize_t impl_bytes = sendfile(sockfd, fd, &offset, chunk_sz);
+        if (impl_bytes < 0) {
+          if (EINTR == errno) continue;
+          *err_no = errno;
+          return -1;
+        }
+        if (0 == impl_bytes) break;
+        len += (size_t)impl_bytes;
+      }
+#else
+      uint8_t buf[MAX_PORTION_DATA_BYTES];
+      while (len < part_sz) {
+        size_t chunk_sz = ((part_sz - len) > sizeof(buf)) ? (sizeof(buf)) : (part_sz - len);
+        ssize_t impl_bytes = pread(fd, buf, chunk_sz, offset + (off_t)len);
+        if ((impl_bytes < 0) && (EINTR == errno)) continue;
+        if ((impl_bytes <= 0) || (rxs_send_x(sockfd, buf, (size_t)impl_bytes) < 0)) break;
+        len += (size_t)impl_bytes;
+      }
+      offset += (off_t)len;
+#endif
+      take_rate_limit(len);
+      // The file is truncated while it is sent
+      if (len != part_sz) {
+        *err_no = EIO;
+        return -1;
+      }
+      sent_sz += len;
+    }
+  }
+  *err_no = 0;
+  return 0;
+}
+// Account data written to the stream. The stream is committed every N MB by 'DURABILITY_PERIODIC'
+static int commit_stream_written(file_handlers_t* file_handlers, size_t written_sz) {
+  file_handlers->dirty_sz += written_sz;
+  if (file_handlers->durability != DURABILITY_PERIODIC) return 0;
+
+  uint32_t periodic_mb = 0;
+  get_durability_policy(&periodic_mb);
+  if (file_handlers->dirty_sz < ((uint64_t)periodic_mb << 20)) return 0;
+
+  file_handlers->dirty_sz = 0;
+  if ((flush_write_behind_file_handlers_t(file_handlers) != 0) || (fflush(file_handlers->fhandle_val) != 0)) return -1;
+  return durable_commit_fd(fileno(file_handlers->fhandle_val), DURABILITY_PERIODIC);
+}
+// Receive data from the socket and write it to the file by the large buffer
+static ssize_t fwrite_recv_pwrite(int sockfd, int fd, off_t offset, size_t count, size_t* len, uint32_t* err_no) {
+  size_t buf_sz = (count > ZERO_COPY_CHUNK_SZ) ? (ZERO_COPY_CHUNK_SZ) : (count);
+  uint8_t* buf = malloc(buf_sz);
+  if (!buf) {
+    *err_no = errno;
+    return -1;
+  }
+  while (*len < count) {
+    size_t chunk_sz = ((count - *len) > buf_sz) ? (buf_sz) : (count - *len);
+    ssize_t impl_bytes = rxs_recv_x(sockfd, buf, chunk_sz);
+    if (impl_bytes <= 0) {
+      *err_no = (impl_bytes < 0) ? errno : ECONNRESET;
+      // Free memory
+      free(buf);
+      return -1;
+    }
+    size_t write_bytes = 0;
+    while (write_bytes < (size_t)impl_bytes) {
+      ssize_t res = pwrite(fd, buf + write_bytes, (size_t)impl_bytes - write_bytes, offset + write_bytes);
+      if (res < 0) {
+        if (EINTR == errno) continue;
+        *err_no = errno;
+        // Free memory
+        free(buf);
+        return -1;
+      }
+      write_bytes += (size_t)res;
+    }
+    offset += impl_bytes;
+    *len += (size_t)impl_bytes;
+  }
+  // Free memory
+  free(buf);
+  return 0;
+}
+#ifndef __QNXNTO__
+// Write 'count' bytes left in the pipe to the file from 'offset' by the buffer
+// Return value: on success returns 0, otherwise -1 and 'err_no' is set
+static ssize_t drain_pipe_pwrite(int pipefd, int fd, off_t offset, size_t count, uint32_t* err_no) {
+  uint8_t* buf = malloc(count);
+  if (!buf) {
+    *err_no = errno;
+    return -1;
+  }
+  size_t read_bytes = 0;
+  while (read_bytes < count) {
+    ssize_t res = read(pipefd, buf + read_bytes, count - read_bytes);
+    if ((res < 0) && (EINTR == errno)) continue;
+    if (res <= 0) {
+      *err_no = (res < 0) ? errno : EIO;
+      // Free memory
+      free(buf);
+      return -1;
+    }
+    read_bytes += (size_t)res;
+  }
+  size_t write_bytes = 0;
+  while (write_bytes < count) {
+    ssize_t res = pwrite(fd, buf + write_bytes, count - write_bytes, offset + (off_t)write_bytes);
+    if (res < 0) {
+      if (EINTR == errno) continue;
+      *err_no = errno;
+      // Free memory
+      free(buf);
+      return -1;
+    }
+    write_bytes += (size_t)res;
+  }
+  // Free memory
+  free(buf);
+  return 0;
+}
+// Move data from the socket to the file through the pipe from 'offset'. Returns 1 if 'splice()' is not supported for
+// these files: the data taken from the socket are written already, the rest is left to the caller
+static ssize_t fwrite_splice(int sockfd, int fd, off_t offset, size_t count, size_t* len, uint32_t* err_no) {
+  int pipefd[2] = {-1, -1};
+  if (pipe(pipefd) != 0) return 1;
+  // Larger pipe gives less calls, but the default size is enough for work
+  fcntl(pipefd[1], F_SETPIPE_SZ, ZERO_COPY_CHUNK_SZ);
+
+  ssize_t result = 0;
+  while (*len < count) {
+    struct pollfd sockfd_poll[1] = {{sockfd, POLLIN, 0}};
+    int ret_code = poll(sockfd_poll, 1, POLL_TIMEOUT_DATA_MSEC);
+    if (ret_code <= 0) {
+      if ((ret_code < 0) && (EINTR == errno)) continue;
+      *err_no = (0 == ret_code) ? ETIMEDOUT : errno;
+      result = -1;
+      break;
+    }
+    size_t chunk_sz = ((count - *len) > ZERO_COPY_CHUNK_SZ) ? (ZERO_COPY_CHUNK_SZ) : (count - *len);
+    ssize_t impl_bytes = splice(sockfd, NULL, pipefd[1], NULL, chunk_sz, SPLICE_F_MOVE | SPLICE_F_MORE);
+    if (impl_bytes < 0) {
+      if (EINTR == errno) continue;
+      *err_no = errno;
+      // Nothing is received yet: caller can use the other way
+      result = ((0 == *len) && ((EINVAL == errno) || (ENOSYS == errno))) ? (1) : (-1);
+      break;
+    }
+    if (0 == impl_bytes) {
+      // The other side has closed connection
+      *err_no = ECONNRESET;
+      result = -1;
+      break;
+    }
+    // Drain the pipe to the file
+    ssize_t left_bytes = impl_bytes;
+    while (left_bytes > 0) {
+      ssize_t res = splice(pipefd[0], NULL, fd, NULL, (size_t)left_bytes, SPLICE_F_MOVE);
+      if (res < 0) {
+        if (EINTR == errno) continue;
+        // The file system can not take data from the pipe (no 'splice_write'): data of the pipe are written by the
+        // buffer, so the channel is kept in sync
+        off_t write_offset = offset + (off_t)(*len + (size_t)(impl_bytes - left_bytes));
+        result = (drain_pipe_pwrite(pipefd[0], fd, write_offset, (size_t)left_bytes, err_no) != 0) ? (-1) : (1);
+        break;
+      }
+      left_bytes -= res;
+    }
+    if (result < 0) break;
+    *len += (size_t)impl_bytes;
+    if (1 == result) break;
+  }
+  close(pipefd[0]);
+  close(pipefd[1]);
+  return result;
+}
+#endif
+ssize_t rxs_handler_fwrite_plain(uint32_t key, int sockfd, size_t count, size_t* len, uint32_t* err_no) {
+  if (!len || !err_no) return -1;
+
+  *len = 0;
+  *err_no = 0;
+  file_handlers_t* file_handlers = find_stream(key);
+  if (!file_handlers) {
+    // File not found
+    *err_no = ENOENT;
+    return -1;
+  }
+  FILE* fhandle = file_handlers->fhandle_val;
+  int fd = fileno(fhandle);
+  //////////////////////////////////////////////////////////////////////////////////
+  // CAUTION: stdio keeps own buffer and position of the stream. Flush it and put the descriptor to the logical position,
+  // at the end move the stream behind written data.
+  //////////////////////////////////////////////////////////////////////////////////
+  off_t offset = ftello(fhandle);
+  if ((offset < 0) || (fflush(fhandle) != 0)) {
+    *err_no = errno;
+    return -1;
+  }
+  // CAUTION: 'splice()' does not write to a file in append mode. The stream is owned by this session, so append mode is
+  // turned off while data are written to the end of file
+  int flags = fcntl(fd, F_GETFL);
+  if (flags < 0) {
+    *err_no = errno;
+    return -1;
+  }
+  if (flags & O_APPEND) {
+    offset = lseek(fd, 0, SEEK_END);
+    if ((offset < 0) || (fcntl(fd, F_SETFL, flags & ~O_APPEND) < 0)) {
+      *err_no = errno;
+      return -1;
+    }
+  }
+  if (lseek(fd, offset, SEEK_SET) < 0) {
+    *err_no = errno;
+    if (flags & O_APPEND) fcntl(fd, F_SETFL, flags);
+    return -1;
+  }
+  ssize_t result = 1;
+  rxs_uring_t* ring = (file_handlers->direct_fd >= 0) ? (NULL) : (get_io_ring());
+#ifndef __QNXNTO__
+  if (file_handlers->direct_fd >= 0)
+    result = fwrite_direct(sockfd, fd, file_handlers->direct_fd, offset, count, len, err_no);
+#endif
+  if (ring) {
+    off_t ring_offset = offset;
+    result = rxs_uring_socket_to_file(ring, sockfd, fd, &ring_offset, count, len);
+    if (result != 0) *err_no = errno;
+  }
+#ifndef __QNXNTO__
+  if (1 == result) result = fwrite_splice(sockfd, fd, offset, count, len, err_no);
+#endif
+  // 'splice()' is not supported: the rest is written by the buffer
+  if (1 == result) {
+    *err_no = 0;
+    result = fwrite_recv_pwrite(sockfd, fd, offset + (off_t)*len, count, len, err_no);
+  }
+  if (flags & O_APPEND) fcntl(fd, F_SETFL, flags);
+  if ((commit_stream_written(file_handlers, *len) != 0) && !result) {
+    *err_no = errno;
+    result = -1;
+  }
+  // Move the stream behind written data
+  if (fseeko(fhandle, offset + *len, SEEK_SET) != 0 && !result) {
+    *err_no = errno;
+    result = -1;
+  }
+  return result;
+}
 ssize_t rxs_handler_fwrite(uint32_t key, uint8_t* data, uint32_t len, uint32_t* err_no) {
   if (!data || !err_no) return -1;
 
-  const dlist_t* node = list_cfind(file_handlers_lst, &key, cmp_file_handlers_t_uint32_t);
-  if (node && key) {
+  file_handlers_t* file_handlers = find_file_handlers_tbl_t(&file_handlers_tbl, key);
+  if (file_handlers) {
     size_t data_sz = ((have_encoder > 0) ? (crypt_packet_sz()) : (len));
-    file_handlers_t* file_handlers = (file_handlers_t*)node->data;
-    size_t impl_bytes = fwrite(data, sizeof(uint8_t), data_sz, file_handlers->fhandle_val);
-    if (impl_bytes != data_sz) log_msg(ERRN, 6, "fwrite", strerror(errno));
-    *err_no = errno;
+    *err_no = 0;
+    //////////////////////////////////////////////////////////////////////////////////
+    // CAUTION: error of the deferred write fails the call. It is kept until the answer is sent to the other side
+    // (see 'rxs_fwrite_stream()')
+    //////////////////////////////////////////////////////////////////////////////////
+    if (!file_handlers->wb_err && (write_behind_file_handlers_t(file_handlers, data, data_sz, write_behind_mb) != 0) &&
+        !file_handlers->wb_err) {
+      // Without the buffer the stream is written by stdio
+      if (fwrite(data, sizeof(uint8_t), data_sz, file_handlers->fhandle_val) != data_sz) {
+        *err_no = (errno) ? (errno) : (EIO);
+        log_msg(ERRN, 6, "fwrite", strerror(*err_no));
+        return -1;
+      }
+    }
+    if (file_handlers->wb_err) {
+      *err_no = (uint32_t)file_handlers->wb_err;
+      log_msg(ERRN, 6, "write_behind_file_handlers_t", strerror(*err_no));
+      return -1;
+    }
+    if (commit_stream_written(file_handlers, data_sz) != 0) {
+      *err_no = errno;
+      log_msg(ERRN, 6, "durable_commit_fd", strerror(*err_no));
+      return -1;
+    }
     return 0;
   } else {
     *err_no = ENOENT;
@@ -652,11 +1470,16 @@ ssize_t rxs_handler_fwrite(uint32_t key, uint8_t* data, uint32_t len, uint32_t*
 ssize_t rxs_handler_fflush(uint32_t key, int* status, uint32_t* err_no) {
   if (!status || !err_no) return -1;
 
-  const dlist_t* node = list_cfind(file_handlers_lst, &key, cmp_file_handlers_t_uint32_t);
-  if (node && key) {
-    file_handlers_t* file_handlers = (file_handlers_t*)node->data;
+  file_handlers_t* file_handlers = find_stream(key);
+  if (file_handlers) {
     *status = fflush(file_handlers->fhandle_val);
     *err_no = errno;
+    // Error of the deferred write
+    if (file_handlers->wb_err) {
+      *status = EOF;
+      *err_no = (uint32_t)file_handlers->wb_err;
+      file_handlers->wb_err = 0;
+    }
     return 0;
   } else {
     *err_no = ENOENT;
@@ -666,18 +1489,34 @@ ssize_t rxs_handler_fflush(uint32_t key, int* status, uint32_t* err_no) {
 ssize_t rxs_handler_fclose(uint32_t key, int* status, uint32_t* err_no) {
   if (!status || !err_no) return -1;
 
-  const dlist_t* node = list_cfind(file_handlers_lst, &key, cmp_file_handlers_t_uint32_t);
-  if (node && key) {
-    file_handlers_t* file_handlers = (file_handlers_t*)node->data;
+  file_handlers_t* file_handlers = find_stream(key);
+  if (file_handlers) {
+    //////////////////////////////////////////////////////////////////////////////////
+    // Commit written data by the policy of the stream. Error of the commit is the error of close.
+    //////////////////////////////////////////////////////////////////////////////////
+    int commit_status = (file_handlers->wb_err) ? (EOF) : (0);
+    uint32_t commit_err_no = (uint32_t)file_handlers->wb_err;
+    if ((0 == commit_status) && (file_handlers->dirty_sz > 0)) {
+      commit_status = fflush(file_handlers->fhandle_val);
+      if (0 == commit_status)
+        commit_status = durable_commit_fd(fileno(file_handlers->fhandle_val), file_handlers->durability);
+      if (commit_status != 0) {
+        commit_err_no = errno;
+        log_msg(ERRN, 6, "durable_commit_fd", strerror(errno));
+      }
+    }
     *status = fclose(file_handlers->fhandle_val);
     *err_no = errno;
+    if (commit_status != 0) {
+      *status = commit_status;
+      *err_no = commit_err_no;
+    }
     // Reset values
     file_handlers->fhandle_val = NULL;
-    // file_handlers->fhandle_key = 0;
     //////////////////////////////////////////////////////////////////////////////////
-    // Delete FILE handler into the map/list
+    // Release the slot of the table
     //////////////////////////////////////////////////////////////////////////////////
-    list_remove_if(&file_handlers_lst, &key, cmp_file_handlers_t_uint32_t, free_file_handlers_t);
+    remove_file_handlers_tbl_t(&file_handlers_tbl, key);
 
     return 0;
   } else {
@@ -685,26 +1524,33 @@ ssize_t rxs_handler_fclose(uint32_t key, int* status, uint32_t* err_no) {
     return -1;
   }
 }
-ssize_t rxs_handler_fseek(uint32_t key, uint32_t val2, uint32_t val3, int* status, uint32_t* err_no) {
-  if (!status || !err_no) return -1;
+// Write-behind buffer of the stream is flushed by 'find_stream()', so the end of file is actual for SEEK_END
+ssize_t rxs_handler_fseek(uint32_t key, int64_t offset, int whence, int64_t* position, uint32_t* err_no) {
+  if (!position || !err_no) return -1;
 
-  const dlist_t* node = list_cfind(file_handlers_lst, &key, cmp_file_handlers_t_uint32_t);
-  if (node && key) {
-    file_handlers_t* file_handlers = (file_handlers_t*)node->data;
-    *status = fseek(file_handlers->fhandle_val, val2, val3);
-    *err_no = errno;
-    return 0;
-  } else {
+  file_handlers_t* file_handlers = find_stream(key);
+  if (!file_handlers) {
+    // File not found
     *err_no = ENOENT;
     return -1;
   }
+  if (fseeko(file_handlers->fhandle_val, (off_t)offset, whence) != 0) {
+    *err_no = errno;
+    return -1;
+  }
+  off_t pos = ftello(file_handlers->fhandle_val);
+  if (pos < 0) {
+    *err_no = errno;
+    return -1;
+  }
+  *position = (int64_t)pos;
+  return 0;
 }
 ssize_t rxs_handler_ftell(uint32_t key, long* status, uint32_t* err_no) {
   if (!status || !err_no) return -1;
 
-  const dlist_t* node = list_cfind(file_handlers_lst, &key, cmp_file_handlers_t_uint32_t);
-  if (node && key) {
-    file_handlers_t* file_handlers = (file_handlers_t*)node->data;
+  file_handlers_t* file_handlers = find_stream(key);
+  if (file_handlers) {
     *status = ftell(file_handlers->fhandle_val);
     *err_no = errno;
     return 0;
@@ -716,9 +1562,8 @@ ssize_t rxs_handler_ftell(uint32_t key, long* status, uint32_t* err_no) {
 ssize_t rxs_handler_rewind(uint32_t key, int* status, uint32_t* err_no) {
   if (!status || !err_no) return -1;
 
-  const dlist_t* node = list_cfind(file_handlers_lst, &key, cmp_file_handlers_t_uint32_t);
-  if (node && key) {
-    file_handlers_t* file_handlers = (file_handlers_t*)node->data;
+  file_handlers_t* file_handlers = find_stream(key);
+  if (file_handlers) {
     rewind(file_handlers->fhandle_val);
 
     *status = 0;
@@ -730,6 +1575,22 @@ ssize_t rxs_handler_rewind(uint32_t key, int* status, uint32_t* err_no) {
     return -1;
   }
 }
+// Move the stream to 'offset' of positioned read/write. Write-behind buffer of the stream is flushed by 'find_stream()'
+ssize_t rxs_handler_seek(uint32_t key, uint64_t offset, uint32_t* err_no) {
+  if (!err_no) return -1;
+
+  file_handlers_t* file_handlers = find_stream(key);
+  if (!file_handlers) {
+    // File not found
+    *err_no = ENOENT;
+    return -1;
+  }
+  if ((offset > (uint64_t)INT64_MAX) || (fseeko(file_handlers->fhandle_val, (off_t)offset, SEEK_SET) != 0)) {
+    *err_no = (offset > (uint64_t)INT64_MAX) ? (EINVAL) : (errno);
+    return -1;
+  }
+  return 0;
+}
 ssize_t rxs_handler_is_file(uint8_t* data, int* status, uint32_t* err_no) {
   if (!data || !status || !err_no) return -1;
 
@@ -752,6 +1613,221 @@ ssize_t rxs_handler_is_dir(uint8_t* data, int* status, uint32_t* err_no) {
   else
     return -1;
 }
+// Send EOF of operation 'fread' and wait confirm from other side
+static ssize_t rxs_fread_eof(rxs_operation_t operation, uint32_t stream, size_t total_impl_channel_sz) {
+  if (rxs_send_packet_x04(get_socket_connected(), SC_B0, operation, stream, total_impl_channel_sz, RXS_EOF) < 0) {
+    log_msg(ERRN, 6, "rxs_send_packet_x04", strerror(errno));
+    close_stream_socket(stream);
+    return -1;
+  }
+  //////////////////////////////////////////////////////////////////////////////////
+  // Wait confirm to other side for to close operation 'fread'
+  //////////////////////////////////////////////////////////////////////////////////
+  rxs_type_t type;
+  uint32_t other_side_stream = 0;
+  uint32_t other_side_data_sz = 0;
+  uint16_t other_side_eof = 0;
+  if (rxs_recv_packet_x04(get_socket_connected(), &type, operation, &other_side_stream, &other_side_data_sz,
+                          &other_side_eof) == 0) {
+    if ((type == CS_A0) || (stream == other_side_stream)) return 0;
+  }
+  close_stream_socket(stream);
+  return -1;
+}
+// Send data of the stream from the current position to the data channel, at most 'buf_sz' by whole blocks
+static ssize_t rxs_fread_stream(rxs_operation_t operation, uint32_t stream, uint32_t buf_sz) {
+  uint32_t read_data_bytes = 0;
+  size_t block_sz = ((have_encoder > 0) ? (crypt_packet_sz()) : (crypt_data_sz()));
+#ifndef __QNXNTO__
+  //////////////////////////////////////////////////////////////////////////////////
+  // Plain mode: the file is sent to the data socket by the kernel in large chunks. The amount of data is the same
+  // as by blocks: the whole blocks are fitted into buffer of other side.
+  //////////////////////////////////////////////////////////////////////////////////
+  if (!have_encoder && (buf_sz >= block_sz)) {
+    size_t count = buf_sz - (buf_sz % block_sz);
+    size_t portion_sz = rate_limit_portion_sz(count, block_sz);
+    size_t total_impl_bytes = 0;
+    ssize_t result = 0;
+    while ((0 == result) && (total_impl_bytes < count)) {
+      size_t impl_bytes = 0;
+      uint32_t err_no = 0;
+      size_t part_sz = ((count - total_impl_bytes) > portion_sz) ? (portion_sz) : (count - total_impl_bytes);
+      result = rxs_handler_fread_plain(stream, get_stream_socket(stream), part_sz, &impl_bytes, &err_no);
+      if (result < 0) {
+        log_msg(ERRN, 6, "rxs_handler_fread_plain", strerror(err_no));
+        close_stream_socket(stream);
+        return -1;
+      }
+      total_impl_bytes += impl_bytes;
+      take_rate_limit(impl_bytes);
+      // The file is truncated while it is sent
+      if (impl_bytes < part_sz) break;
+    }
+    if (RXS_EOF == result) return rxs_fread_eof(operation, stream, total_impl_bytes);
+    //////////////////////////////////////////////////////////////////////////////////
+    // Send confirm to other side
+    //////////////////////////////////////////////////////////////////////////////////
+    rxs_send_packet_x04(get_socket_connected(), SC_B0, operation, stream, total_impl_bytes, 0);
+    return 0;
+  }
+#endif
+
+  //////////////////////////////////////////////////////////////////////////////////
+  // Mapped stream: blocks are sent straight from the mapping of the file
+  //////////////////////////////////////////////////////////////////////////////////
+  {
+    size_t portion_sz = rate_limit_portion_sz(buf_sz, block_sz);
+    size_t total_impl_bytes = 0;
+    ssize_t result = 0;
+    while ((0 == result) && ((buf_sz - total_impl_bytes) >= block_sz)) {
+      size_t impl_bytes = 0;
+      uint32_t err_no = 0;
+      size_t part_sz = ((buf_sz - total_impl_bytes) > portion_sz) ? (portion_sz) : (buf_sz - total_impl_bytes);
+      result = rxs_handler_fread_mmap(stream, get_stream_socket(stream), part_sz, &impl_bytes, &err_no);
+      if (result < 0) {
+        log_msg(ERRN, 6, "rxs_handler_fread_mmap", strerror(err_no));
+        close_stream_socket(stream);
+        return -1;
+      }
+      total_impl_bytes += impl_bytes;
+      take_rate_limit(impl_bytes);
+    }
+    if (RXS_EOF == result) return rxs_fread_eof(operation, stream, total_impl_bytes);
+    if (0 == result) {
+      rxs_send_packet_x04(get_socket_connected(), SC_B0, operation, stream, total_impl_bytes, 0);
+      return 0;
+    }
+  }
+
+  size_t total_impl_sz = 0;
+  size_t total_impl_channel_sz = 0;
+  while (total_impl_channel_sz < buf_sz) {
+    // Check total size
+    if ((buf_sz - total_impl_channel_sz) < block_sz) break;
+
+    uint8_t* data = NULL;
+    uint32_t err_no = 0;
+    ssize_t result = rxs_handler_fread(stream, &data, &read_data_bytes, &err_no);
+    if ((0 == result) || (RXS_EOF == result)) {
+      ssize_t impl_bytes = rxs_send_x(get_stream_socket(stream), data, read_data_bytes);
+      if (data) {
+        free(data);
+        data = NULL;
+      }
+      if (impl_bytes < 0) {
+        log_msg(ERRN, 6, "rxs_send_x", strerror(errno));
+        close_stream_socket(stream);
+        return -1;
+      }
+      total_impl_channel_sz += (size_t)impl_bytes;
+      total_impl_sz += read_data_bytes;
+      take_rate_limit((size_t)impl_bytes);
+
+      if (RXS_EOF == result) return rxs_fread_eof(operation, stream, total_impl_channel_sz);
+    } else {
+      log_msg(ERRN, 6, "rxs_handler_fread", strerror(errno));
+      if (data) {
+        free(data);
+        data = NULL;
+      }
+      close_stream_socket(stream);
+      return -1;
+    }
+  }
+  //////////////////////////////////////////////////////////////////////////////////
+  // Send confirm to other side
+  //////////////////////////////////////////////////////////////////////////////////
+  rxs_send_packet_x04(get_socket_connected(), SC_B0, operation, stream, total_impl_channel_sz, 0);
+  // printf("DBG: ALL buf:%d | ch:%d tot:%d \n", buf_sz, total_impl_channel_sz, total_impl_sz);
+  return 0;
+}
+// Error of the deferred write is reported once: it is cleared after the answer is sent
+static void clear_write_behind_error(uint32_t key) {
+  file_handlers_t* file_handlers = find_file_handlers_tbl_t(&file_handlers_tbl, key);
+  if (file_handlers) file_handlers->wb_err = 0;
+}
+// Receive 'data_sz' bytes of the data channel to the stream from the current position
+static ssize_t rxs_fwrite_stream(rxs_operation_t operation, uint32_t stream, uint32_t data_sz) {
+  //////////////////////////////////////////////////////////////////////////////////
+  // Plain mode: the data are moved from the data socket to the file in large chunks
+  //////////////////////////////////////////////////////////////////////////////////
+  if (!have_encoder) {
+    size_t portion_sz = rate_limit_portion_sz(data_sz, 1);
+    size_t total_impl_bytes = 0;
+    while (total_impl_bytes < data_sz) {
+      size_t impl_bytes = 0;
+      uint32_t err_no = 0;
+      size_t part_sz = ((data_sz - total_impl_bytes) > portion_sz) ? (portion_sz) : (data_sz - total_impl_bytes);
+      ssize_t result = rxs_handler_fwrite_plain(stream, get_stream_socket(stream), part_sz, &impl_bytes, &err_no);
+      total_impl_bytes += impl_bytes;
+      if (result < 0) {
+        log_msg(ERRN, 6, "rxs_handler_fwrite_plain", strerror(err_no));
+        close_stream_socket(stream);
+        rxs_send_packet_x04(get_socket_connected(), SC_B1, operation, stream, (uint32_t)total_impl_bytes, 0);
+        return -1;
+      }
+      take_rate_limit(impl_bytes);
+    }
+    //////////////////////////////////////////////////////////////////////////////////
+    // Send confirm to other side
+    //////////////////////////////////////////////////////////////////////////////////
+    rxs_send_packet_x04(get_socket_connected(), SC_B0, operation, stream, data_sz, 0);
+    return 0;
+  }
+  float data_only_sz = data_sz;
+  uint32_t number_block = 0;
+  uint32_t number_block_total = (uint32_t)ceil_x(data_only_sz / MAX_PORTION_DATA_BYTES);
+
+  size_t buf_sz = ((have_encoder > 0) ? (crypt_packet_sz()) : (crypt_data_sz()));
+  uint8_t* recv_buf = calloc(buf_sz, sizeof(uint8_t));
+  if (!recv_buf) {
+    log_msg(ERRN, 6, "calloc", strerror(errno));
+    close_stream_socket(stream);
+    rxs_send_packet_x04(get_socket_connected(), SC_B1, operation, stream, 0, 0);
+    return -1;
+  }
+
+  size_t total_impl_bytes = 0;
+  uint8_t is_full = 0;
+  while (!is_full) {
+    // memset(recv_buf, 0, buf_sz);
+    errno = 0;
+    ssize_t impl_bytes = rxs_recv_x(get_stream_socket(stream), recv_buf, buf_sz);
+    if ((impl_bytes < 0)) {
+      log_msg(ERRN, 6, "rxs_recv_x", strerror(errno));
+      // Free memory
+      free(recv_buf);
+      recv_buf = NULL;
+      close_stream_socket(stream);
+      rxs_send_packet_x04(get_socket_connected(), SC_B1, operation, stream, 0, 0);
+      return -1;
+    }
+    total_impl_bytes += (size_t)impl_bytes;
+    ++number_block;
+    take_rate_limit((size_t)impl_bytes);
+    // Success
+    uint32_t err_no;
+    if (rxs_handler_fwrite(stream, recv_buf, (size_t)impl_bytes, &err_no) < 0) {
+      // Free memory
+      free(recv_buf);
+      recv_buf = NULL;
+      close_stream_socket(stream);
+      if (rxs_send_packet_x04(get_socket_connected(), SC_B1, operation, stream, (uint32_t)impl_bytes, 0) >= 0)
+        clear_write_behind_error(stream);
+      return -1;
+    }
+    // It's end of whole data
+    if ((!have_encoder && (total_impl_bytes == data_sz)) || (have_encoder && (number_block == number_block_total)))
+      is_full = 1;
+  }
+  free(recv_buf);
+  recv_buf = NULL;
+  //////////////////////////////////////////////////////////////////////////////////
+  // Send confirm to other side
+  //////////////////////////////////////////////////////////////////////////////////
+  rxs_send_packet_x04(get_socket_connected(), SC_B0, operation, stream, data_sz, 0);
+  return 0;
+}
 //
 ssize_t run_operation(rxs_operation_t operation, packet_rxs_t* packet_rxs_recv, packet_rxs_t* packet_rxs_send) {
   //////////////////////////////////////////////////////////////////////////////////
@@ -1079,7 +2155,7 @@ ssize_t run_operation(rxs_operation_t operation, packet_rxs_t* packet_rxs_recv,
         return -1;
       }
       port = ntohs(slot05.port);
-      ssize_t status = rxs_data_point_create_server(port);
+      ssize_t status = rxs_data_point_create_server(slot05.stream_id, port);
       //////////////////////////////////////////////////////////////////////////////////
       // RESP
       //////////////////////////////////////////////////////////////////////////////////
@@ -1128,73 +2204,7 @@ ssize_t run_operation(rxs_operation_t operation, packet_rxs_t* packet_rxs_recv,
       uint32_t buf_sz = slot04.data_sz;
       uint32_t stream = slot04.val1;
       dinit_slot04_t(&slot04);
-
-      uint32_t read_data_bytes = 0;
-      size_t block_sz = ((have_encoder > 0) ? (crypt_packet_sz()) : (crypt_data_sz()));
-
-      size_t total_impl_sz = 0;
-      size_t total_impl_channel_sz = 0;
-      while (total_impl_channel_sz < buf_sz) {
-        // Check total size
-        if ((buf_sz - total_impl_channel_sz) < block_sz) break;
-
-        uint8_t* data = NULL;
-        uint32_t err_no = 0;
-        ssize_t result = rxs_handler_fread(stream, &data, &read_data_bytes, &err_no);
-        if ((0 == result) || (RXS_EOF == result)) {
-          ssize_t impl_bytes = rxs_send_x(get_socket_data(), data, read_data_bytes);
-          if (data) {
-            free(data);
-            data = NULL;
-          }
-          if (impl_bytes < 0) {
-            log_msg(ERRN, 6, "rxs_send_x", strerror(errno));
-            rxs_data_point_close();
-            return -1;
-          }
-          total_impl_channel_sz += (size_t)impl_bytes;
-          total_impl_sz += read_data_bytes;
-
-          if (RXS_EOF == result) {
-            if (rxs_send_packet_x04(get_socket_connected(), SC_B0, operation_fread, stream, total_impl_channel_sz,
-                                    RXS_EOF) < 0) {
-              log_msg(ERRN, 6, "rxs_send_packet_x04", strerror(errno));
-              rxs_data_point_close();
-              return -1;
-            }
-            //////////////////////////////////////////////////////////////////////////////////
-            // Wait confirm to other side for to close operation 'fread'
-            //////////////////////////////////////////////////////////////////////////////////
-            rxs_type_t type;
-            uint32_t other_side_stream = 0;
-            uint32_t other_side_data_sz = 0;
-            uint16_t other_side_eof = 0;
-            if (rxs_recv_packet_x04(get_socket_connected(), &type, operation_fread, &other_side_stream,
-                                    &other_side_data_sz, &other_side_eof) == 0) {
-              if ((type == CS_A0) || (stream == other_side_stream)) {
-                return 0;
-              } else {
-                rxs_data_point_close();
-                return -1;
-              }
-            }
-          }
-        } else {
-          log_msg(ERRN, 6, "rxs_handler_fread", strerror(errno));
-          if (data) {
-            free(data);
-            data = NULL;
-          }
-          rxs_data_point_close();
-          return -1;
-        }
-      }
-      //////////////////////////////////////////////////////////////////////////////////
-      // Send confirm to other side
-      //////////////////////////////////////////////////////////////////////////////////
-      rxs_send_packet_x04(get_socket_connected(), SC_B0, operation_fread, stream, total_impl_channel_sz, 0);
-      // printf("DBG: ALL buf:%d | ch:%d tot:%d \n", buf_sz, total_impl_channel_sz, total_impl_sz);
-      return 0;
+      return rxs_fread_stream(operation, stream, buf_sz);
     }
     case operation_fwrite: {
       slot04_t slot04;
@@ -1208,57 +2218,70 @@ ssize_t run_operation(rxs_operation_t operation, packet_rxs_t* packet_rxs_recv,
       uint32_t data_sz = slot04.data_sz;
       uint32_t stream = slot04.val1;
       dinit_slot04_t(&slot04);
-
-      float data_only_sz = data_sz;
-      uint32_t number_block = 0;
-      uint32_t number_block_total = (uint32_t)ceil_x(data_only_sz / MAX_PORTION_DATA_BYTES);
-
-      size_t buf_sz = ((have_encoder > 0) ? (crypt_packet_sz()) : (crypt_data_sz()));
-      uint8_t* recv_buf = calloc(buf_sz, sizeof(uint8_t));
-      if (!recv_buf) {
-        log_msg(ERRN, 6, "calloc", strerror(errno));
-        rxs_data_point_close();
-        rxs_send_packet_x04(get_socket_connected(), SC_B1, operation_fwrite, stream, 0, 0);
+      return rxs_fwrite_stream(operation, stream, data_sz);
+    }
+    case operation_pread:
+    case operation_pwrite: {
+      slot06_t slot06;
+      init_slot06_t(&slot06);
+      if (deserialize_slot06_t(packet_rxs_recv->data, (packet_rxs_recv->sz - hdr_packet_rxs_t_sz()), &slot06) < 0) {
+        log_msg(ERRN, 6, "deserialize_slot06_t", "");
+        // Free memory
+        dinit_slot06_t(&slot06);
         return -1;
       }
+      uint32_t data_sz = slot06.data_sz;
+      uint32_t stream = slot06.stream_id;
+      uint64_t offset = slot06.offset;
+      dinit_slot06_t(&slot06);
 
-      size_t total_impl_bytes = 0;
-      uint8_t is_full = 0;
-      while (!is_full) {
-        // memset(recv_buf, 0, buf_sz);
-        errno = 0;
-        ssize_t impl_bytes = rxs_recv_x(get_socket_data(), recv_buf, buf_sz);
-        if ((impl_bytes < 0)) {
-          log_msg(ERRN, 6, "rxs_recv_x", strerror(errno));
-          // Free memory
-          free(recv_buf);
-          recv_buf = NULL;
-          rxs_data_point_close();
-          rxs_send_packet_x04(get_socket_connected(), SC_B1, operation_fwrite, stream, 0, 0);
-          return -1;
-        }
-        total_impl_bytes += (size_t)impl_bytes;
-        ++number_block;
-        // Success
-        uint32_t err_no;
-        if (rxs_handler_fwrite(stream, recv_buf, (size_t)impl_bytes, &err_no) < 0) {
-          // Free memory
-          free(recv_buf);
-          recv_buf = NULL;
-          rxs_data_point_close();
-          rxs_send_packet_x04(get_socket_connected(), SC_B1, operation_fwrite, stream, (uint32_t)impl_bytes, 0);
-          return -1;
+      uint32_t err_no = 0;
+      if (rxs_handler_seek(stream, offset, &err_no) != 0) {
+        log_msg(ERRN, 6, "rxs_handler_seek", strerror(err_no));
+        // Data of positioned write are already sent by other side: the channel is dropped
+        if (operation_pwrite == operation) close_stream_socket(stream);
+        rxs_send_packet_x04(get_socket_connected(), SC_B1, operation, stream, 0, 0);
+        return 0;
+      }
+      if (operation_pread == operation) return rxs_fread_stream(operation, stream, data_sz);
+      return rxs_fwrite_stream(operation, stream, data_sz);
+    }
+    case operation_preadv: {
+      slot07_t slot07;
+      init_slot07_t(&slot07);
+      if (deserialize_slot07_t(packet_rxs_recv->data, (packet_rxs_recv->sz - hdr_packet_rxs_t_sz()), &slot07) < 0) {
+        log_msg(ERRN, 6, "deserialize_slot07_t", "");
+        // Free memory
+        dinit_slot07_t(&slot07);
+        return -1;
+      }
+      uint32_t stream = slot07.stream_id;
+      uint32_t err_no = 0;
+      ssize_t result = -1;
+      // Encrypted data channel moves whole blocks only, the client reads ranges by 'pread' in encoder mode
+      if (have_encoder) {
+        err_no = ENOTSUP;
+      } else {
+        result = rxs_handler_preadv(stream, get_stream_socket(stream), slot07.ranges, slot07.ranges_cnt, &err_no);
+        if (-1 == result) {
+          log_msg(ERRN, 6, "rxs_handler_preadv", strerror(err_no));
+          // Part of the data can be sent already: the channel is dropped
+          close_stream_socket(stream);
         }
-        // It's end of whole data
-        if ((!have_encoder && (total_impl_bytes == data_sz)) || (have_encoder && (number_block == number_block_total)))
-          is_full = 1;
       }
-      free(recv_buf);
-      recv_buf = NULL;
       //////////////////////////////////////////////////////////////////////////////////
-      // Send confirm to other side
+      // RESP: sizes of the ranges are sent
       //////////////////////////////////////////////////////////////////////////////////
-      rxs_send_packet_x04(get_socket_connected(), SC_B0, operation_fwrite, stream, data_sz, 0);
+      ssize_t res = compose_packet_rxs_x07((!result) ? (SC_B0) : (SC_B1), operation, stream, err_no,
+                                           (!result) ? (slot07.ranges) : (NULL), (!result) ? (slot07.ranges_cnt) : (0),
+                                           packet_rxs_send);
+      // Free memory
+      dinit_slot07_t(&slot07);
+      if (res < 0) {
+        log_msg(ERRN, 6, "compose_packet_rxs_x07", "");
+        return -1;
+      }
+
       return 0;
     }
     case operation_fflush: {
@@ -1272,9 +2295,11 @@ ssize_t run_operation(rxs_operation_t operation, packet_rxs_t* packet_rxs_recv,
       }
       int status = -1;
       uint32_t err_no = 0;
-      status = rxs_handler_fflush(slot00.val, &status, &err_no);
+      // CAUTION: the answer is built by 'status', the return value only tells that the stream is found
+      ssize_t ret = rxs_handler_fflush(slot00.val, &status, &err_no);
       // log_msg(INFO, 32, "fflush", status);
-      if (-1 == status) log_msg(ERRN, 6, "rxs_handler_fflush", strerror(err_no));
+      if ((ret != 0) || (status != 0)) log_msg(ERRN, 6, "rxs_handler_fflush", strerror(err_no));
+      if ((status != 0) && !err_no) err_no = EIO;
       // Free memory
       dinit_slot00_t(&slot00);
       //////////////////////////////////////////////////////////////////////////////////
@@ -1298,13 +2323,18 @@ ssize_t run_operation(rxs_operation_t operation, packet_rxs_t* packet_rxs_recv,
       }
       int status = -1;
       uint32_t err_no = 0;
-      status = rxs_handler_fclose(slot00.val, &status, &err_no);
+      // Own channel of the stream is closed with its slot, the channel of the session only if the stream used it
+      file_handlers_t* file_handlers = find_file_handlers_tbl_t(&file_handlers_tbl, slot00.val);
+      uint8_t session_channel = (file_handlers && (file_handlers->data_fd < 0)) ? (1) : (0);
+      // CAUTION: the answer is built by 'status', the return value only tells that the stream is found
+      ssize_t ret = rxs_handler_fclose(slot00.val, &status, &err_no);
       log_msg(INFO, 34, "fclose", slot00.val);
-      if (-1 == status) log_msg(ERRN, 6, "operation_fclose", strerror(err_no));
+      if ((ret != 0) || (status != 0)) log_msg(ERRN, 6, "operation_fclose", strerror(err_no));
+      if ((status != 0) && !err_no) err_no = EIO;
       // Free memory
       dinit_slot00_t(&slot00);
       //
-      rxs_data_point_close();
+      if (session_channel) rxs_data_point_close();
       //////////////////////////////////////////////////////////////////////////////////
       // RESP
       //////////////////////////////////////////////////////////////////////////////////
@@ -1316,36 +2346,35 @@ ssize_t run_operation(rxs_operation_t operation, packet_rxs_t* packet_rxs_recv,
 
       return 0;
     }
-    /*    case operation_fseek: {
-            slot04_t slot04;
-            init_slot04_t(&slot04);
-            if(deserialize_slot04_t(packet_rxs_recv->data, (packet_rxs_recv->sz - hdr_packet_rxs_t_sz()),
-       &slot04)<0) { log_msg(ERRN, 6, "deserialize_slot04_t", "");
-                // Free memory
-                dinit_slot04_t(&slot04);
-                return -1;
-            }
-
-            int status = -1;
-            uint32_t err_no = 0;
-            ssize_t result = -1;
-            result = rxs_handler_fseek(slot04.val1, slot04.val2, slot04.val3, &status, &err_no);
-            log_msg(INFO, 36, "fseek", slot04.val1, status);
-            // Free memory
-            dinit_slot04_t(&slot04);
-            if(-1 == result) {
-
-            }
-            //////////////////////////////////////////////////////////////////////////////////
-            // RESP
-            //////////////////////////////////////////////////////////////////////////////////
-            if(compose_packet_rxs_x00((!status)?(SC_B0):(SC_B1), operation, (!status)?(status):(err_no),
-       packet_rxs_send)<0) { log_msg(ERRN, 6, "compose_packet_rxs_x00", ""); return -1;
-            }
-
-            return 0;
-        }
-    */
+    case operation_fseek: {
+      slot06_t slot06;
+      init_slot06_t(&slot06);
+      if (deserialize_slot06_t(packet_rxs_recv->data, (packet_rxs_recv->sz - hdr_packet_rxs_t_sz()), &slot06) < 0) {
+        log_msg(ERRN, 6, "deserialize_slot06_t", "");
+        // Free memory
+        dinit_slot06_t(&slot06);
+        return -1;
+      }
+      uint32_t stream = slot06.stream_id;
+      int64_t offset = (int64_t)slot06.offset;
+      int whence = (int)slot06.data_sz;
+      dinit_slot06_t(&slot06);
+
+      int64_t position = 0;
+      uint32_t err_no = 0;
+      ssize_t result = rxs_handler_fseek(stream, offset, whence, &position, &err_no);
+      if (-1 == result) log_msg(ERRN, 6, "rxs_handler_fseek", strerror(err_no));
+      //////////////////////////////////////////////////////////////////////////////////
+      // RESP: 64-bit position does not fit the answer of slot00_t
+      //////////////////////////////////////////////////////////////////////////////////
+      if (compose_packet_rxs_x06((!result) ? (SC_B0) : (SC_B1), operation, stream, (!result) ? (position) : (0),
+                                 (!result) ? (0) : (err_no), packet_rxs_send) < 0) {
+        log_msg(ERRN, 6, "compose_packet_rxs_x06", "");
+        return -1;
+      }
+
+      return 0;
+    }
     case operation_ftell: {
       slot00_t slot00;
       init_slot00_t(&slot00);
@@ -1465,6 +2494,28 @@ ssize_t run_operation(rxs_operation_t operation, packet_rxs_t* packet_rxs_recv,
 
       return 0;
     }
+    case operation_ping: {
+      slot00_t slot00;
+      init_slot00_t(&slot00);
+      if (deserialize_slot00_t(packet_rxs_recv->data, (packet_rxs_recv->sz - hdr_packet_rxs_t_sz()), &slot00) < 0) {
+        log_msg(ERRN, 6, "deserialize_slot00_t", "");
+        // Free memory
+        dinit_slot00_t(&slot00);
+        return -1;
+      }
+      // Echo the value: the connection and the session are alive
+      uint32_t val = slot00.val;
+      // Free memory
+      dinit_slot00_t(&slot00);
+      //////////////////////////////////////////////////////////////////////////////////
+      // RESP
+      //////////////////////////////////////////////////////////////////////////////////
+      if (compose_packet_rxs_x00(SC_B0, operation, val, packet_rxs_send) < 0) {
+        log_msg(ERRN, 6, "compose_packet_rxs_x00", "");
+        return -1;
+      }
+      return 0;
+    }
     default: {
       log_msg(ERRN, 38, operation);
     }
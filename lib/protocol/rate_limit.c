@@ -0,0 +1,219 @@
+/*******************************************************************************
+** Copyright (c) 2012 - 2023 v.arteev
+
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+
+** The above copyright notice and this permission notice shall be included in all
+** copies or substantial portions of the Software.
+
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+*******************************************************************************/
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE  // for 'MAP_ANONYMOUS'
+#endif
+#include <errno.h>  // for 'errno'
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>  // for 'mmap()'
+#include <time.h>
+
+#include "protocol/rate_limit.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// Shared state of the server: the server-wide bucket and the buckets of users
+//////////////////////////////////////////////////////////////////////////////////////////////////
+typedef struct rate_limit_user_t {
+  char name[RATE_LIMIT_USER_SZ];  // Empty - the bucket is free
+  rate_limit_t limit;
+} rate_limit_user_t;
+
+typedef struct rate_limit_shared_t {
+  pthread_mutex_t mutex;  // Table of users
+  rate_limit_t server;
+  rate_limit_user_t users[RATE_LIMIT_USERS_MAX];
+} rate_limit_shared_t;
+
+static rate_limit_shared_t* rate_limit_shared = NULL;
+
+static uint64_t monotonic_nsec() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+static int lock_rate_limit(pthread_mutex_t* mutex) {
+  int res = pthread_mutex_lock(mutex);
+  // The owner has died: the state is consistent, it is changed by single assignments
+  if (EOWNERDEAD == res) {
+    pthread_mutex_consistent(mutex);
+    res = 0;
+  }
+  return res;
+}
+static int init_mutex(pthread_mutex_t* mutex, uint8_t pshared) {
+  pthread_mutexattr_t mutex_attr;
+  pthread_mutexattr_init(&mutex_attr);
+  if (pshared) {
+    pthread_mutexattr_setpshared(&mutex_attr, PTHREAD_PROCESS_SHARED);
+    pthread_mutexattr_setrobust(&mutex_attr, PTHREAD_MUTEX_ROBUST);
+  }
+  int res = pthread_mutex_init(mutex, &mutex_attr);
+  pthread_mutexattr_destroy(&mutex_attr);
+  return res;
+}
+// Set the limit without the lock
+static void assign_rate_limit(rate_limit_t* limit, uint64_t rate, uint64_t burst) {
+  if (!burst) burst = rate * RATE_LIMIT_BURST_MSEC / 1000;
+  if (burst < RATE_LIMIT_PORTION_SZ) burst = RATE_LIMIT_PORTION_SZ;
+  if (burst > INT64_MAX) burst = INT64_MAX;
+  limit->rate = rate;
+  limit->burst = burst;
+  limit->tokens = (int64_t)burst;
+  limit->stamp_nsec = monotonic_nsec();
+}
+ssize_t init_rate_limit_t(rate_limit_t* limit, uint64_t rate, uint64_t burst, uint8_t pshared) {
+  if (!limit) return -1;
+
+  memset(limit, 0, sizeof(rate_limit_t));
+  int res = init_mutex(&limit->mutex, pshared);
+  if (res != 0) {
+    errno = res;
+    return -1;
+  }
+  assign_rate_limit(limit, rate, burst);
+  return 0;
+}
+ssize_t dinit_rate_limit_t(rate_limit_t* limit) {
+  if (!limit) return -1;
+
+  pthread_mutex_destroy(&limit->mutex);
+  return 0;
+}
+ssize_t set_rate_limit_t(rate_limit_t* limit, uint64_t rate, uint64_t burst) {
+  if (!limit || (lock_rate_limit(&limit->mutex) != 0)) return -1;
+
+  assign_rate_limit(limit, rate, burst);
+  pthread_mutex_unlock(&limit->mutex);
+  return 0;
+}
+uint8_t rate_limit_active(const rate_limit_t* limit) { return (limit && limit->rate) ? (1) : (0); }
+void rate_limit_take(rate_limit_t* limit, size_t bytes) {
+  // CAUTION: unlimited bucket is checked without the lock, it costs nothing on the data path
+  if (!rate_limit_active(limit) || !bytes || (lock_rate_limit(&limit->mutex) != 0)) return;
+  if (!limit->rate) {
+    pthread_mutex_unlock(&limit->mutex);
+    return;
+  }
+  //////////////////////////////////////////////////////////////////////////////////
+  // Refill by the time passed, then take the data. The debt is paid by the sleep of the taker, so the next takers
+  // (other threads and processes too) sleep longer.
+  //////////////////////////////////////////////////////////////////////////////////
+  uint64_t now_nsec = monotonic_nsec();
+  double refill = (double)(now_nsec - limit->stamp_nsec) * (double)limit->rate / 1e9;
+  double tokens = (double)limit->tokens + refill;
+  if (tokens > (double)limit->burst) tokens = (double)limit->burst;
+  tokens -= (double)bytes;
+  limit->tokens = (int64_t)tokens;
+  limit->stamp_nsec = now_nsec;
+  double wait_sec = (tokens < 0) ? (-tokens / (double)limit->rate) : (0);
+  pthread_mutex_unlock(&limit->mutex);
+
+  if (wait_sec <= 0) return;
+  struct timespec wait = {(time_t)wait_sec, (long)((wait_sec - (double)(time_t)wait_sec) * 1e9)};
+  while ((nanosleep(&wait, &wait) != 0) && (EINTR == errno)) {
+  }
+}
+// Parse value with optional suffix 'K', 'M' or 'G'
+static int parse_rate_value(const char* lexeme, const char** end, uint64_t* val) {
+  char* p = NULL;
+  errno = 0;
+  unsigned long long num = strtoull(lexeme, &p, 10);
+  if ((p == lexeme) || (errno != 0) || ('-' == *lexeme)) return -1;
+  uint64_t scale = 1;
+  if (('K' == *p) || ('k' == *p)) scale = 1024ULL;
+  if (('M' == *p) || ('m' == *p)) scale = 1024ULL * 1024ULL;
+  if (('G' == *p) || ('g' == *p)) scale = 1024ULL * 1024ULL * 1024ULL;
+  if (scale > 1) p++;
+  if (num > UINT64_MAX / scale) return -1;
+  *val = (uint64_t)num * scale;
+  *end = p;
+  return 0;
+}
+ssize_t parse_rate_limit(const char* lexeme, uint64_t* rate, uint64_t* burst) {
+  if (!lexeme || !rate || !burst) return -1;
+
+  const char* p = NULL;
+  *burst = 0;
+  if (parse_rate_value(lexeme, &p, rate) != 0) return -1;
+  if ((':' == *p) && (parse_rate_value(p + 1, &p, burst) != 0)) return -1;
+  return ('\0' == *p) ? (0) : (-1);
+}
+ssize_t init_rate_limit_shared(uint64_t rate, uint64_t burst) {
+#ifdef __QNXNTO__
+  (void)rate;
+  (void)burst;
+  return 0;
+#else
+  if (rate_limit_shared) return set_rate_limit_t(&rate_limit_shared->server, rate, burst);
+
+  void* ptr = mmap(NULL, sizeof(rate_limit_shared_t), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (MAP_FAILED == ptr) return -1;
+  rate_limit_shared_t* shared = (rate_limit_shared_t*)ptr;
+  memset(shared, 0, sizeof(*shared));
+
+  int res = init_mutex(&shared->mutex, 1);
+  if ((0 == res) && (init_rate_limit_t(&shared->server, rate, burst, 1) != 0)) res = errno;
+  for (uint32_t i = 0; (0 == res) && (i < RATE_LIMIT_USERS_MAX); i++)
+    if (init_rate_limit_t(&shared->users[i].limit, 0, 0, 1) != 0) res = errno;
+  if (res != 0) {
+    munmap(ptr, sizeof(rate_limit_shared_t));
+    errno = res;
+    return -1;
+  }
+  rate_limit_shared = shared;
+  return 0;
+#endif
+}
+ssize_t dinit_rate_limit_shared() {
+  if (!rate_limit_shared) return 0;
+
+  // CAUTION: the state is destroyed only by the process which has created it, sessions just unmap it
+  munmap(rate_limit_shared, sizeof(rate_limit_shared_t));
+  rate_limit_shared = NULL;
+  return 0;
+}
+rate_limit_t* get_rate_limit_server() { return (rate_limit_shared) ? (&rate_limit_shared->server) : (NULL); }
+rate_limit_t* get_rate_limit_user(const char* name, uint64_t rate, uint64_t burst) {
+  if (!rate_limit_shared || !name || !name[0] || (strlen(name) >= RATE_LIMIT_USER_SZ)) return NULL;
+  if (lock_rate_limit(&rate_limit_shared->mutex) != 0) return NULL;
+
+  rate_limit_user_t* found = NULL;
+  rate_limit_user_t* free_slot = NULL;
+  for (uint32_t i = 0; !found && (i < RATE_LIMIT_USERS_MAX); i++) {
+    rate_limit_user_t* user = &rate_limit_shared->users[i];
+    if (!strcmp(user->name, name)) found = user;
+    if (!free_slot && !user->name[0]) free_slot = user;
+  }
+  if (!found && free_slot) {
+    found = free_slot;
+    snprintf(found->name, sizeof(found->name), "%s", name);
+  }
+  pthread_mutex_unlock(&rate_limit_shared->mutex);
+  if (!found) return NULL;
+  // The bucket of the user is not refilled by the new session unless the limit is changed
+  if ((found->limit.rate != rate) || ((burst) && (found->limit.burst != burst)))
+    set_rate_limit_t(&found->limit, rate, burst);
+  return &found->limit;
+}
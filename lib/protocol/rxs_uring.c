@@ -0,0 +1,455 @@
+/*******************************************************************************
+** Copyright (c) 2012 - 2023 v.arteev
+
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+
+** The above copyright notice and this permission notice shall be included in all
+** copies or substantial portions of the Software.
+
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+*******************************************************************************/
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE  // for 'syscall()', 'MAP_POPULATE'
+#endif
+#include <errno.h>  // for 'errno'
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <unistd.h>
+#if !defined(__QNXNTO__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>  // for 'struct iovec'
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter) && defined(__NR_io_uring_register)
+#define RXS_HAVE_IO_URING 1
+#endif
+#endif
+#endif
+
+#include "protocol/protocol_rxs.h"  // for 'POLL_TIMEOUT_DATA_MSEC'
+#include "protocol/rxs_uring.h"
+
+#ifdef RXS_HAVE_IO_URING
+// User data of request: index of buffer and type of operation (0 - read/recv, 1 - send/write)
+#define URING_UDATA(index, op) ((((uint64_t)(index)) << 1) | (op))
+#define URING_UDATA_TIMEOUT UINT64_MAX
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// System calls (there is no liburing dependency)
+//////////////////////////////////////////////////////////////////////////////////////////////////
+static int uring_setup(unsigned entries, struct io_uring_params* params) {
+  return (int)syscall(__NR_io_uring_setup, entries, params);
+}
+static int uring_enter(int ring_fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+  return (int)syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, NULL, 0);
+}
+static int uring_register(int ring_fd, unsigned opcode, const void* arg, unsigned nr_args) {
+  return (int)syscall(__NR_io_uring_register, ring_fd, opcode, arg, nr_args);
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// Queues
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// Get next free entry of submission queue. 'tail' is the local tail, it is published by 'submit_sqes()'
+static struct io_uring_sqe* get_sqe(rxs_uring_t* ring, unsigned* tail) {
+  unsigned head = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+  if ((*tail - head) >= ring->sq_entries) return NULL;
+
+  unsigned index = *tail & *ring->sq_mask;
+  struct io_uring_sqe* sqe = &((struct io_uring_sqe*)ring->sqes)[index];
+  memset(sqe, 0, sizeof(*sqe));
+  ring->sq_array[index] = index;
+  ++*tail;
+  return sqe;
+}
+static int submit_sqes(rxs_uring_t* ring, unsigned tail, unsigned count) {
+  __atomic_store_n(ring->sq_tail, tail, __ATOMIC_RELEASE);
+  while (count > 0) {
+    int res = uring_enter(ring->ring_fd, count, 0, 0);
+    if (res < 0) {
+      if (EINTR == errno) continue;
+      return -1;
+    }
+    count -= (unsigned)res;
+  }
+  return 0;
+}
+// Wait next completion
+static int wait_cqe(rxs_uring_t* ring, uint64_t* user_data, int32_t* res) {
+  for (;;) {
+    unsigned head = *ring->cq_head;
+    unsigned tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+    if (head != tail) {
+      struct io_uring_cqe* cqe = &((struct io_uring_cqe*)ring->cqes)[head & *ring->cq_mask];
+      *user_data = cqe->user_data;
+      *res = cqe->res;
+      __atomic_store_n(ring->cq_head, head + 1, __ATOMIC_RELEASE);
+      return 0;
+    }
+    if ((uring_enter(ring->ring_fd, 0, 1, IORING_ENTER_GETEVENTS) < 0) && (errno != EINTR)) return -1;
+  }
+}
+static void prep_rw(rxs_uring_t* ring, struct io_uring_sqe* sqe, uint8_t opcode, int fd, uint32_t index, uint32_t len,
+                    uint64_t offset, uint64_t user_data) {
+  sqe->opcode = opcode;
+  sqe->fd = fd;
+  sqe->addr = (uint64_t)(uintptr_t)(ring->bufs + (size_t)index * ring->buf_sz);
+  sqe->len = len;
+  sqe->off = offset;
+  sqe->user_data = user_data;
+  if ((IORING_OP_READ_FIXED == opcode) || (IORING_OP_WRITE_FIXED == opcode)) sqe->buf_index = (uint16_t)index;
+}
+// Send whole buffer without the ring
+static int send_all(int sockfd, const uint8_t* buf, size_t buf_sz) {
+  size_t impl_sz = 0;
+  while (impl_sz < buf_sz) {
+    ssize_t res = send(sockfd, buf + impl_sz, buf_sz - impl_sz, MSG_NOSIGNAL);
+    if (res < 0) {
+      if (EINTR == errno) continue;
+      return -1;
+    }
+    impl_sz += (size_t)res;
+  }
+  return 0;
+}
+#endif
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// Ring
+//////////////////////////////////////////////////////////////////////////////////////////////////
+ssize_t rxs_uring_available() {
+#ifndef RXS_HAVE_IO_URING
+  return 0;
+#else
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  int ring_fd = uring_setup(1, &params);
+  if (ring_fd < 0) return 0;
+  //////////////////////////////////////////////////////////////////////////////////
+  // Check that all used operations are supported by the kernel
+  //////////////////////////////////////////////////////////////////////////////////
+  const uint8_t ops[] = {IORING_OP_READ_FIXED, IORING_OP_WRITE_FIXED, IORING_OP_READ,        IORING_OP_WRITE,
+                         IORING_OP_SEND,       IORING_OP_RECV,        IORING_OP_LINK_TIMEOUT};
+  size_t probe_sz = sizeof(struct io_uring_probe) + 256 * sizeof(struct io_uring_probe_op);
+  struct io_uring_probe* probe = calloc(1, probe_sz);
+  ssize_t result = 0;
+  if (probe && (uring_register(ring_fd, IORING_REGISTER_PROBE, probe, 256) == 0)) {
+    result = 1;
+    for (size_t i = 0; i < sizeof(ops) / sizeof(ops[0]); ++i) {
+      if ((ops[i] > probe->last_op) || !(probe->ops[ops[i]].flags & IO_URING_OP_SUPPORTED)) result = 0;
+    }
+  }
+  // Free memory
+  free(probe);
+  close(ring_fd);
+  return result;
+#endif
+}
+ssize_t init_rxs_uring_t(rxs_uring_t* ring, uint32_t entries, uint32_t bufs_cnt, size_t buf_sz) {
+  if (!ring) return -1;
+
+  memset(ring, 0, sizeof(*ring));
+  ring->ring_fd = -1;
+#ifndef RXS_HAVE_IO_URING
+  (void)entries;
+  (void)bufs_cnt;
+  (void)buf_sz;
+  errno = ENOSYS;
+  return -1;
+#else
+  if (!bufs_cnt || !buf_sz || (entries < 2 * bufs_cnt + 2)) {
+    errno = EINVAL;
+    return -1;
+  }
+  if (!rxs_uring_available()) {
+    errno = ENOSYS;
+    return -1;
+  }
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  ring->ring_fd = uring_setup(entries, &params);
+  if (ring->ring_fd < 0) return -1;
+  //////////////////////////////////////////////////////////////////////////////////
+  // Map queues
+  //////////////////////////////////////////////////////////////////////////////////
+  ring->sq_ptr_sz = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  ring->cq_ptr_sz = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  if (params.features & IORING_FEAT_SINGLE_MMAP) {
+    if (ring->cq_ptr_sz > ring->sq_ptr_sz) ring->sq_ptr_sz = ring->cq_ptr_sz;
+    ring->cq_ptr_sz = ring->sq_ptr_sz;
+  }
+  ring->sq_ptr = mmap(NULL, ring->sq_ptr_sz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->ring_fd,
+                      IORING_OFF_SQ_RING);
+  if (MAP_FAILED == ring->sq_ptr) {
+    int err_no = errno;
+    ring->sq_ptr = NULL;
+    dinit_rxs_uring_t(ring);
+    errno = err_no;
+    return -1;
+  }
+  if (params.features & IORING_FEAT_SINGLE_MMAP) {
+    ring->cq_ptr = ring->sq_ptr;
+  } else {
+    ring->cq_ptr = mmap(NULL, ring->cq_ptr_sz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->ring_fd,
+                        IORING_OFF_CQ_RING);
+    if (MAP_FAILED == ring->cq_ptr) {
+      int err_no = errno;
+      ring->cq_ptr = NULL;
+      dinit_rxs_uring_t(ring);
+      errno = err_no;
+      return -1;
+    }
+  }
+  ring->sqes_sz = params.sq_entries * sizeof(struct io_uring_sqe);
+  ring->sqes =
+      mmap(NULL, ring->sqes_sz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->ring_fd, IORING_OFF_SQES);
+  if (MAP_FAILED == ring->sqes) {
+    int err_no = errno;
+    ring->sqes = NULL;
+    dinit_rxs_uring_t(ring);
+    errno = err_no;
+    return -1;
+  }
+  uint8_t* sq_ptr = (uint8_t*)ring->sq_ptr;
+  uint8_t* cq_ptr = (uint8_t*)ring->cq_ptr;
+  ring->sq_head = (unsigned*)(sq_ptr + params.sq_off.head);
+  ring->sq_tail = (unsigned*)(sq_ptr + params.sq_off.tail);
+  ring->sq_mask = (unsigned*)(sq_ptr + params.sq_off.ring_mask);
+  ring->sq_array = (unsigned*)(sq_ptr + params.sq_off.array);
+  ring->sq_entries = params.sq_entries;
+  ring->cq_head = (unsigned*)(cq_ptr + params.cq_off.head);
+  ring->cq_tail = (unsigned*)(cq_ptr + params.cq_off.tail);
+  ring->cq_mask = (unsigned*)(cq_ptr + params.cq_off.ring_mask);
+  ring->cqes = cq_ptr + params.cq_off.cqes;
+  //////////////////////////////////////////////////////////////////////////////////
+  // Buffers
+  //////////////////////////////////////////////////////////////////////////////////
+  void* bufs = NULL;
+  int err_no = posix_memalign(&bufs, (size_t)sysconf(_SC_PAGESIZE), (size_t)bufs_cnt * buf_sz);
+  if (err_no != 0) {
+    dinit_rxs_uring_t(ring);
+    errno = err_no;
+    return -1;
+  }
+  ring->bufs = (uint8_t*)bufs;
+  ring->bufs_cnt = bufs_cnt;
+  ring->buf_sz = buf_sz;
+  // CAUTION: registered buffers are locked in memory and limited by RLIMIT_MEMLOCK. Without registration the ring uses
+  // the same buffers by the ordinary read/write operations
+  struct iovec iov[bufs_cnt];
+  for (uint32_t i = 0; i < bufs_cnt; ++i) {
+    iov[i].iov_base = ring->bufs + (size_t)i * buf_sz;
+    iov[i].iov_len = buf_sz;
+  }
+  ring->bufs_registered = (uring_register(ring->ring_fd, IORING_REGISTER_BUFFERS, iov, bufs_cnt) == 0) ? 1 : 0;
+  return 0;
+#endif
+}
+ssize_t dinit_rxs_uring_t(rxs_uring_t* ring) {
+  if (!ring) return -1;
+
+#ifdef RXS_HAVE_IO_URING
+  if (ring->bufs_registered) uring_register(ring->ring_fd, IORING_UNREGISTER_BUFFERS, NULL, 0);
+  if (ring->sqes) munmap(ring->sqes, ring->sqes_sz);
+  if (ring->cq_ptr && (ring->cq_ptr != ring->sq_ptr)) munmap(ring->cq_ptr, ring->cq_ptr_sz);
+  if (ring->sq_ptr) munmap(ring->sq_ptr, ring->sq_ptr_sz);
+#endif
+  if (ring->ring_fd >= 0) close(ring->ring_fd);
+  // Free memory
+  free(ring->bufs);
+  memset(ring, 0, sizeof(*ring));
+  ring->ring_fd = -1;
+  return 0;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// Data transfer
+//////////////////////////////////////////////////////////////////////////////////////////////////
+ssize_t rxs_uring_file_to_socket(rxs_uring_t* ring, int fd, int sockfd, off_t* offset, size_t count, size_t* len) {
+  if (!ring || !offset || !len) return -1;
+
+  *len = 0;
+#ifndef RXS_HAVE_IO_URING
+  (void)fd;
+  (void)sockfd;
+  (void)count;
+  errno = ENOSYS;
+  return -1;
+#else
+  uint32_t pairs_max = ring->bufs_cnt;
+  uint32_t chunk_sz[pairs_max];
+  int32_t res_read[pairs_max];
+  int32_t res_send[pairs_max];
+  uint8_t opcode_read = (ring->bufs_registered) ? IORING_OP_READ_FIXED : IORING_OP_READ;
+
+  while (*len < count) {
+    //////////////////////////////////////////////////////////////////////////////////
+    // CAUTION: the chain 'read -> send -> read -> send ...' keeps the order of data on the socket. A short read breaks
+    // the chain, the rest of requests are canceled.
+    //////////////////////////////////////////////////////////////////////////////////
+    unsigned tail = *ring->sq_tail;
+    uint32_t pairs = 0;
+    size_t planned_sz = 0;
+    struct io_uring_sqe* sqe = NULL;
+    while ((pairs < pairs_max) && ((*len + planned_sz) < count)) {
+      size_t chunk = ((count - *len - planned_sz) > ring->buf_sz) ? (ring->buf_sz) : (count - *len - planned_sz);
+      sqe = get_sqe(ring, &tail);
+      prep_rw(ring, sqe, opcode_read, fd, pairs, (uint32_t)chunk, (uint64_t)(*offset + planned_sz),
+              URING_UDATA(pairs, 0));
+      sqe->flags = IOSQE_IO_LINK;
+      sqe = get_sqe(ring, &tail);
+      prep_rw(ring, sqe, IORING_OP_SEND, sockfd, pairs, (uint32_t)chunk, 0, URING_UDATA(pairs, 1));
+      sqe->msg_flags = MSG_NOSIGNAL | MSG_WAITALL;
+      sqe->flags = IOSQE_IO_LINK;
+      chunk_sz[pairs] = (uint32_t)chunk;
+      planned_sz += chunk;
+      ++pairs;
+    }
+    // Last request closes the chain
+    sqe->flags = 0;
+    if (submit_sqes(ring, tail, 2 * pairs) != 0) return -1;
+    for (uint32_t i = 0; i < 2 * pairs; ++i) {
+      uint64_t user_data = 0;
+      int32_t res = 0;
+      if (wait_cqe(ring, &user_data, &res) != 0) return -1;
+      if (user_data & 1)
+        res_send[user_data >> 1] = res;
+      else
+        res_read[user_data >> 1] = res;
+    }
+    //////////////////////////////////////////////////////////////////////////////////
+    // Results in order of the chain
+    //////////////////////////////////////////////////////////////////////////////////
+    for (uint32_t i = 0; i < pairs; ++i) {
+      if (res_read[i] < 0) {
+        errno = -res_read[i];
+        return -1;
+      }
+      // End of file
+      if (0 == res_read[i]) return 0;
+      // Short read: send the read part without the chain and start the next chain from here
+      if ((uint32_t)res_read[i] < chunk_sz[i]) {
+        if (send_all(sockfd, ring->bufs + (size_t)i * ring->buf_sz, (size_t)res_read[i]) != 0) return -1;
+        *len += (size_t)res_read[i];
+        *offset += res_read[i];
+        break;
+      }
+      if (res_send[i] != (int32_t)chunk_sz[i]) {
+        errno = (res_send[i] < 0) ? -res_send[i] : EIO;
+        return -1;
+      }
+      *len += chunk_sz[i];
+      *offset += chunk_sz[i];
+    }
+  }
+  return 0;
+#endif
+}
+ssize_t rxs_uring_socket_to_file(rxs_uring_t* ring, int sockfd, int fd, off_t* offset, size_t count, size_t* len) {
+  if (!ring || !offset || !len) return -1;
+
+  *len = 0;
+#ifndef RXS_HAVE_IO_URING
+  (void)fd;
+  (void)sockfd;
+  (void)count;
+  errno = ENOSYS;
+  return -1;
+#else
+  uint32_t bufs_cnt = ring->bufs_cnt;
+  uint8_t busy[bufs_cnt];      // Buffer is written to the file
+  uint32_t write_sz[bufs_cnt];  // Size of data in the buffer
+  memset(busy, 0, sizeof(busy));
+  uint8_t opcode_write = (ring->bufs_registered) ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+  struct __kernel_timespec ts = {POLL_TIMEOUT_DATA_MSEC / 1000, 0};
+
+  size_t received_sz = 0;
+  off_t write_offset = *offset;
+  uint32_t recv_index = 0;
+  uint8_t recv_pending = 0;
+  uint32_t inflight = 0;
+  int err_no = 0;
+  unsigned tail = *ring->sq_tail;
+  //////////////////////////////////////////////////////////////////////////////////
+  // Pipeline: one receive is in flight while the received buffers are written to the file
+  //////////////////////////////////////////////////////////////////////////////////
+  for (;;) {
+    if (!err_no && !recv_pending && (received_sz < count) && !busy[recv_index]) {
+      size_t chunk = ((count - received_sz) > ring->buf_sz) ? (ring->buf_sz) : (count - received_sz);
+      struct io_uring_sqe* sqe = get_sqe(ring, &tail);
+      prep_rw(ring, sqe, IORING_OP_RECV, sockfd, recv_index, (uint32_t)chunk, 0, URING_UDATA(recv_index, 0));
+      sqe->msg_flags = MSG_WAITALL;
+      sqe->flags = IOSQE_IO_LINK;
+      // Timeout of receiving
+      sqe = get_sqe(ring, &tail);
+      sqe->opcode = IORING_OP_LINK_TIMEOUT;
+      sqe->fd = -1;
+      sqe->addr = (uint64_t)(uintptr_t)&ts;
+      sqe->len = 1;
+      sqe->user_data = URING_UDATA_TIMEOUT;
+      if (submit_sqes(ring, tail, 2) != 0) {
+        err_no = errno;
+      } else {
+        inflight += 2;
+        recv_pending = 1;
+      }
+    }
+    if (0 == inflight) break;
+
+    uint64_t user_data = 0;
+    int32_t res = 0;
+    if (wait_cqe(ring, &user_data, &res) != 0) return -1;
+    --inflight;
+    if (URING_UDATA_TIMEOUT == user_data) continue;
+
+    uint32_t index = (uint32_t)(user_data >> 1);
+    // Write is completed
+    if (user_data & 1) {
+      busy[index] = 0;
+      if (res != (int32_t)write_sz[index]) {
+        if (!err_no) err_no = (res < 0) ? -res : EIO;
+        continue;
+      }
+      *len += (size_t)res;
+      continue;
+    }
+    // Receive is completed
+    recv_pending = 0;
+    if (res <= 0) {
+      if (!err_no) err_no = (-ECANCELED == res) ? ETIMEDOUT : ((res < 0) ? -res : ECONNRESET);
+      continue;
+    }
+    received_sz += (size_t)res;
+    if (err_no) continue;
+
+    struct io_uring_sqe* sqe = get_sqe(ring, &tail);
+    prep_rw(ring, sqe, opcode_write, fd, index, (uint32_t)res, (uint64_t)write_offset, URING_UDATA(index, 1));
+    if (submit_sqes(ring, tail, 1) != 0) {
+      err_no = errno;
+      continue;
+    }
+    ++inflight;
+    busy[index] = 1;
+    write_sz[index] = (uint32_t)res;
+    write_offset += res;
+    recv_index = (index + 1) % bufs_cnt;
+  }
+  if (err_no) {
+    errno = err_no;
+    return -1;
+  }
+  *offset = write_offset;
+  return 0;
+#endif
+}
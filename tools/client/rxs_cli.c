@@ -19,13 +19,21 @@
 ** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 ** SOFTWARE.
 *******************************************************************************/
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE  // for 'fallocate()'
+#endif
 #define _FILE_OFFSET_BITS 64
 #include <arpa/inet.h>  // for 'INET_ADDRSTRLEN'
+#include <fcntl.h>
+#include <inttypes.h>
 #include <limits.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <strings.h>  // for 'strncasecmp'
+#include <time.h>
+#include <unistd.h>
 #ifndef __QNXNTO__
 #include <linux/limits.h>  // for 'PATH_MAX'
 #else
@@ -35,9 +43,11 @@
 #include <signal.h>  // for 'cntl+C'
 
 #include "logger/logger.h"
+#include "protocol/durability.h"
 #include "protocol/generic.h"
 #include "protocol/parser.h"
 #include "protocol/protocol_rxs_client.h"
+#include "protocol/rate_limit.h"
 #include "protocol/rxs_errno.h"
 #include "protocol/version.h"
 
@@ -77,8 +87,303 @@ Help: use these commands in next format:\n\
    $/usr/sbin/rxsc get username:password@address:port ./local_file ./remote_file\n\
  *CLI to remote terminal:\n\
    $/usr/sbin/rxsc cli username:password@address:port\n\
+ *Option of PUT and GET: move the file by N connections at once (1 - %d)\n\
+   --stripes=N\n\
+ *MIRROR directory trees: only new or changed files are moved (push - local to remote, pull - remote to local)\n\
+   $/usr/sbin/rxsc mirror push|pull username:password@address:port ./local_dir ./remote_dir\n\
+ *Options of MIRROR: move files by N connections at once (1 - %d), delete files are absent in the source tree\n\
+   --workers=N --delete\n\
+ *BATCH of operations (get, put, mkdir, rm, rename) of the manifest, one result per line is printed:\n\
+   $/usr/sbin/rxsc batch username:password@address:port ./manifest\n\
+ *Option of BATCH: run operations by N connections at once (1 - %d)\n\
+   --streams=N\n\
+ *Option of all operations: limit data channels (bytes per second, suffix K, M or G)\n\
+   --rate_limit=RATE[:BURST]\n\
  RXS rev.%s\n",
-          git_version);
+          RXS_STRIPES_MAX, RXS_MIRROR_WORKERS_MAX, RXS_BATCH_STREAMS_MAX, git_version);
+  return 0;
+}
+// Print throughput of the stripes
+int show_stripes(const rxs_stripe_stat_t* stat, int stripes) {
+  for (int i = 0; i < stripes; i++) {
+    double mbps = (stat[i].sec > 0) ? ((double)stat[i].done / (1024.0 * 1024.0) / stat[i].sec) : (0);
+    fprintf(stdout, "stripe %d: offset %" PRIu64 " size %" PRIu64 " B, %.2f s, %.1f MB/s, retries %" PRIu32 "\n", i,
+            stat[i].offset, stat[i].done, stat[i].sec, mbps, stat[i].retries);
+  }
+  fflush(stdout);
+  return 0;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// Pipelined transfer: the network stage works with one buffer while the disk thread works with the other one.
+// GET: the network fills buffers, the writer drains them. PUT: the reader fills buffers, the network drains them.
+//////////////////////////////////////////////////////////////////////////////////////////////////
+#define PIPELINE_BUFS_CNT 2
+#define PIPELINE_BUF_SZ (5 * 1024 * 1024)
+#define PUT_CHECKPOINT_SZ (256 * 1024 * 1024)  // The remote file is flushed after every N bytes of upload
+
+typedef struct pipeline_buf_t {
+  char* data;
+  size_t len;
+  uint8_t full;  // Data are waited for the consumer
+} pipeline_buf_t;
+
+typedef struct pipeline_t {
+  pthread_t thr;
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  pipeline_buf_t bufs[PIPELINE_BUFS_CNT];
+  int fd;
+  uint8_t done;    // The network stage is finished
+  uint8_t started;  // The disk thread is started
+  int err_no;      // Error of the disk thread
+} pipeline_t;
+
+// Return value: on success returns 0, otherwise -1 and 'err_no' is set
+int init_pipeline_t(pipeline_t* pipeline, int fd, void* (*disk_thread)(void*), int* err_no) {
+  memset(pipeline, 0, sizeof(pipeline_t));
+  pthread_mutex_init(&pipeline->mutex, NULL);
+  pthread_cond_init(&pipeline->cond, NULL);
+  pipeline->fd = fd;
+  for (uint32_t i = 0; i < PIPELINE_BUFS_CNT; i++) {
+    pipeline->bufs[i].data = (char*)malloc(PIPELINE_BUF_SZ);
+    if (!pipeline->bufs[i].data) {
+      log_msg(ERRN, 44, PIPELINE_BUF_SZ);
+      *err_no = RXS_CLI_ENOMEM;
+      return -1;
+    }
+  }
+  int ret_code = pthread_create(&pipeline->thr, NULL, disk_thread, pipeline);
+  if (ret_code != 0) {
+    log_msg(ERRN, 6, "pthread_create", strerror(ret_code));
+    *err_no = ret_code;
+    return -1;
+  }
+  pipeline->started = 1;
+  return 0;
+}
+// Stop the disk thread after the buffers are passed to it
+void dinit_pipeline_t(pipeline_t* pipeline) {
+  pthread_mutex_lock(&pipeline->mutex);
+  pipeline->done = 1;
+  pthread_cond_broadcast(&pipeline->cond);
+  pthread_mutex_unlock(&pipeline->mutex);
+  if (pipeline->started) pthread_join(pipeline->thr, NULL);
+  pipeline->started = 0;
+  // Free memory
+  for (uint32_t i = 0; i < PIPELINE_BUFS_CNT; i++) {
+    free(pipeline->bufs[i].data);
+    pipeline->bufs[i].data = NULL;
+  }
+  pthread_mutex_destroy(&pipeline->mutex);
+  pthread_cond_destroy(&pipeline->cond);
+}
+// Wait the buffer is filled ('full' is 1) or drained ('full' is 0) by the other side, or error of the disk thread
+// Return value: error of the disk thread
+int wait_pipeline_buf(pipeline_t* pipeline, pipeline_buf_t* buf, uint8_t full) {
+  pthread_mutex_lock(&pipeline->mutex);
+  while ((buf->full != full) && !pipeline->err_no) pthread_cond_wait(&pipeline->cond, &pipeline->mutex);
+  int err_no = pipeline->err_no;
+  pthread_mutex_unlock(&pipeline->mutex);
+  return err_no;
+}
+// Pass the buffer to the other side
+void pass_pipeline_buf(pipeline_t* pipeline, pipeline_buf_t* buf, uint8_t full, int err_no) {
+  pthread_mutex_lock(&pipeline->mutex);
+  buf->full = full;
+  if (err_no) pipeline->err_no = err_no;
+  pthread_cond_broadcast(&pipeline->cond);
+  pthread_mutex_unlock(&pipeline->mutex);
+}
+void* get_writer(void* arg) {
+  pipeline_t* pipeline = (pipeline_t*)arg;
+
+  for (uint32_t idx = 0;; idx = (idx + 1) % PIPELINE_BUFS_CNT) {
+    pipeline_buf_t* buf = &pipeline->bufs[idx];
+    pthread_mutex_lock(&pipeline->mutex);
+    while (!buf->full && !pipeline->done) pthread_cond_wait(&pipeline->cond, &pipeline->mutex);
+    uint8_t full = buf->full;
+    pthread_mutex_unlock(&pipeline->mutex);
+    // Buffers are filled in order, so the empty one is the end
+    if (!full) break;
+
+    int err_no = 0;
+    size_t len = 0;
+    while (len < buf->len) {
+      ssize_t impl_bytes = write(pipeline->fd, buf->data + len, buf->len - len);
+      if (impl_bytes < 0) {
+        if (EINTR == errno) continue;
+        err_no = errno;
+        break;
+      }
+      len += (size_t)impl_bytes;
+    }
+    pass_pipeline_buf(pipeline, buf, 0, err_no);
+    if (err_no) break;
+  }
+  return NULL;
+}
+// Download the remote stream to the local file descriptor
+// Return value: on success returns 0, otherwise -1 and 'err_no' is set (errno of the remote side or of the writer)
+int get_pipelined(RXS_HANDLE stream, int fd, const char* file_local, const char* file_remote, long file_remote_size,
+                  int* err_no) {
+  pipeline_t pipeline;
+  int result = init_pipeline_t(&pipeline, fd, get_writer, err_no);
+  //////////////////////////////////////////////////////////////////////////////////////////////////
+  // Read remote file by portions
+  //////////////////////////////////////////////////////////////////////////////////////////////////
+  uint8_t percent_last = 0;
+  char lexeme[] = "Download...";
+  size_t read_bytes_total = 0;
+  for (uint32_t idx = 0; !result; idx = (idx + 1) % PIPELINE_BUFS_CNT) {
+    pipeline_buf_t* buf = &pipeline.bufs[idx];
+    // Wait the writer drains the buffer
+    if (wait_pipeline_buf(&pipeline, buf, 0) != 0) break;
+
+    // Read the remote file
+    buf->len = rxs_fread(buf->data, PIPELINE_BUF_SZ, sizeof(char), stream);
+    read_bytes_total += buf->len;
+    // Progress bar
+    show_progress_bar(file_remote_size, read_bytes_total, &percent_last, lexeme);
+    int rxs_errno_tmp = rxs_errno();
+    if ((rxs_errno_tmp != 0) && (rxs_errno_tmp != RXS_EOF)) {
+      log_msg(ERRN, 45, file_remote);
+      *err_no = rxs_errno_tmp;
+      result = -1;
+      break;
+    }
+    pass_pipeline_buf(&pipeline, buf, 1, 0);
+
+    if (RXS_EOF == rxs_errno_tmp) break;
+  }
+  // Wait the writer drains the rest
+  dinit_pipeline_t(&pipeline);
+  if (!result && pipeline.err_no) {
+    log_msg(ERRN, 46, file_local);
+    *err_no = pipeline.err_no;
+    result = -1;
+  }
+  return result;
+}
+void* put_reader(void* arg) {
+  pipeline_t* pipeline = (pipeline_t*)arg;
+
+#ifndef __QNXNTO__
+  posix_fadvise(pipeline->fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+  off_t offset = 0;
+  for (uint32_t idx = 0;; idx = (idx + 1) % PIPELINE_BUFS_CNT) {
+    pipeline_buf_t* buf = &pipeline->bufs[idx];
+    pthread_mutex_lock(&pipeline->mutex);
+    while (buf->full && !pipeline->done) pthread_cond_wait(&pipeline->cond, &pipeline->mutex);
+    uint8_t done = pipeline->done;
+    pthread_mutex_unlock(&pipeline->mutex);
+    // The network stage is stopped
+    if (done) break;
+
+    int err_no = 0;
+    size_t len = 0;
+    while (len < PIPELINE_BUF_SZ) {
+      ssize_t impl_bytes = read(pipeline->fd, buf->data + len, PIPELINE_BUF_SZ - len);
+      if (impl_bytes < 0) {
+        if (EINTR == errno) continue;
+        err_no = errno;
+        break;
+      }
+      if (0 == impl_bytes) break;
+      len += (size_t)impl_bytes;
+    }
+    offset += (off_t)len;
+#ifndef __QNXNTO__
+    // The chunk behind the next one is requested from the disk while this one is on the wire
+    if (PIPELINE_BUF_SZ == len) posix_fadvise(pipeline->fd, offset, PIPELINE_BUF_SZ * 2, POSIX_FADV_WILLNEED);
+#endif
+    buf->len = len;
+    pass_pipeline_buf(pipeline, buf, 1, err_no);
+    // Short chunk is the end of file
+    if (err_no || (len < PIPELINE_BUF_SZ)) break;
+  }
+  return NULL;
+}
+// Upload the local file descriptor to the remote stream
+// Return value: on success returns 0, otherwise -1 and 'err_no' is set (errno of the remote side or of the reader)
+int put_pipelined(RXS_HANDLE stream, int fd, const char* file_local, const char* file_remote, long file_local_sz,
+                  int* err_no) {
+  pipeline_t pipeline;
+  int result = init_pipeline_t(&pipeline, fd, put_reader, err_no);
+  //////////////////////////////////////////////////////////////////////////////////////////////////
+  // Write to remote file by portions
+  //////////////////////////////////////////////////////////////////////////////////////////////////
+  uint8_t percent_last = 0;
+  char lexeme[] = "Upload...";
+  size_t write_bytes_total = 0;
+  size_t checkpoint_bytes = 0;
+  for (uint32_t idx = 0; !result; idx = (idx + 1) % PIPELINE_BUFS_CNT) {
+    pipeline_buf_t* buf = &pipeline.bufs[idx];
+    // Wait the reader fills the buffer
+    int reader_errno = wait_pipeline_buf(&pipeline, buf, 1);
+    if (reader_errno) {
+      log_msg(ERRN, 6, file_local, strerror(reader_errno));
+      *err_no = reader_errno;
+      result = -1;
+      break;
+    }
+    size_t len = buf->len;
+    if (len) {
+      // Write to the remote file
+      size_t write_bytes = rxs_fwrite(buf->data, len, sizeof(char), stream);
+      write_bytes_total += write_bytes;
+      if (rxs_errno() != 0) {
+        log_msg(ERRN, 48, file_remote);
+        *err_no = rxs_errno();
+        result = -1;
+        break;
+      }
+    }
+    pass_pipeline_buf(&pipeline, buf, 0, 0);
+    // Progress bar
+    show_progress_bar(file_local_sz, write_bytes_total, &percent_last, lexeme);
+    // CAUTION: the remote file is not flushed by rounds: the server writes it by large blocks, errors of deferred
+    // writes are reported by checkpoints and by 'rxs_fclose()'
+    if ((write_bytes_total - checkpoint_bytes) >= PUT_CHECKPOINT_SZ) {
+      if (rxs_fflush(stream) != 0) {
+        log_msg(ERRN, 48, file_remote);
+        *err_no = rxs_errno();
+        result = -1;
+        break;
+      }
+      checkpoint_bytes = write_bytes_total;
+    }
+    if (len < PIPELINE_BUF_SZ) break;
+  }
+  dinit_pipeline_t(&pipeline);
+  return result;
+}
+// Print result of the mirror
+int show_mirror(const rxs_mirror_stat_t* stat) {
+  double mbps = (stat->sec > 0) ? ((double)stat->bytes_moved / (1024.0 * 1024.0) / stat->sec) : (0);
+  fprintf(stdout,
+          "files %" PRIu64 ": moved %" PRIu64 " (%" PRIu64 " B), failed %" PRIu64 ", deleted %" PRIu64
+          ", %.2f s, %.1f MB/s\n",
+          stat->files_total, stat->files_moved, stat->bytes_moved, stat->files_failed, stat->files_deleted, stat->sec,
+          mbps);
+  fflush(stdout);
+  return 0;
+}
+// Print results of the batch: one tab-separated line per operation in order of the manifest
+// 'line op ok|fail errno bytes msec arg1 arg2', the summary line is started by '#'
+int show_batch(const rxs_batch_result_t* results, size_t cnt, double sec) {
+  size_t failed = 0;
+  uint64_t bytes = 0;
+  for (size_t i = 0; i < cnt; i++) {
+    const rxs_batch_result_t* item = &results[i];
+    fprintf(stdout, "%" PRIu32 "\t%s\t%s\t%d\t%" PRIu64 "\t%.0f\t%s\t%s\n", item->line, rxs_batch_op_name(item->op),
+            (item->err_no) ? ("fail") : ("ok"), item->err_no, item->bytes, item->sec * 1000.0, item->arg1, item->arg2);
+    if (item->err_no) failed++;
+    bytes += item->bytes;
+  }
+  fprintf(stdout, "# operations %zu: done %zu, failed %zu, %" PRIu64 " B, %.2f s\n", cnt, cnt - failed, failed, bytes,
+          sec);
+  fflush(stdout);
   return 0;
 }
 // Main
@@ -99,6 +404,76 @@ int main(int argc, char* argv[]) {
   char operation_put_e[] = "put_e";
   char operation_get_e[] = "get_e";
   char operation_cli_e[] = "cli_e";
+  char operation_mirror[] = "mirror";
+  char operation_mirror_e[] = "mirror_e";
+  char operation_batch[] = "batch";
+  char operation_batch_e[] = "batch_e";
+  char direction_pull[] = "pull";
+  char direction_push[] = "push";
+
+  //////////////////////////////////////////////////////////////////////////////////////////////////
+  // Options are removed from the arguments before the positional parsing
+  //////////////////////////////////////////////////////////////////////////////////////////////////
+  const char option_stripes[] = "--stripes=";
+  const char option_workers[] = "--workers=";
+  const char option_delete[] = "--delete";
+  const char option_streams[] = "--streams=";
+  const char option_rate_limit[] = "--rate_limit=";
+  uint32_t stripes = 1;
+  uint32_t workers = 4;
+  uint32_t streams = 4;
+  uint32_t mirror_flags = 0;
+  int argc_positional = 1;
+  for (int i = 1; i < argc; i++) {
+    if (!strncmp(argv[i], option_workers, strlen(option_workers))) {
+      char* end = NULL;
+      unsigned long val = strtoul(argv[i] + strlen(option_workers), &end, 10);
+      if (!end || *end || (val < 1) || (val > RXS_MIRROR_WORKERS_MAX)) {
+        show_help();
+        exit(RXS_CLI_EINVAL);
+      }
+      workers = (uint32_t)val;
+      continue;
+    }
+    if (!strncmp(argv[i], option_streams, strlen(option_streams))) {
+      char* end = NULL;
+      unsigned long val = strtoul(argv[i] + strlen(option_streams), &end, 10);
+      if (!end || *end || (val < 1) || (val > RXS_BATCH_STREAMS_MAX)) {
+        show_help();
+        exit(RXS_CLI_EINVAL);
+      }
+      streams = (uint32_t)val;
+      continue;
+    }
+    if (!strncmp(argv[i], option_rate_limit, strlen(option_rate_limit))) {
+      uint64_t rate = 0;
+      uint64_t burst = 0;
+      if (parse_rate_limit(argv[i] + strlen(option_rate_limit), &rate, &burst) != 0) {
+        show_help();
+        exit(RXS_CLI_EINVAL);
+      }
+      // Connections of the pool share one bucket, the default connection is not taken by the pool
+      rxs_set_rate_limit(rate, burst);
+      rxs_pool_set_rate_limit(rate, burst);
+      continue;
+    }
+    if (!strcmp(argv[i], option_delete)) {
+      mirror_flags |= RXS_MIRROR_DELETE;
+      continue;
+    }
+    if (!strncmp(argv[i], option_stripes, strlen(option_stripes))) {
+      char* end = NULL;
+      unsigned long val = strtoul(argv[i] + strlen(option_stripes), &end, 10);
+      if (!end || *end || (val < 1) || (val > RXS_STRIPES_MAX)) {
+        show_help();
+        exit(RXS_CLI_EINVAL);
+      }
+      stripes = (uint32_t)val;
+      continue;
+    }
+    argv[argc_positional++] = argv[i];
+  }
+  argc = argc_positional;
 
   switch (argc) {
     case 3: {
@@ -113,7 +488,34 @@ int main(int argc, char* argv[]) {
       show_help();
       exit(RXS_CLI_EINVAL);
     }
+    case 4: {
+      // BATCH or BATCH_E username:password@ip:port manifest
+      if ((!strcasecmp(argv[1], operation_batch)) || (!strcasecmp(argv[1], operation_batch_e))) {
+        operation = argv[1];
+        parse_login(argv[2], login, sizeof(login), pass, sizeof(pass), other_side_addr_p, sizeof(other_side_addr_p),
+                    other_side_port_p, sizeof(other_side_port_p));
+        file_local = argv[3];
+        break;
+      }
+      show_help();
+      exit(RXS_CLI_EINVAL);
+    }
     case 6: {
+      // MIRROR or MIRROR_E push|pull username:password@ip:port local_dir remote_dir
+      if ((!strcasecmp(argv[1], operation_mirror)) || (!strcasecmp(argv[1], operation_mirror_e))) {
+        if (!strcasecmp(argv[2], direction_pull)) {
+          mirror_flags |= RXS_MIRROR_PULL;
+        } else if (strcasecmp(argv[2], direction_push)) {
+          show_help();
+          exit(RXS_CLI_EINVAL);
+        }
+        operation = argv[1];
+        parse_login(argv[3], login, sizeof(login), pass, sizeof(pass), other_side_addr_p, sizeof(other_side_addr_p),
+                    other_side_port_p, sizeof(other_side_port_p));
+        file_local = argv[4];
+        file_remote = argv[5];
+        break;
+      }
       // CLI or CLI_E: old format
       if ((!strncasecmp(argv[1], operation_cli, strlen(operation_cli))) ||
           (!strncasecmp(argv[1], operation_cli_e, strlen(operation_cli_e)))) {
@@ -211,6 +613,22 @@ int main(int argc, char* argv[]) {
     have_encoder = 1;
     operation_is_supported = 1;
   }
+  if (strcasecmp(operation_mirror, operation) == 0) {
+    have_encoder = 0;
+    operation_is_supported = 1;
+  }
+  if (strcasecmp(operation_mirror_e, operation) == 0) {
+    have_encoder = 1;
+    operation_is_supported = 1;
+  }
+  if (strcasecmp(operation_batch, operation) == 0) {
+    have_encoder = 0;
+    operation_is_supported = 1;
+  }
+  if (strcasecmp(operation_batch_e, operation) == 0) {
+    have_encoder = 1;
+    operation_is_supported = 1;
+  }
 
   //////////////////////////////////////////////////////////////////////////////////////////////////
   // Is supported operation?
@@ -232,6 +650,50 @@ int main(int argc, char* argv[]) {
   }
   int res = -1;
   //////////////////////////////////////////////////////////////////////////////////////////////////
+  // MIRROR directory trees: files are moved by the pool of connections
+  //////////////////////////////////////////////////////////////////////////////////////////////////
+  if ((strcasecmp(operation_mirror, operation) == 0) || (strcasecmp(operation_mirror_e, operation) == 0)) {
+    rxs_mirror_stat_t stat;
+    int errno_tmp = RXS_CLI_NONE;
+    if (rxs_mirror(other_side_addr_p, atoi(other_side_port_p), login, pass, have_encoder, file_local, file_remote,
+                   mirror_flags, workers, &stat) != 0) {
+      errno_tmp = errno;
+      log_msg(ERRN, (mirror_flags & RXS_MIRROR_PULL) ? (45) : (48), file_remote);
+    }
+    show_mirror(&stat);
+    rxs_pool_clear();
+    rxs_point_close();
+    // Close logger
+    closelog();
+    exit(errno_tmp);
+  }
+  //////////////////////////////////////////////////////////////////////////////////////////////////
+  // BATCH of operations: the connections are authorized once for all operations of the manifest
+  //////////////////////////////////////////////////////////////////////////////////////////////////
+  if ((strcasecmp(operation_batch, operation) == 0) || (strcasecmp(operation_batch_e, operation) == 0)) {
+    rxs_batch_result_t* results = NULL;
+    size_t cnt = 0;
+    struct timespec start;
+    struct timespec stop;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    int errno_tmp = RXS_CLI_NONE;
+    if (rxs_batch(other_side_addr_p, atoi(other_side_port_p), login, pass, have_encoder, file_local, streams,
+                  &results, &cnt) != 0) {
+      errno_tmp = errno;
+      if (!results) log_msg(ERRN, 43, file_local);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    if (results) {
+      show_batch(results, cnt, (double)(stop.tv_sec - start.tv_sec) + (double)(stop.tv_nsec - start.tv_nsec) / 1e9);
+      rxs_batch_free(results, cnt);
+    }
+    rxs_pool_clear();
+    rxs_point_close();
+    // Close logger
+    closelog();
+    exit(errno_tmp);
+  }
+  //////////////////////////////////////////////////////////////////////////////////////////////////
   // GET remote file to local side
   //////////////////////////////////////////////////////////////////////////////////////////////////
   if ((strncmp(operation_get, operation, strlen(operation)) == 0) ||
@@ -251,6 +713,29 @@ int main(int argc, char* argv[]) {
       closelog();
       exit(rxs_errno());
     }
+    //////////////////////////////////////////////////////////////////////////////////////////////////
+    // Striped download: ranges of the file are moved by own connections
+    //////////////////////////////////////////////////////////////////////////////////////////////////
+    if (stripes > 1) {
+      rxs_stripe_stat_t stat[RXS_STRIPES_MAX];
+      int stripes_used = rxs_get_striped(other_side_addr_p, atoi(other_side_port_p), login, pass, have_encoder,
+                                         file_local, file_remote, stripes, stat);
+      int errno_tmp = (stripes_used < 0) ? (errno) : (RXS_CLI_NONE);
+      if (stripes_used < 0) {
+        log_msg(ERRN, 45, file_remote);
+      } else {
+        show_stripes(stat, stripes_used);
+        // Commit the local file only (see durability policy)
+        int fd = open(file_local, O_WRONLY);
+        if ((fd < 0) || (durable_commit_fd(fd, get_durability_policy(NULL)) != 0)) errno_tmp = errno;
+        if ((fd >= 0) && close(fd)) errno_tmp = errno;
+      }
+      rxs_pool_clear();
+      rxs_point_close();
+      // Close logger
+      closelog();
+      exit(errno_tmp);
+    }
     long file_remote_size = rxs_filesize(file_remote);
     // Open the remote file
     RXS_HANDLE handle_file_remote = rxs_fopen(file_remote, "rb");
@@ -261,102 +746,37 @@ int main(int argc, char* argv[]) {
       closelog();
       exit(rxs_errno());
     }
-    // Truncate local file to zero length
-    {
-      FILE* handle_file_local = fopen(file_local, "wb");
-      if (!handle_file_local) {
-        int errno_tmp = errno;
-        rxs_point_close();
-        // Close logger
-        closelog();
-        exit(errno_tmp);
-      }
-      // Close local file
-      fclose(handle_file_local);
-    }
-    uint32_t buf_sz = 5 * 1024 * 1024;
-    char* buf_file_remote = (char*)calloc(buf_sz, sizeof(char));
-    if (!buf_file_remote) {
-      log_msg(ERRN, 44, buf_sz);
+    // Open local file, it is truncated to zero length
+    int fd_local = open(file_local, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (fd_local < 0) {
+      int errno_tmp = errno;
       rxs_point_close();
       // Close logger
       closelog();
-      exit(RXS_CLI_ENOMEM);
+      exit(errno_tmp);
     }
-    uint8_t percent_last = 0;
-    char lexeme[] = "Download...";
-    // Open local file
-    FILE* handle_file_local = fopen(file_local, "ab");
-    if (!handle_file_local) {
-      int errno_tmp = errno;
-      // Free memory
-      free(buf_file_remote);
-      buf_file_remote = NULL;
+#ifndef __QNXNTO__
+    // Extents of the whole file are reserved at once, the size grows by written data only
+    if ((file_remote_size > 0) && (fallocate(fd_local, FALLOC_FL_KEEP_SIZE, 0, file_remote_size) != 0)) {
+      // Not supported by the file system: blocks are allocated by writes
+    }
+#endif
+    int errno_tmp = RXS_CLI_NONE;
+    if (get_pipelined(handle_file_remote, fd_local, file_local, file_remote, file_remote_size, &errno_tmp) != 0) {
+      close(fd_local);
       rxs_point_close();
       // Close logger
       closelog();
       exit(errno_tmp);
     }
-    //////////////////////////////////////////////////////////////////////////////////////////////////
-    // Read remote file by portions
-    //////////////////////////////////////////////////////////////////////////////////////////////////
-    size_t read_bytes_total = 0;
-    while (1) {
-      memset(buf_file_remote, 0, buf_sz);
-      // Read the remote file
-      size_t read_bytes = rxs_fread(buf_file_remote, buf_sz, sizeof(char), handle_file_remote);
-      // printf("read_bytes_total=%d read_bytes=%d\n", read_bytes_total, read_bytes);
-      read_bytes_total += read_bytes;
-      // Progress bar
-      show_progress_bar(file_remote_size, read_bytes_total, &percent_last, lexeme);
-      if ((rxs_errno() != 0) && (rxs_errno() != RXS_EOF)) {
-        log_msg(ERRN, 45, file_remote);
-        // Close local file
-        fclose(handle_file_local);
-        // Free memory
-        free(buf_file_remote);
-        buf_file_remote = NULL;
-        rxs_point_close();
-        // Close logger
-        closelog();
-        exit(rxs_errno());
-      }
-      // Write to local file
-      size_t write_bytes = fwrite(buf_file_remote, sizeof(buf_file_remote[0]), read_bytes, handle_file_local);
-      if (write_bytes != read_bytes) {
-        int errno_tmp = errno;
-        log_msg(ERRN, 46, file_local);
-        // Close local file
-        fclose(handle_file_local);
-        // Free memory
-        free(buf_file_remote);
-        buf_file_remote = NULL;
-        rxs_point_close();
-        // Close logger
-        closelog();
-        exit(errno_tmp);
-      }
-      // Flush local file
-      fflush(handle_file_local);
-
-      if (rxs_errno() == RXS_EOF) break;
-    }
     // Clear output console
     clear_console();
-    // Close local file
-    // Note that fclose() flushes only the user-space buffers provided by the C library.
-    // To ensure that the data is physically stored on disk the kernel buffers must be flushed too, for example, with
-    // sync(2) or fsync(2).
-    int errno_tmp = RXS_CLI_NONE;
-    if (fclose(handle_file_local)) errno_tmp = errno;
-    // Sync local buffers
-    sync();
+    // Commit the local file only (see durability policy)
+    if (durable_commit_fd(fd_local, get_durability_policy(NULL)) != 0) errno_tmp = errno;
+    if (close(fd_local)) errno_tmp = errno;
     // Close remote file
     res = rxs_fclose(handle_file_remote);
     if (res != 0) log_msg(ERRN, 47, res, rxs_errno());
-    // Free memory
-    free(buf_file_remote);
-    buf_file_remote = NULL;
     // Close RXS point
     rxs_point_close();
     // Close logger
@@ -383,134 +803,58 @@ int main(int argc, char* argv[]) {
       closelog();
       exit(errno);
     }
-    uint32_t buf_sz = 5 * 1024 * 1024;
-    char* buf_file_local = (char*)calloc(buf_sz, sizeof(char));
-    if (!buf_file_local) {
-      log_msg(ERRN, 44, buf_sz);
+    //////////////////////////////////////////////////////////////////////////////////////////////////
+    // Striped upload: ranges of the file are moved by own connections
+    //////////////////////////////////////////////////////////////////////////////////////////////////
+    if (stripes > 1) {
+      rxs_stripe_stat_t stat[RXS_STRIPES_MAX];
+      int stripes_used = rxs_put_striped(other_side_addr_p, atoi(other_side_port_p), login, pass, have_encoder,
+                                         file_local, file_remote, stripes, stat);
+      int errno_tmp = (stripes_used < 0) ? (errno) : (RXS_CLI_NONE);
+      if (stripes_used < 0) {
+        log_msg(ERRN, 48, file_remote);
+      } else {
+        show_stripes(stat, stripes_used);
+      }
+      rxs_pool_clear();
       rxs_point_close();
       // Close logger
       closelog();
-      exit(RXS_CLI_ENOMEM);
+      exit(errno_tmp);
     }
     // Open the local file
-    FILE* handle_file_local = fopen(file_local, "rb");
-    if (!handle_file_local) {
-      // Free memory
-      free(buf_file_local);
-      buf_file_local = NULL;
+    int fd_local = open(file_local, O_RDONLY);
+    if (fd_local < 0) {
+      int errno_tmp = errno;
       rxs_point_close();
       // Close logger
       closelog();
-      exit(errno);
-    }
-    // Truncate remote file to zero length
-    {
-      RXS_HANDLE handle_file_remote = rxs_fopen(file_remote, "wb");
-      // Close remote file
-      res = rxs_fclose(handle_file_remote);
-      if (res != 0) {
-        log_msg(ERRN, 47, res, rxs_errno());
-        // Free memory
-        free(buf_file_local);
-        buf_file_local = NULL;
-        rxs_point_close();
-        // Close logger
-        closelog();
-        exit(errno);
-      }
+      exit(errno_tmp);
     }
-    // Open the remote file
-    RXS_HANDLE handle_file_remote = rxs_fopen(file_remote, "ab");
+    // Open the remote file, it is truncated to zero length
+    RXS_HANDLE handle_file_remote = rxs_fopen(file_remote, "wb");
     if (0 == handle_file_remote) {
       log_msg(ERRN, 43, file_remote);
       // Close local file
-      fclose(handle_file_local);
-      // Free memory
-      free(buf_file_local);
-      buf_file_local = NULL;
+      close(fd_local);
       rxs_point_close();
       // Close logger
       closelog();
       exit(rxs_errno());
     }
-    uint8_t percent_last = 0;
-    char lexeme[] = "Upload...";
-    //////////////////////////////////////////////////////////////////////////////////////////////////
-    // Write to remote file by portions
-    //////////////////////////////////////////////////////////////////////////////////////////////////
-    size_t read_bytes_total = 0;
-    size_t write_bytes_total = 0;
-    while (write_bytes_total < file_local_sz) {
-      memset(buf_file_local, 0, buf_sz);
-      // Shift file handler to new position
-      fseek(handle_file_local, read_bytes_total, SEEK_SET);
-      // Read local file
-      size_t read_bytes = fread(buf_file_local, sizeof(char), buf_sz, handle_file_local);
-      read_bytes_total += read_bytes;
-      // Progress bar
-      show_progress_bar(file_local_sz, write_bytes_total, &percent_last, lexeme);
-      // Examine local handle file on error
-      if (ferror(handle_file_local) != 0) {
-        // Close local file
-        fclose(handle_file_local);
-        // Close remote file
-        res = rxs_fclose(handle_file_remote);
-        if (res != 0) {
-          log_msg(ERRN, 47, res, rxs_errno());
-          // Free memory
-          free(buf_file_local);
-          buf_file_local = NULL;
-          rxs_point_close();
-          // Close logger
-          closelog();
-          exit(rxs_errno());
-        }
-        // Free memory
-        free(buf_file_local);
-        buf_file_local = NULL;
-        rxs_point_close();
-        // Close logger
-        closelog();
-        exit(rxs_errno());
-      }
-      // Write to the remote file
-      size_t write_bytes = rxs_fwrite(buf_file_local, read_bytes, sizeof(char), handle_file_remote);
-      write_bytes_total += write_bytes;
-      if (rxs_errno() != 0) {
-        log_msg(ERRN, 48, file_remote);
-        // Close local file
-        fclose(handle_file_local);
-        // Free memory
-        free(buf_file_local);
-        buf_file_local = NULL;
-        rxs_point_close();
-        // Close logger
-        closelog();
-        exit(rxs_errno());
-      }
-      // Flush remote file
-      res = rxs_fflush(handle_file_remote);
-      if (rxs_errno() != 0) {
-        log_msg(ERRN, 53);
-        // Close local file
-        fclose(handle_file_local);
-        // Free memory
-        free(buf_file_local);
-        buf_file_local = NULL;
-        rxs_point_close();
-        // Close logger
-        closelog();
-        exit(rxs_errno());
-      }
+    int errno_tmp = RXS_CLI_NONE;
+    if (put_pipelined(handle_file_remote, fd_local, file_local, file_remote, file_local_sz, &errno_tmp) != 0) {
+      // Close local file
+      close(fd_local);
+      rxs_point_close();
+      // Close logger
+      closelog();
+      exit(errno_tmp);
     }
     // Clear output console
     clear_console();
-
-    // Free memory
-    free(buf_file_local);
-    buf_file_local = NULL;
     // Close local file
-    fclose(handle_file_local);
+    close(fd_local);
     // Close remote file
     res = rxs_fclose(handle_file_remote);
     if (res != 0) {
@@ -535,6 +879,8 @@ int main(int argc, char* argv[]) {
     fprintf(stdout,
             "  Welcome to remote console (rxsc rev.%s)\n  Input command and press 'ENTER', for exit press 'Ctrl+C'\n",
             git_version);
+    // The prompt asks the current directory after every command
+    rxs_set_meta_cache(RXS_META_CACHE_TTL_MSEC);
     // Print CLI prefix
     compose_prefix_cli(other_side_addr_p, other_side_port_p, login);
 
@@ -34,10 +34,13 @@
 #include <sys/wait.h>
 
 #include "logger/logger.h"
+#include "protocol/durability.h"
+#include "protocol/rate_limit.h"
 #include "protocol/internal_types.h"
 #include "protocol/parser.h"
 #include "protocol/protocol_rxs.h"
 #include "protocol/protocol_rxs_server.h"
+#include "protocol/rxs_uring.h"
 #include "protocol/version.h"
 
 #if defined(__i386__)
@@ -98,6 +101,12 @@ int main(int argc, char* argv[]) {
   dlist_t* allowed_addr_t_lst = NULL;  // Allowed address
   char file_users[PATH_MAX] = {0};     // Path to file 'rxs_users'
   uint8_t encoder_mode = 0;            // Encoder mode (0 - plain mode; 1 - encoder mode)
+  uint8_t io_backend = 0;              // Storage backend (0 - posix; 1 - uring)
+  uint8_t read_mode = 0;               // Read-only streams (0 - stdio; 1 - mmap)
+  uint8_t durability = DURABILITY_CLOSE;           // Durability policy (see 'durability_t')
+  uint32_t durability_mb = DURABILITY_PERIODIC_MB;  // N MB of 'DURABILITY_PERIODIC'
+  uint64_t rate_limit = 0;                          // Server-wide rate limit of data channels (0 - no limit)
+  uint64_t rate_burst = 0;                          // Burst of the rate limit (0 - default)
   //////////////////////////////////////////////////////////////////////////////////
   // CAUTION: If pid is 0, sig shall be sent to all processes (excluding an unspecified set of system processes)
   // whose process group ID is equal to the process group ID of the sender, and for which the process has permission to
@@ -106,7 +115,8 @@ int main(int argc, char* argv[]) {
   pid_t pid_m = 0;
 
   if (parse_args(argc, argv, &this_side_addr_n, &this_side_port_h, &allowed_addr_t_lst, &daemon_mode, file_users,
-                 &pid_m, &encoder_mode) != 0) {
+                 &pid_m, &encoder_mode, &io_backend, &read_mode, &durability, &durability_mb, &rate_limit,
+                 &rate_burst) != 0) {
     // Free memory
     list_clear(&allowed_addr_t_lst, free_addr_t);
     log_msg(ERRN, 4);
@@ -123,6 +133,30 @@ int main(int argc, char* argv[]) {
   else
     log_msg(INFO, 54, "rxsd", "plain");
   //////////////////////////////////////////////////////////////////////////////////
+  // Storage backend
+  //////////////////////////////////////////////////////////////////////////////////
+  if (io_backend && !rxs_uring_available()) {
+    log_msg(WARN, 62, "io_uring is not supported", "posix");
+    io_backend = 0;
+  }
+  set_io_backend((io_backend) ? IO_BACKEND_URING : IO_BACKEND_POSIX);
+  log_msg(INFO, 61, "rxsd", (io_backend) ? "io_uring" : "posix");
+  set_read_mode((read_mode) ? READ_MODE_MMAP : READ_MODE_STDIO);
+  log_msg(INFO, 64, "rxsd", (read_mode) ? "mmap" : "stdio");
+  //////////////////////////////////////////////////////////////////////////////////
+  // Durability policy: sessions share group commit
+  //////////////////////////////////////////////////////////////////////////////////
+  const char* durability_name[] = {"none", "close", "periodic", "full"};
+  set_durability_policy((durability_t)durability, durability_mb);
+  if (init_group_commit() != 0) log_msg(ERRN, 6, "init_group_commit", strerror(errno));
+  log_msg(INFO, 65, "rxsd", durability_name[durability], durability_mb);
+  //////////////////////////////////////////////////////////////////////////////////
+  // Rate limits: sessions share the server-wide bucket and the buckets of users
+  //////////////////////////////////////////////////////////////////////////////////
+  if (init_rate_limit_shared(rate_limit, rate_burst) != 0) log_msg(ERRN, 6, "init_rate_limit_shared", strerror(errno));
+  if (rate_limit_active(get_rate_limit_server()))
+    log_msg(INFO, 66, "rxsd", get_rate_limit_server()->rate, get_rate_limit_server()->burst);
+  //////////////////////////////////////////////////////////////////////////////////
   // Daemon mode
   //////////////////////////////////////////////////////////////////////////////////
   if (daemon_mode) {
@@ -414,7 +448,7 @@ int main(int argc, char* argv[]) {
     }
   }
   // Close file handlers
-  clear_file_handlers_lst();
+  clear_file_handlers_tbl();
   // Clear user info list
   clear_user_info_lst();
   // Clear allow address list